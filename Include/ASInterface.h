@@ -141,6 +141,20 @@ struct ASInterface
 						const ASValue &arg6 = ASValue(), const ASValue &arg7 = ASValue(),
 						const ASValue &arg8 = ASValue(), const ASValue &arg9 = ASValue());
 
+	//---------------------------------------------------------------------
+	/// @brief				Queues call of Action Script function with up to ten arguments. Can be used from any thread.
+	/// @param functionName	Function name.
+	/// @param arg0-9		Optional function arguments.
+	/// @return				Future receiving result XML (see ASValue::FromXML()), or NULL if command queue is full.
+	///
+	/// Call is executed on the player owner thread, see IFlashDXPlayer::GetCommandProxy().
+	inline IFlashDXFuture* CallAsync(const std::wstring &functionName,
+						const ASValue &arg0 = ASValue(), const ASValue &arg1 = ASValue(),
+						const ASValue &arg2 = ASValue(), const ASValue &arg3 = ASValue(),
+						const ASValue &arg4 = ASValue(), const ASValue &arg5 = ASValue(),
+						const ASValue &arg6 = ASValue(), const ASValue &arg7 = ASValue(),
+						const ASValue &arg8 = ASValue(), const ASValue &arg9 = ASValue());
+
 	//---------------------------------------------------------------------
 	/// @brief				Registers a function as an Action Script callback.
 	/// @param functionName	Function name.
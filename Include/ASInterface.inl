@@ -669,6 +669,7 @@ struct ASInterface::_Data : IFlashDXEventHandler
 			virtual size_t ArgNum() = 0;
 			virtual void Call(const ASValue::Array &arguments, ASValue &returnValue) = 0;
 			virtual BaseCaller& Clone() = 0;
+			virtual size_t Size() = 0;
 		};
 
 		template<typename _F> struct Caller : BaseCaller
@@ -677,6 +678,7 @@ struct ASInterface::_Data : IFlashDXEventHandler
 			size_t ArgNum() { return CallHlp<_F>::argNum; }
 			void Call(const ASValue::Array &a, ASValue &r) { CallHlp<_F>::Call(r, fn, a); }
 			Caller& Clone() { return * new Caller(fn); }
+			size_t Size() { return sizeof(Caller); }
 		};
 		template<typename _R, typename _O> struct Caller<_R _O::*> : BaseCaller
 		{
@@ -684,6 +686,7 @@ struct ASInterface::_Data : IFlashDXEventHandler
 			size_t ArgNum() { return CallHlp<_M>::argNum; }
 			void Call(const ASValue::Array &a, ASValue &r) { CallHlp<_M>::Call(r, ob, mt, a); }
 			Caller& Clone() { return * new Caller(ob, mt); }
+			size_t Size() { return sizeof(Caller); }
 		};
 
 		BaseCaller &caller;
@@ -741,6 +744,40 @@ struct ASInterface::_Data : IFlashDXEventHandler
 	{
 		player.RemoveEventHandler(this);
 	}
+	static inline size_t GetCallbacksSize(const Callbacks &callbacks)
+	{
+		size_t size = 0;
+		for (Callbacks::const_iterator it = callbacks.begin(); it != callbacks.end(); ++it)
+		{
+			size += IFlashDXPlayer::SMemoryUsage::GetTreeNodeSize<Callbacks::value_type>() + it->first.capacity() * sizeof(wchar_t);
+			if (&it->second.caller) size += it->second.caller.Size();
+		}
+		return size;
+	}
+	unsigned int GetMemoryUsage() const
+	{
+		size_t size = sizeof(*this) + GetCallbacksSize(callbacks) + GetCallbacksSize(fsCallbacks);
+		if (&fsDefCallback.caller) size += fsDefCallback.caller.Size();
+		return (unsigned int)size;
+	}
+	static inline std::wstring MakeRequest(const std::wstring &functionName, const ASValue &arg0, const ASValue &arg1, const ASValue &arg2, const ASValue &arg3, const ASValue &arg4, const ASValue &arg5, const ASValue &arg6, const ASValue &arg7, const ASValue &arg8, const ASValue &arg9)
+	{
+		struct _Args { static void ToXML(std::wstring &arguments, const ASValue &arg0 = ASValue(), const ASValue &arg1 = ASValue(), const ASValue &arg2 = ASValue(), const ASValue &arg3 = ASValue(), const ASValue &arg4 = ASValue(), const ASValue &arg5 = ASValue(), const ASValue &arg6 = ASValue(), const ASValue &arg7 = ASValue(), const ASValue &arg8 = ASValue(), const ASValue &arg9 = ASValue())
+		{
+			if (arg0.IsEmpty()) return;
+
+			arguments += arg0.ToXML();
+
+			ToXML(arguments, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
+		}};
+
+		std::wstring arguments(L"<arguments>");
+		_Args::ToXML(arguments, arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
+		if (arguments.length() > 11) arguments += std::wstring(L"</arguments>");
+		else arguments = L"";
+
+		return L"<invoke name='" + functionName + L"' returntype='xml'>" + arguments + L"</invoke>";
+	}
 	HRESULT FlashCall(const wchar_t* request)
 	{
 		struct _Args { static void split(const std::wstring &xml, std::vector<std::wstring> &args)
@@ -838,21 +875,7 @@ inline ASInterface::~ASInterface()
 
 inline ASValue ASInterface::Call(const std::wstring &functionName, const ASValue &arg0, const ASValue &arg1, const ASValue &arg2, const ASValue &arg3, const ASValue &arg4, const ASValue &arg5, const ASValue &arg6, const ASValue &arg7, const ASValue &arg8, const ASValue &arg9)
 {
-	struct _Args { static void ToXML(std::wstring &arguments, const ASValue &arg0 = ASValue(), const ASValue &arg1 = ASValue(), const ASValue &arg2 = ASValue(), const ASValue &arg3 = ASValue(), const ASValue &arg4 = ASValue(), const ASValue &arg5 = ASValue(), const ASValue &arg6 = ASValue(), const ASValue &arg7 = ASValue(), const ASValue &arg8 = ASValue(), const ASValue &arg9 = ASValue())
-	{
-		if (arg0.IsEmpty()) return;
-
-		arguments += arg0.ToXML();
-
-		ToXML(arguments, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
-	}};
-
-	std::wstring arguments(L"<arguments>");
-	_Args::ToXML(arguments, arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
-	if (arguments.length() > 11) arguments += std::wstring(L"</arguments>");
-	else arguments = L"";
-
-	std::wstring request = L"<invoke name='" + functionName + L"' returntype='xml'>" + arguments + L"</invoke>";
+	std::wstring request = _Data::MakeRequest(functionName, arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
 	const wchar_t* result = m_data.player.CallFunction(request.c_str());
 
 	if (result == NULL) return ASValue();
@@ -862,6 +885,12 @@ inline ASValue ASInterface::Call(const std::wstring &functionName, const ASValue
 	return value;
 }
 
+inline IFlashDXFuture* ASInterface::CallAsync(const std::wstring &functionName, const ASValue &arg0, const ASValue &arg1, const ASValue &arg2, const ASValue &arg3, const ASValue &arg4, const ASValue &arg5, const ASValue &arg6, const ASValue &arg7, const ASValue &arg8, const ASValue &arg9)
+{
+	std::wstring request = _Data::MakeRequest(functionName, arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
+	return m_data.player.GetCommandProxy()->CallFunction(request.c_str());
+}
+
 template<typename _Function>
 inline void ASInterface::AddCallback(const std::wstring &functionName, _Function function)
 {
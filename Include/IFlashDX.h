@@ -48,8 +48,140 @@ struct IFlashDX
 	//---------------------------------------------------------------------
 	/// @brief				Destroys player by it's pointer.
 	/// @param pPlayer		Player to destroy.
+	///
+	/// Frames of the player still queued for PopRenderedFrame() are dropped. A frame already popped must be
+	/// released first, its image does not outlive the player.
 	virtual void DestroyPlayer(IFlashDXPlayer* pPlayer) = 0;
 
+	//---------------------------------------------------------------------
+	/// @brief				Sets size of the player pool and pre-creates pooled players.
+	/// @param numPlayers	Maximum number of idle players kept in the pool. Zero destroys pooled players.
+	/// @param width		Width of rendering surface of pre-created players.
+	/// @param height		Height of rendering surface of pre-created players.
+	///
+	/// Creating player is expensive (COM instantiation and activation of Flash control), so it is
+	/// better done at startup. While pool has free room DestroyPlayer() returns players to the pool.
+	virtual void SetPlayerPoolSize(unsigned int numPlayers, unsigned int width, unsigned int height) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Takes player from the pool, or creates new one if the pool is empty.
+	/// @param width		Width of rendering surface of the player.
+	/// @param height		Height of rendering surface of the player.
+	/// @return				Player interface.
+	virtual struct IFlashDXPlayer* AcquirePlayer(unsigned int width, unsigned int height) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Resets player and returns it to the pool, or destroys it if the pool is full.
+	/// @param pPlayer		Player to release.
+	virtual void ReleasePlayer(IFlashDXPlayer* pPlayer) = 0;
+
+	//---------------------------------------------------------------------
+	/// Player pool statistics.
+	struct SPlayerPoolStats
+	{
+		unsigned int	m_poolSize;			///< maximum number of idle players
+		unsigned int	m_numFree;			///< idle players in the pool
+		unsigned int	m_numCreated;		///< players created for the pool or on pool misses
+		unsigned int	m_numHits;			///< AcquirePlayer() calls served from the pool
+		unsigned int	m_numMisses;		///< AcquirePlayer() calls that had to create player
+		unsigned int	m_numReleased;		///< players returned to the pool
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns player pool statistics.
+	/// @param stats		Returned statistics.
+	virtual void GetPlayerPoolStats(SPlayerPoolStats& stats) = 0;
+
+	//---------------------------------------------------------------------
+	/// Update description of single player. See CollectUpdates().
+	struct SPlayerUpdate
+	{
+		struct IFlashDXPlayer*	m_player;
+		RECT					m_unitedDirtyRect;
+		const RECT*				m_dirtyRects;		///< points into array shared by all updates
+		unsigned int			m_numDirtyRects;
+		HDC						m_dc;				///< target DC, set by the caller before DrawAll()
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Checks all live players and collects the ones that want to update target surface.
+	/// @param updates		Pointer that will receive address of the updates array.
+	/// @return				Number of players to update.
+	///
+	/// Does the same as IFlashDXPlayer::IsNeedUpdate() for every player created with CreatePlayer() or
+	/// AcquirePlayer(). Returned array is ordered the way DrawAll() renders it and is valid until the next call.
+	virtual unsigned int CollectUpdates(SPlayerUpdate** updates) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Draws frames of all players collected by the last CollectUpdates() call.
+	///
+	/// Players with NULL m_dc are skipped and stay dirty.
+	virtual void DrawAll() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Sets time DrawAll() may spend per call.
+	/// @param budget		Time in milliseconds, zero for no limit.
+	///
+	/// Critical players are always drawn. Non-critical players which don't fit are left dirty for the next
+	/// DrawAll(), the ones postponed most often go first then. See IFlashDXPlayer::SetCritical().
+	virtual void SetFrameBudget(float budget) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Sets number of worker threads that own and render players.
+	/// @param numThreads	Number of worker threads. Zero keeps players on the calling thread.
+	/// @return				Success flag. Fails if any player (pooled ones included) is still owned by a worker.
+	///
+	/// Players created after this call are distributed across workers, each worker has its own COM apartment
+	/// and message loop. Such players are not returned by CollectUpdates(), use RenderAsync() and
+	/// PopRenderedFrame() instead. Other methods of worker owned players (and event handlers) must be called on
+	/// the owner worker, use InvokeOnPlayerThread() for that.
+	virtual bool SetNumRenderThreads(unsigned int numThreads) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns number of worker threads.
+	/// @return				Number of worker threads.
+	virtual unsigned int GetNumRenderThreads() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Calls function on the thread that owns the player and waits for it to complete.
+	/// @param pPlayer		Player.
+	/// @param func			Function to call.
+	/// @param context		User data passed to the function.
+	virtual void InvokeOnPlayerThread(IFlashDXPlayer* pPlayer, void (*func)(IFlashDXPlayer* pPlayer, void* context), void* context) = 0;
+
+	//---------------------------------------------------------------------
+	/// Frame rendered by worker thread. See RenderAsync().
+	struct SRenderedFrame
+	{
+		struct IFlashDXPlayer*	m_player;
+		const void*				m_bits;				///< top-down 32 bit BGRA image of the whole player
+		unsigned int			m_pitch;			///< bytes per row
+		unsigned int			m_width;
+		unsigned int			m_height;
+		RECT					m_unitedDirtyRect;	///< part of the image updated since the previous frame
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Asks all worker threads to render their dirty players.
+	///
+	/// Returns immediately. Workers render concurrently, finished frames are handed back through PopRenderedFrame().
+	virtual void RenderAsync() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Takes next finished frame.
+	/// @param frame		Returned frame.
+	/// @return				False if no frame is ready.
+	///
+	/// Frame image stays valid until ReleaseRenderedFrame(). The player is not rendered again until then.
+	/// Release the frame before destroying its player, the image is owned by the player and freed with it.
+	/// Should be called from one thread only, the one that calls CreatePlayer() and DestroyPlayer().
+	virtual bool PopRenderedFrame(SRenderedFrame& frame) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns frame image to the worker.
+	/// @param frame		Frame returned by PopRenderedFrame().
+	virtual void ReleaseRenderedFrame(const SRenderedFrame& frame) = 0;
+
 	//---------------------------------------------------------------------
 	/// Movie properties description.
 	struct SMovieProperties
@@ -74,6 +206,125 @@ struct IFlashDX
 	/// @param props		Returned properties in case of success.
 	/// @return				Success flag.
 	virtual bool GetMovieProperties(const void* movieData, const unsigned int movieDataSize, SMovieProperties& props) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Configures cache of decompressed movies.
+	/// @param memoryLimit	Maximum size of decompressed movie data kept in memory, in bytes. Zero disables the cache.
+	/// @param diskCachePath Directory to keep decompressed movies on disk. Can be NULL.
+	///
+	/// Compressed (CWS) movies loaded with IFlashDXPlayer::LoadMovie() are inflated once and then looked up by
+	/// content hash. Cached movies are passed to Flash from memory with Base set to the movie file directory,
+	/// so relative URLs used inside of such movie are still resolved against the movie location.
+	virtual void SetMovieCache(unsigned int memoryLimit, const wchar_t* diskCachePath = NULL) = 0;
+
+	//---------------------------------------------------------------------
+	/// Movie cache statistics.
+	struct SMovieCacheStats
+	{
+		unsigned int	m_memoryHits;		///< movies found in memory
+		unsigned int	m_diskHits;			///< movies found on disk
+		unsigned int	m_misses;			///< movies that had to be inflated
+		unsigned int	m_numEntries;		///< movies kept in memory
+		unsigned int	m_memoryUsage;		///< bytes of decompressed data kept in memory
+		unsigned int	m_memoryLimit;		///< current memory limit
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns movie cache statistics.
+	/// @param stats		Returned statistics.
+	///
+	/// Hit rate is (m_memoryHits + m_diskHits) / (m_memoryHits + m_diskHits + m_misses).
+	virtual void GetMovieCacheStats(SMovieCacheStats& stats) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Sets memory limit for idle scratch buffers shared by all players.
+	/// @param memoryLimit	Size of idle buffers kept for reuse, in bytes. Zero frees buffers right after each draw.
+	///
+	/// FULL_ALPHA players borrow two buffers of their size for the duration of DrawFrame().
+	virtual void SetRenderBufferPoolLimit(unsigned int memoryLimit) = 0;
+
+	//---------------------------------------------------------------------
+	/// Render buffer pool statistics.
+	struct SRenderBufferPoolStats
+	{
+		unsigned int	m_numBuffers;		///< buffers allocated, borrowed ones included
+		unsigned int	m_numFree;			///< idle buffers
+		unsigned int	m_memoryUsage;		///< bytes taken by all buffers
+		unsigned int	m_freeMemory;		///< bytes taken by idle buffers
+		unsigned int	m_peakMemoryUsage;	///< maximum of m_memoryUsage
+		unsigned int	m_memoryLimit;		///< current limit for idle buffers
+		unsigned int	m_numHits;			///< requests served by idle buffers
+		unsigned int	m_numMisses;		///< requests that had to allocate
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns render buffer pool statistics.
+	/// @param stats		Returned statistics.
+	virtual void GetRenderBufferPoolStats(SRenderBufferPoolStats& stats) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Starts recording trace of player activity. Previously recorded events are discarded.
+	///
+	/// Movie loading, DrawFrame(), CallFunction(), FlashCall/FSCommand dispatch and input delivery are recorded
+	/// as spans of every player on every thread. Timestamps are QueryPerformanceCounter based.
+	virtual void StartTrace() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Stops recording trace and writes it to file.
+	/// @param path			Output file in Chrome trace event JSON format, viewable in chrome://tracing or Perfetto.
+	/// @return				Success flag.
+	virtual bool StopTrace(const wchar_t* path) = 0;
+
+	//---------------------------------------------------------------------
+	/// Memory held by Flash-to-DirectX in the process, in bytes.
+	struct SMemoryUsage
+	{
+		unsigned int	m_numPlayers;		///< live, pooled and remote players
+		unsigned int	m_players;			///< sum of IFlashDXPlayer::SMemoryUsage::m_total of these players
+		unsigned int	m_renderBuffers;	///< render buffer pool, borrowed buffers included
+		unsigned int	m_movieCache;		///< decompressed movies kept in memory
+		unsigned int	m_total;			///< sum of the above
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns memory held by all players and memory shared by them.
+	/// @param usage		Returned memory usage.
+	///
+	/// Players owned by worker threads are queried on their workers, see InvokeOnPlayerThread().
+	virtual void GetMemoryUsage(SMemoryUsage& usage) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Walks movie tags and predicts rendering cost of the movie.
+	/// @param movie		Path to movie file.
+	/// @param cost			Returned cost estimation in case of success.
+	/// @return				Success flag.
+	virtual bool AnalyzeMovie(const wchar_t* movie, struct SMovieCost& cost) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Walks movie tags and predicts rendering cost of the movie.
+	/// @param movieData	Pointer on movie data.
+	/// @param movieDataSize Movie data size.
+	/// @param cost			Returned cost estimation in case of success.
+	/// @return				Success flag.
+	virtual bool AnalyzeMovie(const void* movieData, const unsigned int movieDataSize, struct SMovieCost& cost) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Creates player running in a separate host process.
+	/// @param width		Width of rendering surface of the player.
+	/// @param height		Height of rendering surface of the player.
+	/// @param hostCommandLine Command line starting the host, see Samples/FlashDXHost. Channel name is appended to it.
+	/// @return				Player interface, NULL if the host failed to start.
+	///
+	/// Calls are forwarded to the host, dirty parts of its frames come back through shared memory. Crash of
+	/// Flash takes down the host only, and the host renders on its own thread, which can be pinned to other cores.
+	/// Remote players are not returned by CollectUpdates() and not pooled, destroy them with DestroyPlayer().
+	virtual struct IFlashDXPlayer* CreateRemotePlayer(unsigned int width, unsigned int height, const wchar_t* hostCommandLine) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Runs player for CreateRemotePlayer() of the client process until the client quits or exits.
+	/// @param channelName	Channel name, the last command line argument of the host.
+	/// @return				False if the channel couldn't be opened or the player couldn't be created.
+	virtual bool RunRemoteHost(const wchar_t* channelName) = 0;
 };
 
 
@@ -159,6 +410,29 @@ struct IFlashDXPlayer
 	/// @return				Success flag. False means movie was not found.
 	virtual bool LoadMovie(const wchar_t* movie) = 0;
 
+	//---------------------------------------------------------------------
+	/// @brief				Loads and starts playing the movie from memory.
+	/// @param movieData	Pointer on movie data.
+	/// @param movieDataSize Movie data size.
+	/// @return				Success flag.
+	virtual bool LoadMovie(const void* movieData, const unsigned int movieDataSize) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Starts loading the movie in background and returns immediately.
+	/// @param movie		Movie to play. You can use absolute or relative to GetCurrentDirectory() path.
+	/// @return				Success flag. False means movie was not found.
+	///
+	/// Movie file is read and decompressed on a background thread and then passed to Flash from memory with
+	/// Base set to the movie file directory, so relative URLs still work. Previous movie keeps playing until the data is
+	/// ready, after that the player doesn't request updates until the new movie is ready, so the last frame
+	/// stays on the target surface. Progress is reported through IFlashDXEventHandler.
+	virtual bool LoadMovieAsync(const wchar_t* movie) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Checks if movie requested by LoadMovieAsync() is still loading.
+	/// @return				Loading flag.
+	virtual bool IsMovieLoading() const = 0;
+
 	//---------------------------------------------------------------------
 	/// @brief				Returns current background color.
 	/// @return				Background color.
@@ -295,6 +569,97 @@ struct IFlashDXPlayer
 	/// @param newHeight	New height for the player.
 	virtual void ResizePlayer(unsigned int newWidth, unsigned int newHeight) = 0;
 
+	//---------------------------------------------------------------------
+	/// @brief				Sets resolution the player renders at, relative to its size.
+	/// @param scale		Scale factor, e.g. 0.5 renders a quarter of pixels. 1 renders at full size.
+	///
+	/// Player size and mouse coordinates stay in logical pixels. Dirty rectangles and DrawFrame() work with
+	/// the scaled surface, see GetSurfaceWidth() and GetSurfaceHeight(). The surface is meant to be stretched
+	/// to the player size when composed, e.g. by texture filtering.
+	virtual void SetResolutionScale(float scale) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns resolution scale factor.
+	/// @return				Scale factor.
+	virtual float GetResolutionScale() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns width of the rendered surface.
+	/// @return				Width in pixels.
+	virtual unsigned int GetSurfaceWidth() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns height of the rendered surface.
+	/// @return				Height in pixels.
+	virtual unsigned int GetSurfaceHeight() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Restricts rendering to the part of the player visible on screen.
+	/// @param rect			Visible rectangle in player coordinates, NULL if the whole player is visible.
+	///
+	/// Only the visible part is reported dirty and drawn. Changes outside of it are kept and reported
+	/// when the area becomes visible again.
+	virtual void SetVisibleRect(const RECT* rect) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Puts the player to sleep while it is hidden.
+	///
+	/// Playback is paused, render buffers are released and invalidations are ignored. The movie stays loaded.
+	virtual void Suspend() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Wakes up suspended player. Playback is restored and the whole player is redrawn.
+	virtual void Resume() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Checks if the player is suspended.
+	/// @return				True if the player is suspended.
+	virtual bool IsSuspended() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Suspends the player automatically when it is hidden by SetVisibleRect() for some time.
+	/// @param delay		Time in milliseconds the player has to stay hidden, INFINITE disables automatic suspending.
+	///
+	/// Players suspended this way are resumed as soon as SetVisibleRect() makes them visible again.
+	virtual void SetAutoSuspend(unsigned int delay) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Enables cache of rendered frames for movies switching between static screens.
+	/// @param memoryLimit	Size of compressed frames kept, in bytes. Zero disables the cache.
+	///
+	/// When movie state changes, the last frame of the previous state is stored under its key, if that state
+	/// lasted long enough to be a static screen. When a cached state is entered again and the change repaints
+	/// the whole visible part, the frame is copied from the cache instead of being drawn by Flash. Animations
+	/// running on the restored screen are drawn as usual afterwards. See SetFrameCacheKey().
+	///
+	/// Frames are taken from a surface-sized buffer of the player, never read back from the target. Players
+	/// drawn with DrawFrame() allocate it while the cache is enabled and copy dirty parts to the target.
+	virtual void SetFrameCache(unsigned int memoryLimit) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Sets key of the current movie state for the frame cache.
+	/// @param key			State key, empty string if the state shouldn't be cached.
+	///						NULL to use current frame and label of the main timeline (default).
+	///
+	/// The key has to identify complete look of the movie, states with equal keys are assumed identical.
+	virtual void SetFrameCacheKey(const wchar_t* key) = 0;
+
+	//---------------------------------------------------------------------
+	/// Frame cache statistics.
+	struct SFrameCacheStats
+	{
+		unsigned int	m_numHits;			///< states restored from the cache
+		unsigned int	m_numMisses;		///< states drawn by Flash
+		unsigned int	m_numFrames;		///< frames in the cache
+		unsigned int	m_memoryUsage;		///< bytes of compressed frames
+		unsigned int	m_memoryLimit;		///< current memory limit
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns frame cache statistics.
+	/// @param stats		Returned statistics.
+	virtual void GetFrameCacheStats(SFrameCacheStats& stats) = 0;
+
 	//---------------------------------------------------------------------
 	/// @brief				Checks if player wants update target surface.
 	/// @param unionDirtyRect Pointer on pointer that will receive pointer on united dirty rect. Can be NULL.
@@ -310,6 +675,125 @@ struct IFlashDXPlayer
 	/// To use this method for updating DirectX texture use IDirect3DSurface9::GetDC() method.
 	virtual void DrawFrame(HDC dc) = 0;
 
+	//---------------------------------------------------------------------
+	/// @brief				Returns event that is signalled when the player becomes dirty.
+	/// @return				Auto-reset event owned by the player.
+	///
+	/// Lets hosts sleep until the movie changes instead of polling IsNeedUpdate(). Flash advances its movie
+	/// on window messages of the owner thread, so keep dispatching them while waiting (MsgWaitForMultipleObjects()).
+	virtual HANDLE GetDirtyEvent() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Sets function called when the player becomes dirty.
+	/// @param callback		Function to call, or NULL. It is called on the thread that owns the player.
+	/// @param context		User data passed to the function.
+	virtual void SetDirtyCallback(void (*callback)(IFlashDXPlayer* pPlayer, void* context), void* context) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Limits how often IsNeedUpdate() reports the player dirty.
+	/// @param maxRate		Maximum number of updates per second, zero for no limit.
+	/// @param useMovieFrameRate Also don't update more often than frame rate of the loaded movie.
+	///
+	/// Pacing is disabled by default. Dirty player that waits for its turn stays dirty, use GetTimeToNextUpdate()
+	/// to find out when to check it again.
+	virtual void SetFramePacing(float maxRate, bool useMovieFrameRate) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns time left until the next update.
+	/// @return				Milliseconds until IsNeedUpdate() reports the player dirty, INFINITE if it is not dirty.
+	virtual unsigned int GetTimeToNextUpdate() = 0;
+
+	//---------------------------------------------------------------------
+	/// Frame pacing statistics. Lateness is the delay between the moment update was allowed and DrawFrame().
+	struct SPacingStats
+	{
+		float			m_updateInterval;	///< current minimal interval between updates, in milliseconds
+		unsigned int	m_numUpdates;		///< frames drawn
+		unsigned int	m_numPacedUpdates;	///< frames that had to wait for their turn
+		float			m_meanInterval;		///< mean interval between paced updates, in milliseconds
+		float			m_meanLateness;		///< in milliseconds
+		float			m_maxLateness;		///< in milliseconds
+		float			m_jitter;			///< standard deviation of lateness, in milliseconds
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns frame pacing statistics.
+	/// @param stats		Returned statistics.
+	virtual void GetPacingStats(SPacingStats& stats) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Resets frame pacing statistics.
+	virtual void ResetPacingStats() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Enables quality control driven by measured DrawFrame() time.
+	/// @param drawBudget	Time in milliseconds DrawFrame() of this player should fit in. Zero disables the control.
+	/// @param minQuality	Lowest quality the player may be switched to.
+	/// @param maxQuality	Highest quality the player may be switched to.
+	///
+	/// Quality is lowered one step when smoothed draw time stays over the budget, and raised back only after
+	/// a longer period well under the budget. Automatic Flash modes (QUALITY_AUTOLOW, QUALITY_AUTOHIGH) are not used.
+	virtual void SetAdaptiveQuality(float drawBudget, EQuality minQuality = QUALITY_LOW, EQuality maxQuality = QUALITY_HIGH) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns smoothed DrawFrame() time.
+	/// @return				Time in milliseconds.
+	virtual float GetAverageDrawTime() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Marks the player as critical or not. Players are critical by default.
+	/// @param critical		Critical flag.
+	///
+	/// Updates of non-critical players can be postponed by IFlashDX::DrawAll() to stay within the frame budget.
+	virtual void SetCritical(bool critical) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Checks if the player is critical.
+	/// @return				Critical flag.
+	virtual bool IsCritical() const = 0;
+
+	//---------------------------------------------------------------------
+	/// Stages of DrawFrame() measured by draw timing instrumentation.
+	enum EDrawStage
+	{
+		DRAW_STAGE_CLIP_REGION = 0,	// building clip region from dirty rects
+		DRAW_STAGE_BACKGROUND,		// background fills
+		DRAW_STAGE_RENDER,			// IViewObject::Draw, the only pass or the pass against black in TMODE_FULL_ALPHA
+		DRAW_STAGE_RENDER_WHITE,	// IViewObject::Draw against white in TMODE_FULL_ALPHA
+		DRAW_STAGE_ALPHA_COMBINE,	// alpha calculation and hit mask update
+		DRAW_STAGE_BLIT,			// final BitBlt to the target DC, including copy from the frame cache
+		DRAW_STAGE_TOTAL,			// whole DrawFrame()
+		DRAW_STAGE_COUNT
+	};
+
+	//---------------------------------------------------------------------
+	/// Statistics of a DrawFrame() stage over the latest frames it took part in, in milliseconds.
+	struct SDrawStageStats
+	{
+		unsigned int	m_numSamples;
+		float			m_min;
+		float			m_mean;
+		float			m_p95;
+		float			m_max;
+	};
+
+	//---------------------------------------------------------------------
+	/// DrawFrame() timing breakdown.
+	struct SDrawTimings
+	{
+		SDrawStageStats	m_stages[DRAW_STAGE_COUNT];
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns DrawFrame() timing breakdown.
+	/// @param timings		Returned statistics.
+	/// @return				False if the library is built without FLASHDX_DRAW_TIMING, timings are zeroed then.
+	virtual bool GetDrawTimings(SDrawTimings& timings) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Resets DrawFrame() timing statistics.
+	virtual void ResetDrawTimings() = 0;
+
 	//---------------------------------------------------------------------
 	/// @brief				Sets mouse cursor position for the movie.
 	/// @param x			Target mouse X coordinate.
@@ -356,6 +840,149 @@ struct IFlashDXPlayer
 	/// @param extended		Extended data (see WM_CHAR event).
 	virtual void SendChar(UINT_PTR character, LONG_PTR extended) = 0;
 
+	//---------------------------------------------------------------------
+	/// @brief				Enables buffering of mouse and keyboard input.
+	/// @param enable		Buffering flag. Disabling delivers pending input right away.
+	///
+	/// Buffered input is delivered to Flash once per tick by IsNeedUpdate(), or by FlushInput().
+	/// Consecutive mouse moves are collapsed into the last one and consecutive wheel deltas are summed.
+	/// Button and key transitions keep their order.
+	virtual void SetInputBuffering(bool enable) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Delivers buffered input to Flash.
+	virtual void FlushInput() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Enables hit testing against alpha of TMODE_FULL_ALPHA players.
+	/// @param alphaThreshold Minimal alpha of pixels treated as opaque, zero disables hit testing.
+	/// @param filterInput	True to not send mouse input over transparent pixels to Flash.
+	///
+	/// Opacity mask is updated by DrawFrame(). With input filtering, presses over transparent pixels are
+	/// dropped, moves only while no button is held. Flash still gets the move that leaves opaque area.
+	virtual void SetHitTest(unsigned char alphaThreshold, bool filterInput) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Checks if the last drawn frame is opaque at the specified point.
+	/// @param x			X coordinate in player pixels.
+	/// @param y			Y coordinate in player pixels.
+	/// @return				False outside of the player or over transparent pixel. Players that are not
+	///						TMODE_FULL_ALPHA or don't have hit testing enabled are opaque everywhere.
+	virtual bool IsOpaqueAt(unsigned int x, unsigned int y) const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Starts recording calls made to the player into a binary log.
+	/// @param path			Log file path.
+	/// @return				Success flag.
+	///
+	/// Input, timeline, SetVariable(), SetProperty() and CallFunction() calls are recorded with timestamps.
+	virtual bool StartRecording(const wchar_t* path) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Stops recording and closes the log.
+	virtual void StopRecording() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Starts feeding recorded log into the player.
+	/// @param path			Log file path.
+	/// @return				Success flag.
+	///
+	/// Calls are made from IsNeedUpdate() with recorded timing, relative to this call.
+	virtual bool StartReplay(const wchar_t* path) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Stops replaying.
+	virtual void StopReplay() = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Checks if the log is still being replayed.
+	/// @return				True until all recorded calls are made.
+	virtual bool IsReplaying() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Starts writing dirty rects of the player into a trace file.
+	/// @param path			Trace file path.
+	/// @return				Success flag.
+	///
+	/// The trace holds surface size, rects added to the dirty list after visible rect clipping, and frame
+	/// boundaries from IsNeedUpdate() and DrawFrame(). Samples/DirtyRectReplay replays it offline.
+	virtual bool StartDirtyRectTrace(const wchar_t* path) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Stops dirty rect tracing and closes the trace.
+	virtual void StopDirtyRectTrace() = 0;
+
+	//---------------------------------------------------------------------
+	/// Workload counters, accumulated since the player creation, Reset() or ResetCounters().
+	struct SCounters
+	{
+		unsigned int		m_numDirtyRects;		///< dirty rects received from Flash
+		unsigned int		m_numDroppedDirtyRects;	///< dirty rects ignored while waiting for a new movie or suspended
+		unsigned int		m_numDrawnRects;		///< dirty rects left after coalescing, summed over drawn frames
+		unsigned int		m_numFrames;			///< frames drawn
+		unsigned __int64	m_dirtyPixels;			///< area of received dirty rects, overlaps included
+		unsigned __int64	m_drawnPixels;			///< area of coalesced dirty rects the host uploads
+		unsigned __int64	m_bytesSent;			///< XML sent with CallFunction() and SetReturnValue()
+		unsigned __int64	m_bytesReceived;		///< XML received with FlashCall and CallFunction() results
+		unsigned int		m_numFlashCalls;		///< FlashCall events, see GetFlashCallCounters() for breakdown
+		unsigned int		m_numFSCommands;		///< FSCommand events
+		unsigned int		m_numInputEvents;		///< input events passed to the player
+		unsigned int		m_numDroppedInput;		///< input events coalesced by input buffering or filtered by hit test
+	};
+
+	//---------------------------------------------------------------------
+	/// Number of FlashCall events with the same function name.
+	struct SFlashCallCounter
+	{
+		const wchar_t*		m_name;
+		unsigned int		m_numCalls;
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns workload counters.
+	/// @param counters		Returned counters.
+	virtual void GetCounters(SCounters& counters) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns FlashCall counts by function name.
+	/// @param counters		Array to fill, may be NULL.
+	/// @param maxCounters	Size of the array.
+	/// @return				Number of different names called, may be more than maxCounters.
+	///
+	/// Names stay valid until ResetCounters() or Reset().
+	virtual unsigned int GetFlashCallCounters(SFlashCallCounter* counters, unsigned int maxCounters) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Resets workload counters.
+	virtual void ResetCounters() = 0;
+
+	//---------------------------------------------------------------------
+	/// Memory held by the player, in bytes. Allocations made by Flash itself are not visible and not included.
+	struct SMemoryUsage
+	{
+		unsigned int		m_frameBuffer;			///< frame buffer rendered by worker thread
+		unsigned int		m_renderScratch;		///< render buffer pool memory borrowed by one DrawFrame() at most
+		unsigned int		m_dirtyRects;			///< dirty rect lists
+		unsigned int		m_strings;				///< CallFunction() and GetVariable()/GetProperty() result strings, frame cache keys
+		unsigned int		m_eventHandlers;		///< event handlers, ASInterface callback tables included
+		unsigned int		m_frameCache;			///< compressed frames, see SetFrameCache()
+		unsigned int		m_movie;				///< movie loaded by LoadMovieAsync() but not passed to Flash yet
+		unsigned int		m_hitMask;				///< alpha mask, see SetHitTest()
+		unsigned int		m_input;				///< buffered input events
+		unsigned int		m_other;				///< player object and FlashCall counters
+		unsigned int		m_total;				///< sum of the above, except m_renderScratch shared through the pool
+
+		/// Estimated size of std::map/std::set node holding value of type T: three links, color and the value.
+		template <class T> static unsigned int GetTreeNodeSize() { return (unsigned int)(4 * sizeof(void*) + sizeof(T)); }
+	};
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns memory held by the player.
+	/// @param usage		Returned memory usage.
+	///
+	/// See IFlashDX::GetMemoryUsage() for all players and memory shared by them.
+	virtual void GetMemoryUsage(SMemoryUsage& usage) = 0;
+
 	//---------------------------------------------------------------------
 	/// @brief				Enables/disables sound for flash control.
 	/// @param enable		New status.
@@ -406,6 +1033,122 @@ struct IFlashDXPlayer
 	/// @brief				Returns number of registered event handlers.
 	/// @return				Number of event handlers.
 	virtual unsigned int GetNumEventHandlers() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns command proxy that can be used from any thread.
+	/// @return				Proxy interface owned by the player.
+	///
+	/// Commands sent through the proxy are executed in order on the thread that owns the player,
+	/// at the beginning of IsNeedUpdate() (CollectUpdates() and RenderAsync() call it too).
+	virtual struct IFlashDXPlayerProxy* GetCommandProxy() = 0;
+};
+
+
+//---------------------------------------------------------------------
+/// Result of the command executed asynchronously. See IFlashDXPlayerProxy.
+//---------------------------------------------------------------------
+struct IFlashDXFuture
+{
+	//---------------------------------------------------------------------
+	/// @brief				Checks if the command was executed.
+	/// @return				Ready flag.
+	virtual bool IsReady() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Waits for the command to be executed.
+	/// @param timeout		Timeout in milliseconds, INFINITE to wait forever.
+	/// @return				Ready flag.
+	///
+	/// Never wait on the thread that owns the player, the command is executed there.
+	virtual bool Wait(unsigned int timeout) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Returns result of the command.
+	/// @return				Result string, NULL if the command is not executed yet or failed.
+	virtual const wchar_t* GetResult() const = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Releases the future. Should be called once for every returned future.
+	virtual void Release() = 0;
+};
+
+
+//---------------------------------------------------------------------
+/// Thread-safe player command proxy. See IFlashDXPlayer::GetCommandProxy().
+///
+/// Methods return false (or NULL) if the command queue is full.
+//---------------------------------------------------------------------
+struct IFlashDXPlayerProxy
+{
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::SetVariable().
+	/// @param name			Name of the variable.
+	/// @param value		New value for the variable.
+	/// @return				Success flag.
+	virtual bool SetVariable(const wchar_t* name, const wchar_t* value) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::GetVariable().
+	/// @param name			Name of the variable.
+	/// @return				Future receiving content of the variable.
+	virtual IFlashDXFuture* GetVariable(const wchar_t* name) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::GotoFrame().
+	/// @param frame		Target frame.
+	/// @param timelineTarget Time line of the movie.
+	/// @return				Success flag.
+	virtual bool GotoFrame(int frame, const wchar_t* timelineTarget = L"/") = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::GotoLabel().
+	/// @param label		Target label.
+	/// @param timelineTarget Time line of the movie.
+	/// @return				Success flag.
+	virtual bool GotoLabel(const wchar_t* label, const wchar_t* timelineTarget = L"/") = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::StartPlaying().
+	/// @param timelineTarget Time line of the movie.
+	/// @return				Success flag.
+	virtual bool StartPlaying(const wchar_t* timelineTarget = L"/") = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::StopPlaying().
+	/// @param timelineTarget Time line of the movie.
+	/// @return				Success flag.
+	virtual bool StopPlaying(const wchar_t* timelineTarget = L"/") = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Queues IFlashDXPlayer::CallFunction().
+	/// @param request		Function call XML.
+	/// @return				Future receiving function call result.
+	virtual IFlashDXFuture* CallFunction(const wchar_t* request) = 0;
+};
+
+
+//---------------------------------------------------------------------
+/// Predicted rendering cost of the movie. See IFlashDX::AnalyzeMovie().
+//---------------------------------------------------------------------
+struct SMovieCost
+{
+	unsigned int	m_numFrames;			///< frames in the main timeline
+	unsigned int	m_numShapes;			///< shape definitions
+	unsigned int	m_numEdges;				///< edges in all shape definitions
+	unsigned int	m_maxShapesPerFrame;	///< maximum number of shapes on the stage, sprites included
+	unsigned int	m_maxEdgesPerFrame;		///< maximum number of edges on the stage, sprites included
+	unsigned int	m_avgEdgesPerFrame;		///< average number of edges on the stage
+	unsigned int	m_numBitmaps;			///< bitmap definitions
+	unsigned int	m_maxBitmapWidth;
+	unsigned int	m_maxBitmapHeight;
+	unsigned int	m_bitmapMemory;			///< memory required for all decoded bitmaps, in bytes
+	unsigned int	m_numFilters;			///< filters applied by PlaceObject3 tags
+	unsigned int	m_numBlendModes;		///< objects placed with blend mode other than normal
+	unsigned int	m_numDeviceFontTexts;	///< DefineEditText tags that don't use outlines (see ETransparencyMode note)
+	bool			m_hasSemiTransparency;	///< movie uses alpha colors, alpha bitmaps, alpha color transforms or filters
+
+	IFlashDXPlayer::EQuality			m_recommendedQuality;
+	IFlashDXPlayer::ETransparencyMode	m_recommendedTransparencyMode;	///< for movies composited over the scene
 };
 
 
@@ -437,4 +1180,24 @@ struct IFlashDXEventHandler
 	///
 	/// Please use provided ASInterface helper to ease the task of calling and handling Flash events.
 	virtual HRESULT FSCommand(const wchar_t* command, const wchar_t* args) = 0;
+
+	//---------------------------------------------------------------------
+	/// @brief				Called while the movie is loading.
+	/// @param percentDone	Percent of the movie loaded.
+	virtual void OnProgress(long /*percentDone*/) {}
+
+	//---------------------------------------------------------------------
+	/// @brief				Called when ready state of the movie changes.
+	/// @param newState		0 - loading, 1 - uninitialized, 2 - loaded, 3 - interactive, 4 - complete.
+	virtual void OnReadyStateChange(long /*newState*/) {}
+
+	//---------------------------------------------------------------------
+	/// @brief				Called when movie requested by IFlashDXPlayer::LoadMovieAsync() is ready to play.
+	/// @param success		False if the movie could not be loaded, previous movie is kept then.
+	virtual void OnMovieLoaded(bool /*success*/) {}
+
+	//---------------------------------------------------------------------
+	/// @brief				Called by IFlashDXPlayer::GetMemoryUsage().
+	/// @return				Bytes of memory held by the handler, e.g. callback tables.
+	virtual unsigned int GetMemoryUsage() const { return 0; }
 };
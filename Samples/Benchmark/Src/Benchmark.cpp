@@ -0,0 +1,536 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+// Micro-benchmarks of Flash-to-DirectX parts that don't need a running movie:
+// ASValue XML conversion, ASInterface callback dispatch, dirty rect coalescing, FULL_ALPHA combine
+// and the shared memory ring of remote players, fed by a stand-in producer thread.
+// Optional dirty rect trace, written by IFlashDXPlayer::StartDirtyRectTrace(), is replayed through coalescing too.
+//
+// Usage: Benchmark [results.json [trace]]
+// Every case is reported as a JSON object on its own line, to stdout and to the optional results file.
+// Makefile builds the benchmark on other systems, without ASValue and ASInterface cases: they need
+// the library and a compiler that accepts ASInterface.h.
+
+#include "stdafx.h"
+#ifdef _WIN32
+#include "../../../Include/IFlashDX.h"
+#include "../../../Include/ASInterface.h"
+#endif
+#include "../../../Source/Implementation/DirtyRects.h"
+#include "../../../Source/Implementation/DirtyRectTrace.h"
+#include "../../../Source/Implementation/AlphaCombine.h"
+#include "../../../Source/Implementation/SharedRing.h"
+
+#ifdef _WIN32
+#include <process.h>
+
+#pragma comment(lib, "FlashDX" CONFIGURATION_NAME "_" PLATFORM_NAME ".lib")
+#endif
+
+//---------------------------------------------------------------------
+const double min_case_time = 200.0;		// milliseconds each case runs for
+const int num_batches = 10;				// min_case_time is split into batches, the fastest batch is reported too
+const unsigned int surface_width = 1280;
+const unsigned int surface_height = 720;
+
+FILE*				g_resultsFile = NULL;
+LARGE_INTEGER		g_frequency;
+unsigned int		g_randomSeed = 1;
+
+//---------------------------------------------------------------------
+double GetTimeMs()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return double(counter.QuadPart) * 1000.0 / double(g_frequency.QuadPart);
+}
+
+//---------------------------------------------------------------------
+// Deterministic random numbers, so every run measures the same data.
+unsigned int Random(unsigned int range)
+{
+	g_randomSeed = g_randomSeed * 1664525 + 1013904223;
+	return (g_randomSeed >> 8) % range;
+}
+
+//---------------------------------------------------------------------
+void Report(const char* benchmark, const char* name, unsigned int iterations, double meanTime, double minTime)
+{
+	char line[512];
+	sprintf_s(line, "{\"benchmark\":\"%s\",\"case\":\"%s\",\"iterations\":%u,\"mean_us\":%.3f,\"min_us\":%.3f}\n",
+		benchmark, name, iterations, meanTime * 1000.0, minTime * 1000.0);
+
+	fputs(line, stdout);
+	if (g_resultsFile)
+		fputs(line, g_resultsFile);
+}
+
+//---------------------------------------------------------------------
+// Calls func repeatedly for about min_case_time and reports time per call.
+void Run(const char* benchmark, const char* name, void (*func)(void* context), void* context)
+{
+	// Warm up and estimate number of calls per batch
+	double startTime = GetTimeMs();
+	unsigned int numCalls = 0;
+	do
+	{
+		func(context);
+		++numCalls;
+	}
+	while (GetTimeMs() - startTime < min_case_time / num_batches);
+
+	unsigned int totalCalls = 0;
+	double totalTime = 0.0;
+	double minTime = DBL_MAX;
+	for (int batch = 0; batch < num_batches; ++batch)
+	{
+		double batchStart = GetTimeMs();
+		for (unsigned int i = 0; i < numCalls; ++i)
+			func(context);
+		double batchTime = GetTimeMs() - batchStart;
+
+		totalCalls += numCalls;
+		totalTime += batchTime;
+		minTime = min(minTime, batchTime / numCalls);
+	}
+
+	Report(benchmark, name, totalCalls, totalTime / totalCalls, minTime);
+}
+
+#ifdef _WIN32
+//---------------------------------------------------------------------
+// ASValue
+//---------------------------------------------------------------------
+struct SValueCase
+{
+	ASValue				m_value;
+	std::wstring		m_xml;
+};
+
+//---------------------------------------------------------------------
+void EncodeValue(void* context)
+{
+	SValueCase& valueCase = *(SValueCase*)context;
+	valueCase.m_xml = valueCase.m_value.ToXML();
+}
+
+//---------------------------------------------------------------------
+void DecodeValue(void* context)
+{
+	SValueCase& valueCase = *(SValueCase*)context;
+	ASValue value;
+	value.FromXML(valueCase.m_xml);
+}
+
+//---------------------------------------------------------------------
+void RunValueCase(const char* name, const ASValue& value)
+{
+	SValueCase valueCase;
+	valueCase.m_value = value;
+	valueCase.m_xml = value.ToXML();
+
+	Run("asvalue_encode", name, EncodeValue, &valueCase);
+	Run("asvalue_decode", name, DecodeValue, &valueCase);
+}
+
+//---------------------------------------------------------------------
+void RunValueBenchmarks()
+{
+	RunValueCase("scalar", ASValue(42.5f));
+
+	ASValue::Array wideArray;
+	for (int i = 0; i < 1000; ++i)
+		wideArray.push_back(ASValue(float(i)));
+	RunValueCase("wide_array", ASValue(wideArray));
+
+	ASValue deepObject = ASValue(std::wstring(L"leaf"));
+	for (int depth = 0; depth < 32; ++depth)
+	{
+		ASValue::Object object;
+		object[L"child"] = deepObject;
+		object[L"depth"] = ASValue(float(depth));
+		object[L"visible"] = ASValue(true);
+		deepObject = ASValue(object);
+	}
+	RunValueCase("deep_object", deepObject);
+}
+
+//---------------------------------------------------------------------
+// ASInterface
+//---------------------------------------------------------------------
+struct SDispatchCase
+{
+	IFlashDXEventHandler*	m_handler;
+	std::wstring			m_request;
+};
+
+//---------------------------------------------------------------------
+void OnBenchmarkCall(float value, std::wstring text)
+{
+}
+
+//---------------------------------------------------------------------
+void Dispatch(void* context)
+{
+	SDispatchCase& dispatchCase = *(SDispatchCase*)context;
+	dispatchCase.m_handler->FlashCall(dispatchCase.m_request.c_str());
+}
+
+//---------------------------------------------------------------------
+void RunDispatchBenchmarks()
+{
+	IFlashDX* flashDX = GetFlashToDirectXInstance();
+	IFlashDXPlayer* player = flashDX->CreatePlayer(64, 64);
+	if (player == NULL)
+	{
+		fputs("ASInterface benchmarks skipped, Flash player is not available\n", stderr);
+		return;
+	}
+
+	static const unsigned int numCallbackCases[] = { 1, 100 };
+	for (unsigned int i = 0; i < sizeof(numCallbackCases) / sizeof(numCallbackCases[0]); ++i)
+	{
+		// Requests are fed to the handler directly, as the player would pass FlashCall from the movie
+		ASInterface playerASI(player);
+		for (unsigned int callback = 0; callback < numCallbackCases[i]; ++callback)
+		{
+			wchar_t name[32];
+			swprintf_s(name, L"callback%u", callback);
+			playerASI.AddCallback(name, OnBenchmarkCall);
+		}
+
+		SDispatchCase dispatchCase;
+		dispatchCase.m_handler = player->GetEventHandlerByIndex(player->GetNumEventHandlers() - 1);
+		dispatchCase.m_request = L"<invoke name=\"callback0\" returntype=\"xml\"><arguments><number>1.5</number><string>text</string></arguments></invoke>";
+
+		char name[32];
+		sprintf_s(name, "%u_callbacks", numCallbackCases[i]);
+		Run("asinterface_dispatch", name, Dispatch, &dispatchCase);
+	}
+
+	flashDX->DestroyPlayer(player);
+}
+#endif
+
+//---------------------------------------------------------------------
+// Dirty rects
+//---------------------------------------------------------------------
+struct SCoalesceCase
+{
+	std::vector<RECT>		m_rects;
+	CDirtyRects				m_dirtyRects;
+};
+
+//---------------------------------------------------------------------
+void Coalesce(void* context)
+{
+	SCoalesceCase& coalesceCase = *(SCoalesceCase*)context;
+	coalesceCase.m_dirtyRects.Clear();
+	for (size_t i = 0; i < coalesceCase.m_rects.size(); ++i)
+		coalesceCase.m_dirtyRects.Add(coalesceCase.m_rects[i], surface_width, surface_height);
+	coalesceCase.m_dirtyRects.Reduce();
+}
+
+//---------------------------------------------------------------------
+void AddRandomRect(std::vector<RECT>& rects, unsigned int maxSize)
+{
+	RECT rect;
+	rect.left = Random(surface_width - maxSize);
+	rect.top = Random(surface_height - maxSize);
+	rect.right = rect.left + 1 + Random(maxSize);
+	rect.bottom = rect.top + 1 + Random(maxSize);
+	rects.push_back(rect);
+}
+
+//---------------------------------------------------------------------
+void RunCoalesceBenchmarks()
+{
+	SCoalesceCase scattered;
+	for (int i = 0; i < 64; ++i)
+		AddRandomRect(scattered.m_rects, 48);
+	Run("dirty_rects", "scattered_64", Coalesce, &scattered);
+
+	// Small rects added first and covered by a later big one, as an animated panel behind moving items
+	SCoalesceCase nested;
+	for (int i = 0; i < 64; ++i)
+		AddRandomRect(nested.m_rects, 16);
+	RECT panel = { 0, 0, surface_width, surface_height };
+	nested.m_rects.push_back(panel);
+	Run("dirty_rects", "nested_65", Coalesce, &nested);
+
+	SCoalesceCase grid;
+	for (LONG y = 0; y < 9; ++y)
+		for (LONG x = 0; x < 16; ++x)
+		{
+			RECT tile = { x * 80, y * 80, x * 80 + 80, y * 80 + 80 };
+			grid.m_rects.push_back(tile);
+		}
+	Run("dirty_rects", "grid_144", Coalesce, &grid);
+}
+
+//---------------------------------------------------------------------
+// Rects that reached the dirty list between two DrawFrame() calls of the traced player.
+struct STraceFrame
+{
+	std::vector<RECT>		m_rects;
+	std::vector<bool>		m_replace;
+	unsigned int			m_numRectsBeforeUpdate;	// rects coalesced by IsNeedUpdate(), the rest is drawn unreduced
+};
+
+//---------------------------------------------------------------------
+struct STraceCase
+{
+	unsigned int			m_width;
+	unsigned int			m_height;
+	std::vector<STraceFrame> m_frames;
+	unsigned int			m_nextFrame;
+	CDirtyRects				m_dirtyRects;
+};
+
+//---------------------------------------------------------------------
+// Coalesces one traced frame per call, the same way the player does, cycling through the trace.
+void CoalesceTraceFrame(void* context)
+{
+	STraceCase& traceCase = *(STraceCase*)context;
+	const STraceFrame& frame = traceCase.m_frames[traceCase.m_nextFrame];
+	traceCase.m_nextFrame = (traceCase.m_nextFrame + 1) % (unsigned int)traceCase.m_frames.size();
+
+	traceCase.m_dirtyRects.Clear();
+	for (unsigned int i = 0; i < frame.m_rects.size(); ++i)
+	{
+		if (i == frame.m_numRectsBeforeUpdate)
+			traceCase.m_dirtyRects.Reduce();
+
+		if (frame.m_replace[i])
+			traceCase.m_dirtyRects.Set(frame.m_rects[i]);
+		else
+			traceCase.m_dirtyRects.Add(frame.m_rects[i], (LONG)traceCase.m_width, (LONG)traceCase.m_height);
+	}
+	if (frame.m_numRectsBeforeUpdate == frame.m_rects.size())
+		traceCase.m_dirtyRects.Reduce();
+}
+
+//---------------------------------------------------------------------
+void RunTraceBenchmark(const _TCHAR* path)
+{
+	CDirtyRectTraceReader reader;
+	if (!reader.Open(path))
+	{
+		_ftprintf(stderr, _T("Can't read trace %s\n"), path);
+		return;
+	}
+
+	STraceCase traceCase;
+	traceCase.m_width = surface_width;
+	traceCase.m_height = surface_height;
+	traceCase.m_nextFrame = 0;
+
+	STraceFrame frame;
+	frame.m_numRectsBeforeUpdate = 0;
+	bool updated = false;
+
+	SDirtyRectRecord record;
+	while (reader.Read(record))
+	{
+		switch (record.m_type)
+		{
+		case DIRTY_SURFACE:
+			traceCase.m_width = (unsigned int)record.m_args[0];
+			traceCase.m_height = (unsigned int)record.m_args[1];
+			break;
+
+		case DIRTY_SET:
+		case DIRTY_ADD:
+			{
+				RECT rect = { record.m_args[0], record.m_args[1], record.m_args[2], record.m_args[3] };
+				frame.m_rects.push_back(rect);
+				frame.m_replace.push_back(record.m_type == DIRTY_SET);
+			}
+			break;
+
+		case DIRTY_UPDATE:
+			frame.m_numRectsBeforeUpdate = (unsigned int)frame.m_rects.size();
+			updated = true;
+			break;
+
+		case DIRTY_DRAW:
+			if (!updated)
+				frame.m_numRectsBeforeUpdate = (unsigned int)frame.m_rects.size();
+			traceCase.m_frames.push_back(frame);
+
+			frame.m_rects.clear();
+			frame.m_replace.clear();
+			frame.m_numRectsBeforeUpdate = 0;
+			updated = false;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (traceCase.m_frames.empty())
+	{
+		_ftprintf(stderr, _T("Trace %s has no drawn frames\n"), path);
+		return;
+	}
+
+	// Reported time is per frame, mean over the whole trace
+	Run("dirty_rects", "trace_frame", CoalesceTraceFrame, &traceCase);
+}
+
+//---------------------------------------------------------------------
+// Alpha combine
+//---------------------------------------------------------------------
+struct SAlphaCase
+{
+	std::vector<BYTE>		m_black;
+	std::vector<BYTE>		m_white;
+	RECT					m_rect;
+};
+
+//---------------------------------------------------------------------
+void Combine(void* context)
+{
+	SAlphaCase& alphaCase = *(SAlphaCase*)context;
+	CombineAlpha(&alphaCase.m_black[0], alphaCase.m_rect.right * 4, &alphaCase.m_white[0], alphaCase.m_rect.right * 4, alphaCase.m_rect);
+}
+
+//---------------------------------------------------------------------
+void RunAlphaCase(const char* name, unsigned int width, unsigned int height)
+{
+	SAlphaCase alphaCase;
+	alphaCase.m_black.resize(width * height * 4);
+	alphaCase.m_white.resize(width * height * 4);
+	for (size_t i = 0; i < alphaCase.m_black.size(); ++i)
+	{
+		alphaCase.m_black[i] = (BYTE)Random(128);
+		alphaCase.m_white[i] = alphaCase.m_black[i] + (BYTE)Random(128);
+	}
+	SetRect(&alphaCase.m_rect, 0, 0, width, height);
+
+	Run("alpha_combine", name, Combine, &alphaCase);
+}
+
+//---------------------------------------------------------------------
+void RunAlphaBenchmarks()
+{
+	RunAlphaCase("widget_256x64", 256, 64);
+	RunAlphaCase("hd_1280x720", 1280, 720);
+	RunAlphaCase("4k_3840x2160", 3840, 2160);
+}
+
+//---------------------------------------------------------------------
+// Shared ring
+//---------------------------------------------------------------------
+struct SRingCase
+{
+	std::vector<BYTE>		m_memory;
+	CSharedRing				m_producer;
+	CSharedRing				m_consumer;
+	std::vector<BYTE>		m_part;			// message written over and over by the producer
+	std::vector<BYTE>		m_frame;		// where the consumer copies messages to
+	volatile LONG			m_stop;
+};
+
+//---------------------------------------------------------------------
+// Stands in for the host process: writes messages as fast as the consumer frees room.
+unsigned int __stdcall ProduceParts(void* context)
+{
+	SRingCase& ringCase = *(SRingCase*)context;
+	while (!ringCase.m_stop)
+	{
+		if (!ringCase.m_producer.Write(&ringCase.m_part[0], (unsigned int)ringCase.m_part.size()))
+			SwitchToThread();
+	}
+	return 0;
+}
+
+//---------------------------------------------------------------------
+void ConsumePart(void* context)
+{
+	SRingCase& ringCase = *(SRingCase*)context;
+
+	unsigned int size;
+	while (!ringCase.m_consumer.BeginRead(size))
+		SwitchToThread();
+
+	ringCase.m_consumer.ReadData(&ringCase.m_frame[0], size);
+	ringCase.m_consumer.EndRead();
+}
+
+//---------------------------------------------------------------------
+void RunRingCase(const char* name, unsigned int capacity, unsigned int partSize)
+{
+	SRingCase ringCase;
+	ringCase.m_memory.resize(CSharedRing::GetMemorySize(capacity));
+	ringCase.m_producer.Create(&ringCase.m_memory[0], capacity);
+	ringCase.m_consumer.Attach(&ringCase.m_memory[0]);
+	ringCase.m_part.resize(partSize);
+	for (size_t i = 0; i < ringCase.m_part.size(); ++i)
+		ringCase.m_part[i] = (BYTE)Random(256);
+	ringCase.m_frame.resize(partSize);
+	ringCase.m_stop = 0;
+
+	HANDLE producer = (HANDLE)_beginthreadex(NULL, 0, ProduceParts, &ringCase, 0, NULL);
+	Run("shared_ring", name, ConsumePart, &ringCase);
+
+	InterlockedExchange(&ringCase.m_stop, 1);
+	WaitForSingleObject(producer, INFINITE);
+	CloseHandle(producer);
+}
+
+//---------------------------------------------------------------------
+// Sizes of events and of frame parts a remote player host sends.
+void RunRingBenchmarks()
+{
+	RunRingCase("event_64b", 1024 * 1024, 64);
+	RunRingCase("rect_64x64", 4 * 1024 * 1024, 64 * 64 * 4);
+	RunRingCase("band_1280x64", 4 * 1024 * 1024, 1280 * 64 * 4);
+}
+
+//---------------------------------------------------------------------
+int _tmain(int argc, _TCHAR* argv[])
+{
+	QueryPerformanceFrequency(&g_frequency);
+
+	if (argc > 1 && _tfopen_s(&g_resultsFile, argv[1], _T("w")) != 0)
+	{
+		_ftprintf(stderr, _T("Can't open %s\n"), argv[1]);
+		return 1;
+	}
+
+#ifdef _WIN32
+	RunValueBenchmarks();
+	RunDispatchBenchmarks();
+#endif
+	RunCoalesceBenchmarks();
+	if (argc > 2)
+		RunTraceBenchmark(argv[2]);
+	RunAlphaBenchmarks();
+	RunRingBenchmarks();
+
+	if (g_resultsFile)
+		fclose(g_resultsFile);
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+
+#include "targetver.h"
+
+#define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+
+// Windows Header Files:
+#include <windows.h>
+#include <assert.h>
+
+// C RunTime Header Files
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+#include <tchar.h>
+
+#include <string>
+#include <vector>
+
+#else
+
+// Other systems build the cases that don't need Flash with the Makefile, Win32 bits they use are emulated here
+#include "../../Source/Implementation/Portable.h"
+#include <assert.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <time.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <string>
+#include <vector>
+
+#define min(a, b)				(((a) < (b)) ? (a) : (b))
+#define max(a, b)				(((a) > (b)) ? (a) : (b))
+#define __int64					long long
+#define __stdcall
+#define sprintf_s(buffer, ...)	snprintf(buffer, sizeof(buffer), __VA_ARGS__)
+
+#define _tmain					main
+typedef char					_TCHAR;
+#define _T(text)				text
+#define _ftprintf				fprintf
+#define _tfopen_s(file, path, mode)	((*(file) = fopen(path, mode)) == NULL)
+
+union LARGE_INTEGER
+{
+	long long				QuadPart;
+};
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	counter->QuadPart = (long long)time.tv_sec * 1000000000 + time.tv_nsec;
+	return TRUE;
+}
+
+inline LONG InterlockedExchange(volatile LONG* target, LONG value)
+{
+	return __sync_lock_test_and_set(target, value);
+}
+
+inline BOOL SwitchToThread()
+{
+	return sched_yield() == 0;
+}
+
+// Thread handles are the only handles the benchmark uses
+typedef void*					HANDLE;
+#define INFINITE				0xFFFFFFFF
+
+struct SThread
+{
+	pthread_t				m_thread;
+	unsigned int			(*m_func)(void* context);
+	void*					m_context;
+};
+
+inline void* RunThread(void* param)
+{
+	SThread* thread = (SThread*)param;
+	thread->m_func(thread->m_context);
+	return NULL;
+}
+
+inline uintptr_t _beginthreadex(void* /*security*/, unsigned int /*stackSize*/, unsigned int (*func)(void* context), void* context,
+	unsigned int /*flags*/, unsigned int* /*threadId*/)
+{
+	SThread* thread = new SThread;
+	thread->m_func = func;
+	thread->m_context = context;
+	if (pthread_create(&thread->m_thread, NULL, RunThread, thread) != 0)
+	{
+		delete thread;
+		return 0;
+	}
+	return (uintptr_t)thread;
+}
+
+inline DWORD WaitForSingleObject(HANDLE thread, DWORD /*timeout*/)
+{
+	pthread_join(((SThread*)thread)->m_thread, NULL);
+	return 0;
+}
+
+inline BOOL CloseHandle(HANDLE thread)
+{
+	delete (SThread*)thread;
+	return TRUE;
+}
+
+#endif
@@ -0,0 +1,289 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+// Offline replay of a dirty rect trace written by IFlashDXPlayer::StartDirtyRectTrace().
+// Every frame is fed through the player's dirty rect coalescing and measured:
+// coalescing time, number of rects before and after, and overdraw - pixels drawn over pixels really invalidated.
+//
+// Usage: DirtyRectReplay trace [results.json]
+// Builds with Visual Studio, or with the Makefile on other systems.
+// Every frame and the summary are reported as JSON objects on their own lines, to stdout and to the optional results file.
+
+#include "stdafx.h"
+#include "../../../Source/Implementation/DirtyRects.h"
+#include "../../../Source/Implementation/DirtyRectTrace.h"
+
+#ifdef _WIN32
+#pragma comment(lib, "FlashDX" CONFIGURATION_NAME "_" PLATFORM_NAME ".lib")
+#endif
+
+//---------------------------------------------------------------------
+const unsigned int num_repeats = 100;		// every frame is coalesced this many times, the fastest run is reported
+
+FILE*				g_resultsFile = NULL;
+LARGE_INTEGER		g_frequency;
+
+//---------------------------------------------------------------------
+// Rects that reached the dirty list between two DrawFrame() calls.
+struct SFrame
+{
+	DWORD					m_time;
+	unsigned int			m_width;
+	unsigned int			m_height;
+	std::vector<RECT>		m_rects;
+	std::vector<bool>		m_replace;
+	unsigned int			m_numRectsBeforeUpdate;	// the rest arrived after IsNeedUpdate() and was drawn unreduced
+	int						m_recordedRects;		// -1 if IsNeedUpdate() wasn't recorded
+	int						m_drawTime;				// microseconds
+};
+
+//---------------------------------------------------------------------
+double GetTimeMs()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return double(counter.QuadPart) * 1000.0 / double(g_frequency.QuadPart);
+}
+
+//---------------------------------------------------------------------
+void Report(const char* line)
+{
+	fputs(line, stdout);
+	if (g_resultsFile)
+		fputs(line, g_resultsFile);
+}
+
+//---------------------------------------------------------------------
+unsigned int GetRectArea(const RECT& rect)
+{
+	if (IsRectEmpty(&rect))
+		return 0;
+	return (unsigned int)((rect.right - rect.left) * (rect.bottom - rect.top));
+}
+
+//---------------------------------------------------------------------
+bool LoadFrames(const _TCHAR* path, std::vector<SFrame>& frames)
+{
+	CDirtyRectTraceReader reader;
+	if (!reader.Open(path))
+		return false;
+
+	SFrame frame;
+	frame.m_width = 0;
+	frame.m_height = 0;
+	frame.m_numRectsBeforeUpdate = 0;
+	frame.m_recordedRects = -1;
+
+	SDirtyRectRecord record;
+	while (reader.Read(record))
+	{
+		switch (record.m_type)
+		{
+		case DIRTY_SURFACE:
+			frame.m_width = (unsigned int)record.m_args[0];
+			frame.m_height = (unsigned int)record.m_args[1];
+			break;
+
+		case DIRTY_SET:
+		case DIRTY_ADD:
+			{
+				RECT rect = { record.m_args[0], record.m_args[1], record.m_args[2], record.m_args[3] };
+				frame.m_rects.push_back(rect);
+				frame.m_replace.push_back(record.m_type == DIRTY_SET);
+			}
+			break;
+
+		case DIRTY_UPDATE:
+			frame.m_numRectsBeforeUpdate = (unsigned int)frame.m_rects.size();
+			frame.m_recordedRects = record.m_args[0];
+			break;
+
+		case DIRTY_DRAW:
+			frame.m_time = record.m_time;
+			frame.m_drawTime = record.m_args[0];
+			if (frame.m_recordedRects < 0)
+				frame.m_numRectsBeforeUpdate = (unsigned int)frame.m_rects.size();
+			frames.push_back(frame);
+
+			frame.m_rects.clear();
+			frame.m_replace.clear();
+			frame.m_numRectsBeforeUpdate = 0;
+			frame.m_recordedRects = -1;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// Rects after the last DrawFrame() were never drawn and are ignored
+	return true;
+}
+
+//---------------------------------------------------------------------
+// Feeds frame rects into dirty rects the same way the player does.
+void Coalesce(const SFrame& frame, CDirtyRects& dirtyRects)
+{
+	dirtyRects.Clear();
+	for (unsigned int i = 0; i < frame.m_rects.size(); ++i)
+	{
+		if (i == frame.m_numRectsBeforeUpdate)
+			dirtyRects.Reduce();
+
+		if (frame.m_replace[i])
+			dirtyRects.Set(frame.m_rects[i]);
+		else
+			dirtyRects.Add(frame.m_rects[i], (LONG)frame.m_width, (LONG)frame.m_height);
+	}
+	if (frame.m_numRectsBeforeUpdate == frame.m_rects.size())
+		dirtyRects.Reduce();
+}
+
+//---------------------------------------------------------------------
+// Counts pixels covered by the original rects, overlaps counted once.
+unsigned __int64 GetCoveredPixels(const SFrame& frame, std::vector<BYTE>& coverage)
+{
+	coverage.assign(frame.m_width * frame.m_height, 0);
+
+	RECT surfaceRect = { 0, 0, (LONG)frame.m_width, (LONG)frame.m_height };
+	unsigned __int64 coveredPixels = 0;
+
+	for (unsigned int i = 0; i < frame.m_rects.size(); ++i)
+	{
+		RECT rect;
+		if (!IntersectRect(&rect, &frame.m_rects[i], &surfaceRect))
+			continue;
+
+		for (LONG y = rect.top; y < rect.bottom; ++y)
+		{
+			BYTE* row = &coverage[y * frame.m_width];
+			for (LONG x = rect.left; x < rect.right; ++x)
+			{
+				coveredPixels += 1 - row[x];
+				row[x] = 1;
+			}
+		}
+	}
+
+	return coveredPixels;
+}
+
+//---------------------------------------------------------------------
+bool ReplayTrace(const _TCHAR* path)
+{
+	std::vector<SFrame> frames;
+	if (!LoadFrames(path, frames))
+		return false;
+
+	CDirtyRects dirtyRects;
+	std::vector<BYTE> coverage;
+
+	double totalTime = 0.0;
+	double maxTime = 0.0;
+	unsigned __int64 totalInputRects = 0;
+	unsigned __int64 totalRects = 0;
+	unsigned __int64 totalCoveredPixels = 0;
+	unsigned __int64 totalDrawnPixels = 0;
+	unsigned int numMismatches = 0;
+
+	for (unsigned int frameIndex = 0; frameIndex < frames.size(); ++frameIndex)
+	{
+		const SFrame& frame = frames[frameIndex];
+
+		double frameTime = DBL_MAX;
+		for (unsigned int i = 0; i < num_repeats; ++i)
+		{
+			double startTime = GetTimeMs();
+			Coalesce(frame, dirtyRects);
+			frameTime = min(frameTime, GetTimeMs() - startTime);
+		}
+
+		const std::vector<RECT>& rects = dirtyRects.GetRects();
+		unsigned __int64 drawnPixels = 0;
+		for (std::vector<RECT>::const_iterator it = rects.begin(); it != rects.end(); ++it)
+			drawnPixels += GetRectArea(*it);
+
+		unsigned __int64 coveredPixels = GetCoveredPixels(frame, coverage);
+		double overdraw = coveredPixels ? double(drawnPixels) / double(coveredPixels) : 1.0;
+
+		// Unreduced rects that arrived after IsNeedUpdate() aren't part of the recorded count
+		bool mismatch = frame.m_recordedRects >= 0 && frame.m_numRectsBeforeUpdate == frame.m_rects.size() &&
+			(unsigned int)frame.m_recordedRects != rects.size();
+		if (mismatch)
+			++numMismatches;
+
+		char line[512];
+		sprintf_s(line, "{\"frame\":%u,\"time_ms\":%u,\"width\":%u,\"height\":%u,\"input_rects\":%u,\"rects\":%u,\"recorded_rects\":%d,"
+			"\"covered_pixels\":%llu,\"drawn_pixels\":%llu,\"overdraw\":%.3f,\"coalesce_us\":%.3f,\"draw_us\":%d}\n",
+			frameIndex, frame.m_time, frame.m_width, frame.m_height, (unsigned int)frame.m_rects.size(), (unsigned int)rects.size(),
+			frame.m_recordedRects, coveredPixels, drawnPixels, overdraw, frameTime * 1000.0, frame.m_drawTime);
+		Report(line);
+
+		totalTime += frameTime;
+		maxTime = max(maxTime, frameTime);
+		totalInputRects += frame.m_rects.size();
+		totalRects += rects.size();
+		totalCoveredPixels += coveredPixels;
+		totalDrawnPixels += drawnPixels;
+	}
+
+	unsigned int numFrames = max((unsigned int)frames.size(), 1u);
+
+	char line[512];
+	sprintf_s(line, "{\"summary\":true,\"frames\":%u,\"mean_coalesce_us\":%.3f,\"max_coalesce_us\":%.3f,\"mean_input_rects\":%.2f,"
+		"\"mean_rects\":%.2f,\"overdraw\":%.3f,\"mismatched_frames\":%u}\n",
+		(unsigned int)frames.size(), totalTime * 1000.0 / numFrames, maxTime * 1000.0, double(totalInputRects) / numFrames,
+		double(totalRects) / numFrames, totalCoveredPixels ? double(totalDrawnPixels) / double(totalCoveredPixels) : 1.0, numMismatches);
+	Report(line);
+
+	return true;
+}
+
+//---------------------------------------------------------------------
+int _tmain(int argc, _TCHAR* argv[])
+{
+	QueryPerformanceFrequency(&g_frequency);
+
+	if (argc < 2)
+	{
+		_ftprintf(stderr, _T("Usage: DirtyRectReplay trace [results.json]\n"));
+		return 1;
+	}
+
+	if (argc > 2 && _tfopen_s(&g_resultsFile, argv[2], _T("w")) != 0)
+	{
+		_ftprintf(stderr, _T("Can't open %s\n"), argv[2]);
+		return 1;
+	}
+
+	int result = 0;
+	if (!ReplayTrace(argv[1]))
+	{
+		_ftprintf(stderr, _T("Can't read trace %s\n"), argv[1]);
+		result = 1;
+	}
+
+	if (g_resultsFile)
+		fclose(g_resultsFile);
+
+	return result;
+}
@@ -0,0 +1,89 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+
+#include "targetver.h"
+
+#define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+
+// Windows Header Files:
+#include <windows.h>
+#include <assert.h>
+
+// C RunTime Header Files
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+#include <tchar.h>
+
+#include <string>
+#include <vector>
+
+#else
+
+// Other systems build the replay with the Makefile, Win32 bits it uses are emulated here
+#include "../../Source/Implementation/Portable.h"
+#include <assert.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#define min(a, b)				(((a) < (b)) ? (a) : (b))
+#define max(a, b)				(((a) > (b)) ? (a) : (b))
+#define __int64					long long
+#define sprintf_s(buffer, ...)	snprintf(buffer, sizeof(buffer), __VA_ARGS__)
+
+#define _tmain					main
+typedef char					_TCHAR;
+#define _T(text)				text
+#define _ftprintf				fprintf
+#define _tfopen_s(file, path, mode)	((*(file) = fopen(path, mode)) == NULL)
+
+union LARGE_INTEGER
+{
+	long long				QuadPart;
+};
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	counter->QuadPart = (long long)time.tv_sec * 1000000000 + time.tv_nsec;
+	return TRUE;
+}
+
+#endif
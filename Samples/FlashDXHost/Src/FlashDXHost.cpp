@@ -0,0 +1,55 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+// Host process for players created with IFlashDX::CreateRemotePlayer().
+// The client starts it with the command line passed to CreateRemotePlayer() and the channel name appended.
+//
+// Usage: FlashDXHost [-affinity mask] channel
+// -affinity keeps the host, Flash rendering included, on the cores of the hexadecimal mask.
+
+#include "stdafx.h"
+#include "../../../Include/IFlashDX.h"
+
+#pragma comment(lib, "FlashDX" CONFIGURATION_NAME "_" PLATFORM_NAME ".lib")
+
+//---------------------------------------------------------------------
+int _tmain(int argc, _TCHAR* argv[])
+{
+	if (argc < 2)
+	{
+		_ftprintf(stderr, _T("Usage: FlashDXHost [-affinity mask] channel\n"));
+		return 1;
+	}
+
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		if (_tcscmp(argv[i], _T("-affinity")) == 0 && i + 2 < argc)
+		{
+			DWORD_PTR mask = (DWORD_PTR)_tcstoui64(argv[++i], NULL, 16);
+			if (!SetProcessAffinityMask(GetCurrentProcess(), mask))
+				_ftprintf(stderr, _T("Can't set affinity mask %s\n"), argv[i]);
+		}
+	}
+
+	// Client gives up waiting for the player when the host exits early
+	return GetFlashToDirectXInstance()->RunRemoteHost(argv[argc - 1]) ? 0 : 1;
+}
@@ -99,6 +99,10 @@ int APIENTRY _tWinMain(HINSTANCE hInstance,
 		else
 		{
 			DrawFrame();
+
+			// Sleep until the movie changes (or its paced update is due) or new message arrives
+			HANDLE dirtyEvent = g_flashPlayer->GetDirtyEvent();
+			MsgWaitForMultipleObjects(1, &dirtyEvent, FALSE, g_flashPlayer->GetTimeToNextUpdate(), QS_ALLINPUT);
 		}
 	}
 
@@ -263,6 +267,8 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
 
 	g_flashPlayer->SetTransparencyMode(transparency_mode);
 	g_flashPlayer->SetBackgroundColor(RGB(0, 0, 0));
+	g_flashPlayer->SetFramePacing(60.0f, true);
+	g_flashPlayer->SetInputBuffering(true);
 
 	//---------------------------------------------------------------------
 	// Function call example
@@ -101,6 +101,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		else 
 		{
 			DrawFrame();
+
+			// Sleep until the movie changes (or its paced update is due) or new message arrives
+			HANDLE dirtyEvent = g_flashPlayer->GetDirtyEvent();
+			MsgWaitForMultipleObjects(1, &dirtyEvent, FALSE, g_flashPlayer->GetTimeToNextUpdate(), QS_ALLINPUT);
 		}
 	}
 
@@ -394,6 +398,8 @@ bool InitFlash()
 
 	g_flashPlayer->SetTransparencyMode(transparency_mode);
 	g_flashPlayer->SetBackgroundColor(RGB(0, 0, 0));
+	g_flashPlayer->SetFramePacing(60.0f, true);
+	g_flashPlayer->SetInputBuffering(true);
 
 	return true;
 }
@@ -0,0 +1,42 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "AlphaCombine.h"
+
+//---------------------------------------------------------------------
+void CombineAlpha(BYTE* black, unsigned int blackPitch, const BYTE* white, unsigned int whitePitch, const RECT& rect)
+{
+	for (LONG y = rect.top; y < rect.bottom; ++y)
+	{
+		int offset = y * blackPitch + rect.left * 4;
+		int whiteOffset = y * whitePitch + rect.left * 4;
+		for (LONG x = rect.left; x < rect.right; ++x)
+		{
+			BYTE blackRed = black[offset];
+			BYTE whiteRed = white[whiteOffset];
+			black[offset + 3] = 255 - (whiteRed - blackRed);
+			offset += 4;
+			whiteOffset += 4;
+		}
+	}
+}
@@ -0,0 +1,342 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "CallRecorder.h"
+
+//---------------------------------------------------------------------
+// Log header: 'FDXR' signature and format version.
+static const DWORD s_logSignature = 0x52584446;
+static const DWORD s_logVersion = 2;
+
+//---------------------------------------------------------------------
+// Recorder writes to the file when this much data is buffered.
+static const unsigned int s_flushSize = 64 * 1024;
+
+//---------------------------------------------------------------------
+static DWORD GetElapsedMs(const LARGE_INTEGER& startTime, const LARGE_INTEGER& frequency)
+{
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	return (DWORD)((time.QuadPart - startTime.QuadPart) * 1000 / frequency.QuadPart);
+}
+
+//---------------------------------------------------------------------
+CCallRecorder::CCallRecorder()
+{
+	m_file = INVALID_HANDLE_VALUE;
+	m_startTime.QuadPart = 0;
+	QueryPerformanceFrequency(&m_frequency);
+}
+
+//---------------------------------------------------------------------
+CCallRecorder::~CCallRecorder()
+{
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		Flush();
+		CloseHandle(m_file);
+	}
+}
+
+//---------------------------------------------------------------------
+bool CCallRecorder::Start(const wchar_t* path)
+{
+	m_file = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	Write(&s_logSignature, sizeof(s_logSignature));
+	Write(&s_logVersion, sizeof(s_logVersion));
+
+	QueryPerformanceCounter(&m_startTime);
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CCallRecorder::BeginCall(ERecordedCall call)
+{
+	if (m_buffer.size() >= s_flushSize)
+		Flush();
+
+	DWORD time = GetElapsedMs(m_startTime, m_frequency);
+	BYTE type = (BYTE)call;
+	Write(&time, sizeof(time));
+	Write(&type, sizeof(type));
+}
+
+//---------------------------------------------------------------------
+void CCallRecorder::WriteInt(int value)
+{
+	Write(&value, sizeof(value));
+}
+
+//---------------------------------------------------------------------
+void CCallRecorder::WriteDouble(double value)
+{
+	Write(&value, sizeof(value));
+}
+
+//---------------------------------------------------------------------
+void CCallRecorder::WriteString(const wchar_t* value)
+{
+	DWORD length = value != NULL ? (DWORD)wcslen(value) : 0xFFFFFFFF;
+
+	Write(&length, sizeof(length));
+	if (value != NULL)
+		Write(value, length * sizeof(wchar_t));
+}
+
+//---------------------------------------------------------------------
+void CCallRecorder::Write(const void* data, unsigned int size)
+{
+	m_buffer.insert(m_buffer.end(), (const BYTE*)data, (const BYTE*)data + size);
+}
+
+//---------------------------------------------------------------------
+void CCallRecorder::Flush()
+{
+	if (m_buffer.empty())
+		return;
+
+	DWORD written = 0;
+	WriteFile(m_file, &m_buffer[0], (DWORD)m_buffer.size(), &written, NULL);
+	m_buffer.clear();
+}
+
+//---------------------------------------------------------------------
+CCallReplayer::CCallReplayer()
+{
+	m_position = 0;
+	m_startTime.QuadPart = 0;
+	QueryPerformanceFrequency(&m_frequency);
+}
+
+//---------------------------------------------------------------------
+bool CCallReplayer::Start(const wchar_t* path)
+{
+	HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD size = GetFileSize(file, NULL);
+	m_log.resize(size);
+
+	DWORD read = 0;
+	bool result = size >= 2 * sizeof(DWORD) && ReadFile(file, &m_log[0], size, &read, NULL) && read == size;
+	CloseHandle(file);
+
+	if (!result || *(const DWORD*)&m_log[0] != s_logSignature || *(const DWORD*)&m_log[4] != s_logVersion)
+	{
+		m_log.clear();
+		return false;
+	}
+
+	m_position = 2 * sizeof(DWORD);
+	QueryPerformanceCounter(&m_startTime);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CCallReplayer::Update(IFlashDXPlayer* player)
+{
+	DWORD now = GetElapsedMs(m_startTime, m_frequency);
+
+	while (m_position + sizeof(DWORD) + 1 <= m_log.size())
+	{
+		DWORD time = *(const DWORD*)&m_log[m_position];
+		if (time > now)
+			return true;
+
+		BYTE call = m_log[m_position + sizeof(DWORD)];
+		m_position += sizeof(DWORD) + 1;
+
+		if (call >= CALL_COUNT || !ReplayCall(player, (ERecordedCall)call))
+			return false;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------
+unsigned int CCallReplayer::GetTimeToNextCall() const
+{
+	if (m_position + sizeof(DWORD) > m_log.size())
+		return 0;
+
+	DWORD time = *(const DWORD*)&m_log[m_position];
+	DWORD now = GetElapsedMs(m_startTime, m_frequency);
+	return time > now ? time - now : 0;
+}
+
+//---------------------------------------------------------------------
+bool CCallReplayer::ReadInt(int& value)
+{
+	if (m_position + sizeof(value) > m_log.size())
+		return false;
+
+	memcpy(&value, &m_log[m_position], sizeof(value));
+	m_position += sizeof(value);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CCallReplayer::ReadDouble(double& value)
+{
+	if (m_position + sizeof(value) > m_log.size())
+		return false;
+
+	memcpy(&value, &m_log[m_position], sizeof(value));
+	m_position += sizeof(value);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CCallReplayer::ReadString(std::wstring& value, bool& isNull)
+{
+	if (m_position + sizeof(DWORD) > m_log.size())
+		return false;
+
+	DWORD length = *(const DWORD*)&m_log[m_position];
+	m_position += sizeof(DWORD);
+
+	isNull = length == 0xFFFFFFFF;
+	if (isNull)
+		length = 0;
+
+	if (length > (m_log.size() - m_position) / sizeof(wchar_t))
+		return false;
+
+	value.assign((const wchar_t*)&m_log[m_position], length);
+	m_position += length * sizeof(wchar_t);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CCallReplayer::ReplayCall(IFlashDXPlayer* player, ERecordedCall call)
+{
+	int arg0 = 0, arg1 = 0, arg2 = 0, arg3 = 0;
+	double number = 0.0;
+	std::wstring string0, string1;
+	bool null0 = false, null1 = false;
+
+	switch (call)
+	{
+	case CALL_MOUSE_MOVE:
+		if (!ReadInt(arg0) || !ReadInt(arg1))
+			return false;
+		player->SetMousePos(arg0, arg1);
+		break;
+	case CALL_MOUSE_BUTTON:
+		if (!ReadInt(arg0) || !ReadInt(arg1) || !ReadInt(arg2) || !ReadInt(arg3))
+			return false;
+		player->SetMouseButtonState(arg0, arg1, (IFlashDXPlayer::EMouseButton)arg2, arg3 != 0);
+		break;
+	case CALL_MOUSE_WHEEL:
+		if (!ReadInt(arg0))
+			return false;
+		player->SendMouseWheel(arg0);
+		break;
+	case CALL_KEY:
+		if (!ReadInt(arg0) || !ReadInt(arg1) || !ReadInt(arg2))
+			return false;
+		player->SendKey(arg0 != 0, (UINT_PTR)arg1, (LONG_PTR)arg2);
+		break;
+	case CALL_CHAR:
+		if (!ReadInt(arg0) || !ReadInt(arg1))
+			return false;
+		player->SendChar((UINT_PTR)arg0, (LONG_PTR)arg1);
+		break;
+	case CALL_START_PLAYING:
+		if (!ReadString(string0, null0))
+			return false;
+		if (null0)
+			player->StartPlaying();
+		else
+			player->StartPlaying(string0.c_str());
+		break;
+	case CALL_STOP_PLAYING:
+		if (!ReadString(string0, null0))
+			return false;
+		if (null0)
+			player->StopPlaying();
+		else
+			player->StopPlaying(string0.c_str());
+		break;
+	case CALL_REWIND:
+		player->Rewind();
+		break;
+	case CALL_STEP_FORWARD:
+		player->StepForward();
+		break;
+	case CALL_STEP_BACK:
+		player->StepBack();
+		break;
+	case CALL_GOTO_FRAME:
+		if (!ReadInt(arg0) || !ReadString(string0, null0))
+			return false;
+		if (null0)
+			player->GotoFrame(arg0);
+		else
+			player->GotoFrame(arg0, string0.c_str());
+		break;
+	case CALL_CALL_FRAME:
+		if (!ReadInt(arg0) || !ReadString(string0, null0))
+			return false;
+		player->CallFrame(arg0, string0.c_str());
+		break;
+	case CALL_GOTO_LABEL:
+		if (!ReadString(string0, null0) || !ReadString(string1, null1))
+			return false;
+		player->GotoLabel(string0.c_str(), string1.c_str());
+		break;
+	case CALL_CALL_LABEL:
+		if (!ReadString(string0, null0) || !ReadString(string1, null1))
+			return false;
+		player->CallLabel(string0.c_str(), string1.c_str());
+		break;
+	case CALL_SET_VARIABLE:
+		if (!ReadString(string0, null0) || !ReadString(string1, null1))
+			return false;
+		player->SetVariable(string0.c_str(), string1.c_str());
+		break;
+	case CALL_SET_PROPERTY:
+		if (!ReadInt(arg0) || !ReadString(string0, null0) || !ReadString(string1, null1))
+			return false;
+		player->SetProperty(arg0, string0.c_str(), string1.c_str());
+		break;
+	case CALL_SET_PROPERTY_NUMBER:
+		if (!ReadInt(arg0) || !ReadDouble(number) || !ReadString(string1, null1))
+			return false;
+		player->SetProperty(arg0, number, string1.c_str());
+		break;
+	case CALL_CALL_FUNCTION:
+		if (!ReadString(string0, null0))
+			return false;
+		player->CallFunction(string0.c_str());
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
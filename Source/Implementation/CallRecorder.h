@@ -0,0 +1,130 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Recorded player calls. Values are stored in the log, don't reorder.
+//---------------------------------------------------------------------
+enum ERecordedCall
+{
+	CALL_MOUSE_MOVE = 0,		// x, y
+	CALL_MOUSE_BUTTON,			// x, y, button, pressed
+	CALL_MOUSE_WHEEL,			// delta
+	CALL_KEY,					// pressed, virtual key, extended
+	CALL_CHAR,					// character, extended
+	CALL_START_PLAYING,			// target
+	CALL_STOP_PLAYING,			// target
+	CALL_REWIND,
+	CALL_STEP_FORWARD,
+	CALL_STEP_BACK,
+	CALL_GOTO_FRAME,			// frame, target
+	CALL_CALL_FRAME,			// frame, target
+	CALL_GOTO_LABEL,			// label, target
+	CALL_CALL_LABEL,			// label, target
+	CALL_SET_VARIABLE,			// name, value
+	CALL_SET_PROPERTY,			// property, value, target
+	CALL_SET_PROPERTY_NUMBER,	// property, value, target
+	CALL_CALL_FUNCTION,			// request
+	CALL_COUNT
+};
+
+//---------------------------------------------------------------------
+/// Writes player calls with timestamps into a binary log.
+/// Record is a DWORD time in milliseconds since start, a BYTE call type and call arguments.
+/// Integers are 32 bit, strings are DWORD length (0xFFFFFFFF for NULL) followed by UTF-16 characters.
+//---------------------------------------------------------------------
+class CCallRecorder
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CCallRecorder();
+
+	//---------------------------------------------------------------------
+	/// Destructor. Writes the rest of the log.
+	~CCallRecorder();
+
+	//---------------------------------------------------------------------
+	/// Creates the log file and starts the clock.
+	bool Start(const wchar_t* path);
+
+	//---------------------------------------------------------------------
+	/// Starts new record. Arguments are written right after.
+	void BeginCall(ERecordedCall call);
+
+	//---------------------------------------------------------------------
+	/// Writes call arguments.
+	void WriteInt(int value);
+	void WriteDouble(double value);
+	void WriteString(const wchar_t* value);
+
+protected:
+	//---------------------------------------------------------------------
+	void Write(const void* data, unsigned int size);
+	void Flush();
+
+protected:
+	HANDLE					m_file;
+	std::vector<BYTE>		m_buffer;
+	LARGE_INTEGER			m_startTime;
+	LARGE_INTEGER			m_frequency;
+};
+
+//---------------------------------------------------------------------
+/// Plays calls from log written by CCallRecorder into a player, keeping recorded timing.
+//---------------------------------------------------------------------
+class CCallReplayer
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CCallReplayer();
+
+	//---------------------------------------------------------------------
+	/// Reads the log and starts the clock.
+	bool Start(const wchar_t* path);
+
+	//---------------------------------------------------------------------
+	/// Makes all calls that are due. Returns false when the log is over or broken.
+	bool Update(IFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	/// Returns time in milliseconds until the next call is due.
+	unsigned int GetTimeToNextCall() const;
+
+protected:
+	//---------------------------------------------------------------------
+	bool ReadInt(int& value);
+	bool ReadDouble(double& value);
+	bool ReadString(std::wstring& value, bool& isNull);
+	//---------------------------------------------------------------------
+	bool ReplayCall(IFlashDXPlayer* player, ERecordedCall call);
+
+protected:
+	std::vector<BYTE>		m_log;
+	unsigned int			m_position;
+	LARGE_INTEGER			m_startTime;
+	LARGE_INTEGER			m_frequency;
+};
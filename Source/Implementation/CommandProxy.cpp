@@ -0,0 +1,272 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "CommandProxy.h"
+
+//---------------------------------------------------------------------
+CFlashDXFuture::CFlashDXFuture()
+{
+	m_refs = 2;
+	m_ready = 0;
+	m_hasResult = false;
+	m_readyEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+}
+
+//---------------------------------------------------------------------
+CFlashDXFuture::~CFlashDXFuture()
+{
+	CloseHandle(m_readyEvent);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXFuture::Complete(const wchar_t* result)
+{
+	if (result)
+	{
+		m_result = result;
+		m_hasResult = true;
+	}
+
+	InterlockedExchange(&m_ready, 1);
+	SetEvent(m_readyEvent);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXFuture::IsReady() const
+{
+	return m_ready != 0;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXFuture::Wait(unsigned int timeout)
+{
+	if (m_ready)
+		return true;
+
+	return WaitForSingleObject(m_readyEvent, timeout) == WAIT_OBJECT_0;
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CFlashDXFuture::GetResult() const
+{
+	if (!m_ready || !m_hasResult)
+		return NULL;
+
+	return m_result.c_str();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXFuture::Release()
+{
+	if (InterlockedDecrement(&m_refs) == 0)
+		delete this;
+}
+
+//---------------------------------------------------------------------
+CCommandProxy::CCommandProxy()
+{
+	for (LONG i = 0; i < CAPACITY; ++i)
+		m_slots[i].m_sequence = i;
+
+	m_tail = 0;
+	m_head = 0;
+}
+
+//---------------------------------------------------------------------
+CCommandProxy::~CCommandProxy()
+{
+	Discard();
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::Push(ECommand type, int frame, const wchar_t* arg0, const wchar_t* arg1, CFlashDXFuture* future)
+{
+	LONG position = m_tail;
+	SSlot* slot;
+
+	for (;;)
+	{
+		slot = &m_slots[position & (CAPACITY - 1)];
+		LONG difference = slot->m_sequence - position;
+
+		if (difference == 0)
+		{
+			// Slot is free, try to claim it
+			LONG previous = InterlockedCompareExchange(&m_tail, position + 1, position);
+			if (previous == position)
+				break;
+			position = previous;
+		}
+		else if (difference < 0)
+		{
+			// Consumer didn't free the slot yet, queue is full
+			return false;
+		}
+		else
+		{
+			position = m_tail;
+		}
+	}
+
+	slot->m_command.m_type = type;
+	slot->m_command.m_frame = frame;
+	slot->m_command.m_arg0 = arg0 ? arg0 : L"";
+	slot->m_command.m_arg1 = arg1 ? arg1 : L"";
+	slot->m_command.m_future = future;
+
+	// Command must be visible before the consumer sees the slot filled
+	MemoryBarrier();
+	slot->m_sequence = position + 1;
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::Pop(SCommand& command)
+{
+	SSlot* slot = &m_slots[m_head & (CAPACITY - 1)];
+	if (slot->m_sequence != m_head + 1)
+		return false;
+
+	MemoryBarrier();
+	command.m_type = slot->m_command.m_type;
+	command.m_frame = slot->m_command.m_frame;
+	command.m_arg0.swap(slot->m_command.m_arg0);
+	command.m_arg1.swap(slot->m_command.m_arg1);
+	command.m_future = slot->m_command.m_future;
+
+	// Command must be taken before producers may refill the slot
+	MemoryBarrier();
+	slot->m_sequence = m_head + CAPACITY;
+	++m_head;
+	return true;
+}
+
+//---------------------------------------------------------------------
+IFlashDXFuture* CCommandProxy::PushWithFuture(ECommand type, const wchar_t* arg0)
+{
+	CFlashDXFuture* future = new CFlashDXFuture();
+	if (!Push(type, 0, arg0, NULL, future))
+	{
+		future->Release();
+		future->Release();
+		return NULL;
+	}
+	return future;
+}
+
+//---------------------------------------------------------------------
+void CCommandProxy::Execute(IFlashDXPlayer* player)
+{
+	SCommand command;
+	while (Pop(command))
+	{
+		const wchar_t* result = NULL;
+
+		switch (command.m_type)
+		{
+		case COMMAND_SET_VARIABLE:
+			player->SetVariable(command.m_arg0.c_str(), command.m_arg1.c_str());
+			break;
+		case COMMAND_GET_VARIABLE:
+			result = player->GetVariable(command.m_arg0.c_str());
+			break;
+		case COMMAND_GOTO_FRAME:
+			player->GotoFrame(command.m_frame, command.m_arg0.c_str());
+			break;
+		case COMMAND_GOTO_LABEL:
+			player->GotoLabel(command.m_arg0.c_str(), command.m_arg1.c_str());
+			break;
+		case COMMAND_START_PLAYING:
+			player->StartPlaying(command.m_arg0.c_str());
+			break;
+		case COMMAND_STOP_PLAYING:
+			player->StopPlaying(command.m_arg0.c_str());
+			break;
+		case COMMAND_CALL_FUNCTION:
+			result = player->CallFunction(command.m_arg0.c_str());
+			break;
+		}
+
+		if (command.m_future)
+		{
+			command.m_future->Complete(result);
+			command.m_future->Release();
+		}
+	}
+}
+
+//---------------------------------------------------------------------
+void CCommandProxy::Discard()
+{
+	SCommand command;
+	while (Pop(command))
+	{
+		if (command.m_future)
+		{
+			command.m_future->Complete(NULL);
+			command.m_future->Release();
+		}
+	}
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::SetVariable(const wchar_t* name, const wchar_t* value)
+{
+	return Push(COMMAND_SET_VARIABLE, 0, name, value, NULL);
+}
+
+//---------------------------------------------------------------------
+IFlashDXFuture* CCommandProxy::GetVariable(const wchar_t* name)
+{
+	return PushWithFuture(COMMAND_GET_VARIABLE, name);
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::GotoFrame(int frame, const wchar_t* timelineTarget /*= L"/"*/)
+{
+	return Push(COMMAND_GOTO_FRAME, frame, timelineTarget, NULL, NULL);
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::GotoLabel(const wchar_t* label, const wchar_t* timelineTarget /*= L"/"*/)
+{
+	return Push(COMMAND_GOTO_LABEL, 0, label, timelineTarget, NULL);
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::StartPlaying(const wchar_t* timelineTarget /*= L"/"*/)
+{
+	return Push(COMMAND_START_PLAYING, 0, timelineTarget, NULL, NULL);
+}
+
+//---------------------------------------------------------------------
+bool CCommandProxy::StopPlaying(const wchar_t* timelineTarget /*= L"/"*/)
+{
+	return Push(COMMAND_STOP_PLAYING, 0, timelineTarget, NULL, NULL);
+}
+
+//---------------------------------------------------------------------
+IFlashDXFuture* CCommandProxy::CallFunction(const wchar_t* request)
+{
+	return PushWithFuture(COMMAND_CALL_FUNCTION, request);
+}
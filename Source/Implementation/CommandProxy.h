@@ -0,0 +1,137 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Future completed by CCommandProxy on the player owner thread.
+//---------------------------------------------------------------------
+class CFlashDXFuture : public IFlashDXFuture
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor. Future is referenced by the caller and by the queued command.
+	CFlashDXFuture();
+
+	//---------------------------------------------------------------------
+	/// Stores the result and wakes up waiting threads. NULL result means failure.
+	void Complete(const wchar_t* result);
+
+	//---------------------------------------------------------------------
+	// IFlashDXFuture implementations.
+	//---------------------------------------------------------------------
+	virtual bool IsReady() const;
+	virtual bool Wait(unsigned int timeout);
+	virtual const wchar_t* GetResult() const;
+	virtual void Release();
+
+protected:
+	//---------------------------------------------------------------------
+	~CFlashDXFuture();
+
+protected:
+	volatile LONG			m_refs;
+	volatile LONG			m_ready;
+	HANDLE					m_readyEvent;
+	bool					m_hasResult;
+	std::wstring			m_result;
+};
+
+//---------------------------------------------------------------------
+/// Implementation of IFlashDXPlayerProxy. Commands are kept in bounded lock-free
+/// multiple producers, single consumer ring.
+//---------------------------------------------------------------------
+class CCommandProxy : public IFlashDXPlayerProxy
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CCommandProxy();
+
+	//---------------------------------------------------------------------
+	/// Destructor. Pending commands are discarded.
+	~CCommandProxy();
+
+	//---------------------------------------------------------------------
+	/// Executes queued commands. Called on the player owner thread only.
+	void Execute(IFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	/// Discards queued commands, their futures are completed with no result.
+	void Discard();
+
+	//---------------------------------------------------------------------
+	// IFlashDXPlayerProxy implementations.
+	//---------------------------------------------------------------------
+	virtual bool SetVariable(const wchar_t* name, const wchar_t* value);
+	virtual IFlashDXFuture* GetVariable(const wchar_t* name);
+	virtual bool GotoFrame(int frame, const wchar_t* timelineTarget = L"/");
+	virtual bool GotoLabel(const wchar_t* label, const wchar_t* timelineTarget = L"/");
+	virtual bool StartPlaying(const wchar_t* timelineTarget = L"/");
+	virtual bool StopPlaying(const wchar_t* timelineTarget = L"/");
+	virtual IFlashDXFuture* CallFunction(const wchar_t* request);
+
+protected:
+	//---------------------------------------------------------------------
+	enum ECommand
+	{
+		COMMAND_SET_VARIABLE = 0,
+		COMMAND_GET_VARIABLE,
+		COMMAND_GOTO_FRAME,
+		COMMAND_GOTO_LABEL,
+		COMMAND_START_PLAYING,
+		COMMAND_STOP_PLAYING,
+		COMMAND_CALL_FUNCTION
+	};
+
+	//---------------------------------------------------------------------
+	struct SCommand
+	{
+		ECommand				m_type;
+		int						m_frame;
+		std::wstring			m_arg0;
+		std::wstring			m_arg1;
+		CFlashDXFuture*			m_future;
+	};
+
+	//---------------------------------------------------------------------
+	struct SSlot
+	{
+		volatile LONG			m_sequence;			// slot is free when equal to position, filled when equal to position + 1
+		SCommand				m_command;
+	};
+
+	enum { CAPACITY = 256 };			// power of two
+
+	//---------------------------------------------------------------------
+	bool Push(ECommand type, int frame, const wchar_t* arg0, const wchar_t* arg1, CFlashDXFuture* future);
+	bool Pop(SCommand& command);
+	//---------------------------------------------------------------------
+	IFlashDXFuture* PushWithFuture(ECommand type, const wchar_t* arg0);
+
+protected:
+	SSlot					m_slots[CAPACITY];
+	volatile LONG			m_tail;				// next position to fill, shared by producers
+	LONG					m_head;				// next position to execute, owned by consumer
+};
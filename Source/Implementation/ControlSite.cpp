@@ -186,7 +186,7 @@ HRESULT STDMETHODCALLTYPE CControlSite::GetWindowContext(/* [out] */ IOleInPlace
 	RECT rect = { 0, 0, m_flashPlayer->m_width, m_flashPlayer->m_height };
 
 	*lprcPosRect = rect;
-	*lprcClipRect = rect;
+	*lprcClipRect = m_flashPlayer->m_visibleRect;
 
 	*ppFrame = NULL;
 	QueryInterface(__uuidof(IOleInPlaceFrame), (void**) ppFrame);		
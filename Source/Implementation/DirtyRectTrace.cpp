@@ -0,0 +1,226 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "DirtyRectTrace.h"
+
+//---------------------------------------------------------------------
+// Trace header: 'FDXT' signature and format version.
+static const DWORD s_traceSignature = 0x54584446;
+static const DWORD s_traceVersion = 1;
+
+//---------------------------------------------------------------------
+// Writer flushes to the file when this much data is buffered.
+static const unsigned int s_flushSize = 64 * 1024;
+
+//---------------------------------------------------------------------
+// Number of arguments of each record type.
+static const unsigned int s_numRecordArgs[DIRTY_RECORD_COUNT] = { 2, 4, 4, 1, 1 };
+
+#ifdef _WIN32
+//---------------------------------------------------------------------
+CDirtyRectTraceWriter::CDirtyRectTraceWriter()
+{
+	m_file = INVALID_HANDLE_VALUE;
+	m_startTime.QuadPart = 0;
+	QueryPerformanceFrequency(&m_frequency);
+}
+
+//---------------------------------------------------------------------
+CDirtyRectTraceWriter::~CDirtyRectTraceWriter()
+{
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		Flush();
+		CloseHandle(m_file);
+	}
+}
+
+//---------------------------------------------------------------------
+bool CDirtyRectTraceWriter::Start(const wchar_t* path)
+{
+	m_file = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_buffer.insert(m_buffer.end(), (const BYTE*)&s_traceSignature, (const BYTE*)&s_traceSignature + sizeof(DWORD));
+	m_buffer.insert(m_buffer.end(), (const BYTE*)&s_traceVersion, (const BYTE*)&s_traceVersion + sizeof(DWORD));
+
+	QueryPerformanceCounter(&m_startTime);
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CDirtyRectTraceWriter::AddSurface(unsigned int width, unsigned int height)
+{
+	int args[] = { (int)width, (int)height };
+	AddRecord(DIRTY_SURFACE, args, 2);
+}
+
+//---------------------------------------------------------------------
+void CDirtyRectTraceWriter::AddRect(const RECT& rect, bool replace)
+{
+	int args[] = { rect.left, rect.top, rect.right, rect.bottom };
+	AddRecord(replace ? DIRTY_SET : DIRTY_ADD, args, 4);
+}
+
+//---------------------------------------------------------------------
+void CDirtyRectTraceWriter::AddUpdate(unsigned int numRects)
+{
+	int args[] = { (int)numRects };
+	AddRecord(DIRTY_UPDATE, args, 1);
+}
+
+//---------------------------------------------------------------------
+void CDirtyRectTraceWriter::AddDraw(float drawTime)
+{
+	int args[] = { (int)(drawTime * 1000.0f) };
+	AddRecord(DIRTY_DRAW, args, 1);
+}
+
+//---------------------------------------------------------------------
+void CDirtyRectTraceWriter::AddRecord(EDirtyRectRecord type, const int* args, unsigned int numArgs)
+{
+	if (m_buffer.size() >= s_flushSize)
+		Flush();
+
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	DWORD elapsed = (DWORD)((time.QuadPart - m_startTime.QuadPart) * 1000 / m_frequency.QuadPart);
+	BYTE recordType = (BYTE)type;
+
+	m_buffer.insert(m_buffer.end(), (const BYTE*)&elapsed, (const BYTE*)&elapsed + sizeof(elapsed));
+	m_buffer.push_back(recordType);
+	m_buffer.insert(m_buffer.end(), (const BYTE*)args, (const BYTE*)(args + numArgs));
+}
+
+//---------------------------------------------------------------------
+void CDirtyRectTraceWriter::Flush()
+{
+	if (m_buffer.empty())
+		return;
+
+	DWORD written = 0;
+	WriteFile(m_file, &m_buffer[0], (DWORD)m_buffer.size(), &written, NULL);
+	m_buffer.clear();
+}
+#endif
+
+//---------------------------------------------------------------------
+CDirtyRectTraceReader::CDirtyRectTraceReader()
+{
+	m_position = 0;
+}
+
+#ifdef _WIN32
+//---------------------------------------------------------------------
+bool CDirtyRectTraceReader::Open(const wchar_t* path)
+{
+	m_trace.clear();
+	m_position = 0;
+
+	HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD size = GetFileSize(file, NULL);
+	m_trace.resize(size);
+
+	DWORD read = 0;
+	bool result = size >= 2 * sizeof(DWORD) && ReadFile(file, &m_trace[0], size, &read, NULL) && read == size;
+	CloseHandle(file);
+
+	if (!result)
+	{
+		m_trace.clear();
+		return false;
+	}
+	return CheckHeader();
+}
+#else
+//---------------------------------------------------------------------
+bool CDirtyRectTraceReader::Open(const char* path)
+{
+	m_trace.clear();
+	m_position = 0;
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	bool result = size >= long(2 * sizeof(DWORD));
+	if (result)
+	{
+		m_trace.resize(size);
+		result = fread(&m_trace[0], 1, size, file) == size_t(size);
+	}
+	fclose(file);
+
+	if (!result)
+	{
+		m_trace.clear();
+		return false;
+	}
+	return CheckHeader();
+}
+#endif
+
+//---------------------------------------------------------------------
+bool CDirtyRectTraceReader::CheckHeader()
+{
+	if (m_trace.size() < 2 * sizeof(DWORD) ||
+		*(const DWORD*)&m_trace[0] != s_traceSignature || *(const DWORD*)&m_trace[4] != s_traceVersion)
+	{
+		m_trace.clear();
+		return false;
+	}
+
+	m_position = 2 * sizeof(DWORD);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CDirtyRectTraceReader::Read(SDirtyRectRecord& record)
+{
+	if (m_position + sizeof(DWORD) + 1 > m_trace.size())
+		return false;
+
+	BYTE type = m_trace[m_position + sizeof(DWORD)];
+	if (type >= DIRTY_RECORD_COUNT)
+		return false;
+
+	unsigned int argsSize = s_numRecordArgs[type] * sizeof(int);
+	if (m_position + sizeof(DWORD) + 1 + argsSize > m_trace.size())
+		return false;
+
+	memset(&record, 0, sizeof(record));
+	memcpy(&record.m_time, &m_trace[m_position], sizeof(DWORD));
+	record.m_type = (EDirtyRectRecord)type;
+	memcpy(record.m_args, &m_trace[m_position + sizeof(DWORD) + 1], argsSize);
+
+	m_position += sizeof(DWORD) + 1 + argsSize;
+	return true;
+}
@@ -0,0 +1,119 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "Portable.h"
+
+//---------------------------------------------------------------------
+/// Dirty rect trace records. Values are stored in the trace, don't reorder.
+//---------------------------------------------------------------------
+enum EDirtyRectRecord
+{
+	DIRTY_SURFACE = 0,			// width, height
+	DIRTY_SET,					// left, top, right, bottom; replaces all dirty rects
+	DIRTY_ADD,					// left, top, right, bottom
+	DIRTY_UPDATE,				// number of rects after coalescing; IsNeedUpdate() reported the player dirty
+	DIRTY_DRAW,					// DrawFrame() time in microseconds; dirty rects are cleared
+	DIRTY_RECORD_COUNT
+};
+
+//---------------------------------------------------------------------
+/// Trace record. Time is in milliseconds since the trace start.
+//---------------------------------------------------------------------
+struct SDirtyRectRecord
+{
+	DWORD					m_time;
+	EDirtyRectRecord		m_type;
+	int						m_args[4];
+};
+
+#ifdef _WIN32
+//---------------------------------------------------------------------
+/// Writes rects reaching the dirty rect list of a player and frame boundaries into a binary trace.
+/// Trace is 'FDXT' signature and version followed by records of DWORD time, BYTE type and 32 bit arguments.
+//---------------------------------------------------------------------
+class CDirtyRectTraceWriter
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CDirtyRectTraceWriter();
+
+	//---------------------------------------------------------------------
+	/// Destructor. Writes the rest of the trace.
+	~CDirtyRectTraceWriter();
+
+	//---------------------------------------------------------------------
+	/// Creates the trace file and starts the clock.
+	bool Start(const wchar_t* path);
+
+	//---------------------------------------------------------------------
+	/// Adds record.
+	void AddSurface(unsigned int width, unsigned int height);
+	void AddRect(const RECT& rect, bool replace);
+	void AddUpdate(unsigned int numRects);
+	void AddDraw(float drawTime);
+
+protected:
+	//---------------------------------------------------------------------
+	void AddRecord(EDirtyRectRecord type, const int* args, unsigned int numArgs);
+	void Flush();
+
+protected:
+	HANDLE					m_file;
+	std::vector<BYTE>		m_buffer;
+	LARGE_INTEGER			m_startTime;
+	LARGE_INTEGER			m_frequency;
+};
+#endif
+
+//---------------------------------------------------------------------
+/// Reads trace written by CDirtyRectTraceWriter. Builds on other systems too, for offline replay tools.
+//---------------------------------------------------------------------
+class CDirtyRectTraceReader
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CDirtyRectTraceReader();
+
+	//---------------------------------------------------------------------
+	/// Loads trace file. Paths are narrow strings on other systems.
+#ifdef _WIN32
+	bool Open(const wchar_t* path);
+#else
+	bool Open(const char* path);
+#endif
+
+	//---------------------------------------------------------------------
+	/// Reads the next record. Returns false at the end of the trace or if it is broken.
+	bool Read(SDirtyRectRecord& record);
+
+protected:
+	//---------------------------------------------------------------------
+	bool CheckHeader();
+
+protected:
+	std::vector<BYTE>		m_trace;
+	unsigned int			m_position;
+};
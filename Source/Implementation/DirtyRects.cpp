@@ -0,0 +1,134 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "DirtyRects.h"
+
+//---------------------------------------------------------------------
+// Largest 32 bit LONG. LONG_MAX is wider where long is 64 bit, e.g. with the portable RECT.
+static const LONG s_maxCoordinate = 0x7FFFFFFF;
+
+//---------------------------------------------------------------------
+CDirtyRects::CDirtyRects()
+{
+	Clear();
+}
+
+//---------------------------------------------------------------------
+void CDirtyRects::Clear()
+{
+	m_rects.clear();
+	m_unionRect.left = m_unionRect.top = s_maxCoordinate;
+	m_unionRect.right = m_unionRect.bottom = -s_maxCoordinate;
+}
+
+//---------------------------------------------------------------------
+void CDirtyRects::Set(const RECT& rect)
+{
+	m_unionRect = rect;
+	m_rects.clear();
+	m_rects.push_back(rect);
+}
+
+//---------------------------------------------------------------------
+void CDirtyRects::Add(const RECT& newRect, LONG width, LONG height)
+{
+	#define MIN_MACRO(x, y) ((x) < (y) ? (x) : (y))
+	#define MAX_MACRO(x, y) ((x) > (y) ? (x) : (y))
+
+	for (std::vector<RECT>::iterator it = m_rects.begin(); it != m_rects.end(); ++it)
+		if (it->left <= newRect.left && it->top <= newRect.top &&
+			it->right >= newRect.right && it->bottom >= newRect.bottom)
+		{
+			return; // already included
+		}
+
+	RECT rect = { newRect.left, newRect.top, newRect.right, newRect.bottom };
+	rect.left = MAX_MACRO(rect.left, 0);
+	rect.top = MAX_MACRO(rect.top, 0);
+	rect.right = MIN_MACRO(rect.right, width);
+	rect.bottom = MIN_MACRO(rect.bottom, height);
+
+	m_unionRect.left = MIN_MACRO(m_unionRect.left, newRect.left);
+	m_unionRect.top = MIN_MACRO(m_unionRect.top, newRect.top);
+	m_unionRect.right = MAX_MACRO(m_unionRect.right, newRect.right);
+	m_unionRect.bottom = MAX_MACRO(m_unionRect.bottom, newRect.bottom);
+
+	m_rects.push_back(rect);
+
+	#undef MIN_MACRO
+	#undef MAX_MACRO
+}
+
+//---------------------------------------------------------------------
+void CDirtyRects::Reduce()
+{
+	while (ReduceOnce());
+}
+
+//---------------------------------------------------------------------
+bool CDirtyRects::ReduceOnce()
+{
+	for (std::vector<RECT>::iterator firstIt = m_rects.begin(); firstIt != m_rects.end(); ++firstIt)
+	{
+		for (std::vector<RECT>::iterator secondIt = m_rects.begin(); secondIt != m_rects.end(); ++secondIt)
+		{
+			if (firstIt == secondIt)
+				continue;
+
+			RECT unionRect;
+			if (UnionRect(&unionRect, &(*firstIt), &(*secondIt)))
+			{
+				if (EqualRect(&unionRect, &(*firstIt)))
+				{
+					m_rects.erase(secondIt);
+					return true;
+				}
+				if (EqualRect(&unionRect, &(*secondIt)))
+				{
+					m_rects.erase(firstIt);
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------
+const std::vector<RECT>& CDirtyRects::GetRects() const
+{
+	return m_rects;
+}
+
+//---------------------------------------------------------------------
+const RECT& CDirtyRects::GetUnionRect() const
+{
+	return m_unionRect;
+}
+
+//---------------------------------------------------------------------
+unsigned int CDirtyRects::GetMemoryUsage() const
+{
+	return (unsigned int)(m_rects.capacity() * sizeof(RECT));
+}
@@ -0,0 +1,69 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "Portable.h"
+
+//---------------------------------------------------------------------
+/// Rects invalidated since the last draw. Rects covered by other rects are dropped to keep the list short.
+//---------------------------------------------------------------------
+class CDirtyRects
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CDirtyRects();
+
+	//---------------------------------------------------------------------
+	/// Removes all rects.
+	void Clear();
+
+	//---------------------------------------------------------------------
+	/// Replaces all rects with one.
+	void Set(const RECT& rect);
+
+	//---------------------------------------------------------------------
+	/// Adds rect clamped to the surface, unless one of the rects already covers it.
+	void Add(const RECT& rect, LONG width, LONG height);
+
+	//---------------------------------------------------------------------
+	/// Drops rects covered by other rects.
+	void Reduce();
+
+	//---------------------------------------------------------------------
+	/// Returns rects and their bounding rect.
+	const std::vector<RECT>& GetRects() const;
+	const RECT& GetUnionRect() const;
+
+	//---------------------------------------------------------------------
+	/// Returns bytes allocated for rects.
+	unsigned int GetMemoryUsage() const;
+
+protected:
+	//---------------------------------------------------------------------
+	bool ReduceOnce();
+
+protected:
+	std::vector<RECT>		m_rects;
+	RECT					m_unionRect;
+};
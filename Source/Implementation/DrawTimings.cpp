@@ -0,0 +1,99 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "DrawTimings.h"
+#include <algorithm>
+
+//---------------------------------------------------------------------
+CDrawTimings::CDrawTimings()
+{
+	Reset();
+}
+
+//---------------------------------------------------------------------
+void CDrawTimings::AddStageTime(IFlashDXPlayer::EDrawStage stage, double time)
+{
+	m_frameTimes[stage] += time;
+	m_frameStages[stage] = true;
+}
+
+//---------------------------------------------------------------------
+void CDrawTimings::EndFrame(double totalTime)
+{
+	AddStageTime(IFlashDXPlayer::DRAW_STAGE_TOTAL, totalTime);
+
+	for (unsigned int i = 0; i < IFlashDXPlayer::DRAW_STAGE_COUNT; ++i)
+	{
+		if (m_frameStages[i])
+			AddSample(m_stages[i], (float)m_frameTimes[i]);
+
+		m_frameTimes[i] = 0.0;
+		m_frameStages[i] = false;
+	}
+}
+
+//---------------------------------------------------------------------
+void CDrawTimings::AddSample(SStageSamples& stage, float time)
+{
+	stage.m_samples[stage.m_next] = time;
+	stage.m_next = (stage.m_next + 1) % s_numSamples;
+	if (stage.m_numSamples < s_numSamples)
+		++stage.m_numSamples;
+}
+
+//---------------------------------------------------------------------
+void CDrawTimings::GetStats(IFlashDXPlayer::SDrawTimings& timings) const
+{
+	memset(&timings, 0, sizeof(timings));
+
+	for (unsigned int i = 0; i < IFlashDXPlayer::DRAW_STAGE_COUNT; ++i)
+	{
+		const SStageSamples& stage = m_stages[i];
+		IFlashDXPlayer::SDrawStageStats& stats = timings.m_stages[i];
+
+		stats.m_numSamples = stage.m_numSamples;
+		if (stage.m_numSamples == 0)
+			continue;
+
+		float sorted[s_numSamples];
+		memcpy(sorted, stage.m_samples, stage.m_numSamples * sizeof(float));
+		std::sort(sorted, sorted + stage.m_numSamples);
+
+		double sum = 0.0;
+		for (unsigned int j = 0; j < stage.m_numSamples; ++j)
+			sum += sorted[j];
+
+		stats.m_min = sorted[0];
+		stats.m_mean = (float)(sum / stage.m_numSamples);
+		stats.m_p95 = sorted[(stage.m_numSamples * 95 - 1) / 100];
+		stats.m_max = sorted[stage.m_numSamples - 1];
+	}
+}
+
+//---------------------------------------------------------------------
+void CDrawTimings::Reset()
+{
+	memset(m_stages, 0, sizeof(m_stages));
+	memset(m_frameTimes, 0, sizeof(m_frameTimes));
+	memset(m_frameStages, 0, sizeof(m_frameStages));
+}
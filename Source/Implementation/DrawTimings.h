@@ -0,0 +1,70 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Rolling per-stage statistics of DrawFrame() time.
+/// Stage times are accumulated during a frame and become one sample per stage when the frame ends.
+//---------------------------------------------------------------------
+class CDrawTimings
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CDrawTimings();
+
+	//---------------------------------------------------------------------
+	/// Adds time spent in a stage of the current frame.
+	void AddStageTime(IFlashDXPlayer::EDrawStage stage, double time);
+
+	//---------------------------------------------------------------------
+	/// Ends the frame. Stages that took no time in it are not sampled.
+	void EndFrame(double totalTime);
+
+	//---------------------------------------------------------------------
+	/// Returns or resets statistics.
+	void GetStats(IFlashDXPlayer::SDrawTimings& timings) const;
+	void Reset();
+
+protected:
+	//---------------------------------------------------------------------
+	// Number of latest samples statistics are calculated from.
+	static const unsigned int s_numSamples = 128;
+
+	struct SStageSamples
+	{
+		float			m_samples[s_numSamples];
+		unsigned int	m_numSamples;		// valid samples, up to s_numSamples
+		unsigned int	m_next;				// ring position of the next sample
+	};
+
+	//---------------------------------------------------------------------
+	void AddSample(SStageSamples& stage, float time);
+
+protected:
+	SStageSamples			m_stages[IFlashDXPlayer::DRAW_STAGE_COUNT];
+	double					m_frameTimes[IFlashDXPlayer::DRAW_STAGE_COUNT];
+	bool					m_frameStages[IFlashDXPlayer::DRAW_STAGE_COUNT];
+};
@@ -23,6 +23,12 @@
 #include "stdafx.h"
 #include "FlashDX.h"
 #include "FlashDXPlayer.h"
+#include "SWFData.h"
+#include "SWFAnalyzer.h"
+#include "RenderWorker.h"
+#include "RemotePlayer.h"
+#include "RemoteHost.h"
+#include <algorithm>
 
 #pragma comment(lib, "comsuppw.lib")
 using namespace ShockwaveFlashObjects;
@@ -30,6 +36,10 @@ using namespace ShockwaveFlashObjects;
 //---------------------------------------------------------------------
 CFlashDX g_instance;
 
+//---------------------------------------------------------------------
+// Number of DrawAll() calls a non-critical player can be postponed for in a row.
+static const unsigned int s_maxPostponedUpdates = 8;
+
 //---------------------------------------------------------------------
 IFlashDX* GetFlashToDirectXInstance()
 {
@@ -41,11 +51,30 @@ CFlashDX::CFlashDX()
 {
 	CoInitialize(NULL);
 	m_flashLibHandle = LoadLibrary(L"flash10c.ocx");
+
+	memset(&m_poolStats, 0, sizeof(m_poolStats));
+	m_nextWorker = 0;
+	m_frameBudget = 0.0f;
 }
 
 //---------------------------------------------------------------------
 CFlashDX::~CFlashDX()
 {
+	SetPlayerPoolSize(0, 0, 0);
+
+	while (!m_remotePlayers.empty())
+		DestroyPlayer(m_remotePlayers.back());
+
+	// Players owned by workers have to go before the workers
+	for (size_t i = 0; i < m_livePlayers.size(); )
+	{
+		if (m_livePlayers[i]->m_worker != NULL)
+			DestroyPlayer(m_livePlayers[i]);
+		else
+			++i;
+	}
+	SetNumRenderThreads(0);
+
 	FreeLibrary(m_flashLibHandle);	
 	CoUninitialize();
 }
@@ -72,29 +101,661 @@ double CFlashDX::GetFlashVersion()
 //---------------------------------------------------------------------
 struct IFlashDXPlayer* CFlashDX::CreatePlayer(unsigned int width, unsigned int height)
 {
-	CFlashDXPlayer* player = new CFlashDXPlayer(m_flashLibHandle, width, height);
-	if (player->m_flashInterface == NULL)
+	CFlashDXPlayer* player = CreatePlayerInstance(width, height);
+	if (player != NULL)
+		AddLivePlayer(player);
+	return player;
+}
+
+//---------------------------------------------------------------------
+struct SCreatePlayerTask
+{
+	CFlashDX*				m_owner;
+	HMODULE					m_flashLibHandle;
+	unsigned int			m_width;
+	unsigned int			m_height;
+	CRenderWorker*			m_worker;
+	CFlashDXPlayer*			m_player;
+
+	//---------------------------------------------------------------------
+	static void Run(void* context)
+	{
+		SCreatePlayerTask* task = (SCreatePlayerTask*)context;
+
+		task->m_player = new CFlashDXPlayer(task->m_owner, task->m_flashLibHandle, task->m_width, task->m_height);
+		if (task->m_player->m_flashInterface == NULL)
+		{
+			delete task->m_player;
+			task->m_player = NULL;
+			return;
+		}
+
+		if (task->m_worker)
+		{
+			task->m_player->m_worker = task->m_worker;
+			task->m_worker->AddPlayer(task->m_player);
+		}
+	}
+};
+
+//---------------------------------------------------------------------
+static void DeletePlayerTask(void* context)
+{
+	CFlashDXPlayer* player = (CFlashDXPlayer*)context;
+	player->m_worker->RemovePlayer(player);
+	delete player;
+}
+
+//---------------------------------------------------------------------
+CFlashDXPlayer* CFlashDX::CreatePlayerInstance(unsigned int width, unsigned int height)
+{
+	SCreatePlayerTask task;
+	task.m_owner = this;
+	task.m_flashLibHandle = m_flashLibHandle;
+	task.m_width = width;
+	task.m_height = height;
+	task.m_worker = NULL;
+	task.m_player = NULL;
+
+	if (m_workers.empty())
+	{
+		SCreatePlayerTask::Run(&task);
+		return task.m_player;
+	}
+
+	for (size_t i = 0; i < m_workers.size(); ++i)
+	{
+		if (task.m_worker == NULL || m_workers[i]->m_numPlayers < task.m_worker->m_numPlayers)
+			task.m_worker = m_workers[i];
+	}
+
+	task.m_worker->Invoke(SCreatePlayerTask::Run, &task);
+	if (task.m_player)
+		++task.m_worker->m_numPlayers;
+
+	return task.m_player;
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::DeletePlayerInstance(CFlashDXPlayer* player)
+{
+	CRenderWorker* worker = player->m_worker;
+	if (worker == NULL)
 	{
 		delete player;
-		return NULL;
+		return;
 	}
-	return player;
+
+	worker->Invoke(DeletePlayerTask, player);
+	--worker->m_numPlayers;
+
+	DropRenderedFrames(player);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::DropRenderedFrames(CFlashDXPlayer* player)
+{
+	// Worker doesn't know the player anymore or has just reset it, so its ring can be drained safely
+	SRenderedFrame frame;
+	for (size_t i = 0; i < m_workers.size(); ++i)
+	{
+		while (m_workers[i]->PopFrame(frame))
+			m_poppedFrames.push_back(frame);
+	}
+
+	for (size_t i = 0; i < m_poppedFrames.size(); )
+	{
+		if (m_poppedFrames[i].m_player == player)
+			m_poppedFrames.erase(m_poppedFrames.begin() + i);
+		else
+			++i;
+	}
+}
+
+//---------------------------------------------------------------------
+static void ResetPlayerTask(IFlashDXPlayer* pPlayer, void* /*context*/)
+{
+	CFlashDXPlayer* player = (CFlashDXPlayer*)pPlayer;
+	player->Reset();
+
+	// Frames rendered for the previous owner must not reach the next one
+	if (player->m_worker)
+		player->m_worker->DropPendingFrames(player);
+}
+
+//---------------------------------------------------------------------
+static void ResizePlayerTask(IFlashDXPlayer* pPlayer, void* context)
+{
+	const unsigned int* size = (const unsigned int*)context;
+	pPlayer->ResizePlayer(size[0], size[1]);
 }
 
 //---------------------------------------------------------------------
 void CFlashDX::DestroyPlayer(IFlashDXPlayer* pPlayer)
 {
-	delete (CFlashDXPlayer*)pPlayer;
+	if (pPlayer == NULL)
+		return;
+
+	if (IsRemotePlayer(pPlayer))
+	{
+		m_remotePlayers.erase(std::find(m_remotePlayers.begin(), m_remotePlayers.end(), pPlayer));
+		delete (CRemotePlayer*)pPlayer;
+	}
+	else if (m_freePlayers.size() < m_poolStats.m_poolSize)
+	{
+		ReleasePlayer(pPlayer);
+	}
+	else
+	{
+		RemoveLivePlayer((CFlashDXPlayer*)pPlayer);
+		DeletePlayerInstance((CFlashDXPlayer*)pPlayer);
+	}
 }
 
 //---------------------------------------------------------------------
-bool CFlashDX::GetMovieProperties(const wchar_t* movie, SMovieProperties& props)
+void CFlashDX::SetPlayerPoolSize(unsigned int numPlayers, unsigned int width, unsigned int height)
+{
+	m_poolStats.m_poolSize = numPlayers;
+
+	while (m_freePlayers.size() > numPlayers)
+	{
+		DeletePlayerInstance(m_freePlayers.back());
+		m_freePlayers.pop_back();
+	}
+
+	while (m_freePlayers.size() < numPlayers)
+	{
+		CFlashDXPlayer* player = CreatePlayerInstance(width, height);
+		if (player == NULL)
+			break;
+
+		++m_poolStats.m_numCreated;
+		m_freePlayers.push_back(player);
+	}
+}
+
+//---------------------------------------------------------------------
+struct IFlashDXPlayer* CFlashDX::AcquirePlayer(unsigned int width, unsigned int height)
+{
+	if (m_freePlayers.empty())
+	{
+		IFlashDXPlayer* player = CreatePlayer(width, height);
+		if (player != NULL)
+			++m_poolStats.m_numCreated;
+		++m_poolStats.m_numMisses;
+		return player;
+	}
+
+	CFlashDXPlayer* player = m_freePlayers.back();
+	m_freePlayers.pop_back();
+	++m_poolStats.m_numHits;
+
+	if (player->m_logicalWidth != width || player->m_logicalHeight != height)
+	{
+		unsigned int size[2] = { width, height };
+		InvokeOnPlayerThread(player, ResizePlayerTask, size);
+	}
+
+	AddLivePlayer(player);
+	return player;
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::ReleasePlayer(IFlashDXPlayer* pPlayer)
+{
+	if (pPlayer == NULL)
+		return;
+
+	// Remote players are never pooled
+	if (IsRemotePlayer(pPlayer))
+	{
+		DestroyPlayer(pPlayer);
+		return;
+	}
+
+	CFlashDXPlayer* player = (CFlashDXPlayer*)pPlayer;
+	RemoveLivePlayer(player);
+
+	if (m_freePlayers.size() >= m_poolStats.m_poolSize)
+	{
+		DeletePlayerInstance(player);
+		return;
+	}
+
+	InvokeOnPlayerThread(player, ResetPlayerTask, NULL);
+	if (player->m_worker)
+	{
+		DropRenderedFrames(player);
+		InterlockedExchange(&player->m_frameBusy, 0);
+	}
+
+	m_freePlayers.push_back(player);
+	++m_poolStats.m_numReleased;
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::GetPlayerPoolStats(SPlayerPoolStats& stats)
+{
+	stats = m_poolStats;
+	stats.m_numFree = (unsigned int)m_freePlayers.size();
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::AddLivePlayer(CFlashDXPlayer* player)
+{
+	m_livePlayers.push_back(player);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::RemoveLivePlayer(CFlashDXPlayer* player)
+{
+	std::vector<CFlashDXPlayer*>::iterator it = std::find(m_livePlayers.begin(), m_livePlayers.end(), player);
+	if (it != m_livePlayers.end())
+		m_livePlayers.erase(it);
+
+	// Forget pending update of the player
+	for (std::vector<SPlayerUpdate>::iterator itUpdate = m_updates.begin(); itUpdate != m_updates.end(); ++itUpdate)
+	{
+		if (itUpdate->m_player == player)
+		{
+			m_updates.erase(itUpdate);
+			break;
+		}
+	}
+}
+
+//---------------------------------------------------------------------
+// Single pass players first, then FULL_ALPHA ones grouped by surface size.
+static bool CompareUpdates(const IFlashDX::SPlayerUpdate& first, const IFlashDX::SPlayerUpdate& second)
+{
+	const CFlashDXPlayer* firstPlayer = (const CFlashDXPlayer*)first.m_player;
+	const CFlashDXPlayer* secondPlayer = (const CFlashDXPlayer*)second.m_player;
+
+	if (firstPlayer->m_transpMode != secondPlayer->m_transpMode)
+		return firstPlayer->m_transpMode < secondPlayer->m_transpMode;
+
+	return firstPlayer->m_width * firstPlayer->m_height > secondPlayer->m_width * secondPlayer->m_height;
+}
+
+//---------------------------------------------------------------------
+// Non-critical players postponed most often go first.
+static bool CompareDeferredUpdates(const IFlashDX::SPlayerUpdate* first, const IFlashDX::SPlayerUpdate* second)
+{
+	return ((const CFlashDXPlayer*)first->m_player)->m_numPostponedUpdates > ((const CFlashDXPlayer*)second->m_player)->m_numPostponedUpdates;
+}
+
+//---------------------------------------------------------------------
+unsigned int CFlashDX::CollectUpdates(SPlayerUpdate** updates)
+{
+	m_updates.clear();
+	m_updateRects.clear();
+
+	for (std::vector<CFlashDXPlayer*>::iterator it = m_livePlayers.begin(); it != m_livePlayers.end(); ++it)
+	{
+		CFlashDXPlayer* player = *it;
+
+		// Worker owned players are rendered by RenderAsync()
+		if (player->m_worker != NULL)
+			continue;
+
+		const RECT* unitedDirtyRect; const RECT* dirtyRects; unsigned int numDirtyRects;
+		if (!player->CFlashDXPlayer::IsNeedUpdate(&unitedDirtyRect, &dirtyRects, &numDirtyRects))
+			continue;
+
+		SPlayerUpdate update;
+		update.m_player = player;
+		update.m_unitedDirtyRect = *unitedDirtyRect;
+		update.m_dirtyRects = NULL;
+		update.m_numDirtyRects = numDirtyRects;
+		update.m_dc = NULL;
+		m_updates.push_back(update);
+
+		m_updateRects.insert(m_updateRects.end(), dirtyRects, dirtyRects + numDirtyRects);
+	}
+
+	// Rectangles are packed in collection order, fix up pointers before sorting
+	unsigned int rectIndex = 0;
+	for (std::vector<SPlayerUpdate>::iterator it = m_updates.begin(); it != m_updates.end(); ++it)
+	{
+		it->m_dirtyRects = it->m_numDirtyRects ? &m_updateRects[rectIndex] : NULL;
+		rectIndex += it->m_numDirtyRects;
+	}
+
+	std::stable_sort(m_updates.begin(), m_updates.end(), CompareUpdates);
+
+	if (updates)
+		*updates = m_updates.empty() ? NULL : &m_updates.front();
+
+	return (unsigned int)m_updates.size();
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::DrawAll()
+{
+	LARGE_INTEGER frequency, startTime;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&startTime);
+
+	m_deferredUpdates.clear();
+	for (std::vector<SPlayerUpdate>::iterator it = m_updates.begin(); it != m_updates.end(); ++it)
+	{
+		if (it->m_dc == NULL)
+			continue;
+
+		CFlashDXPlayer* player = (CFlashDXPlayer*)it->m_player;
+		if (player->m_critical || m_frameBudget <= 0.0f)
+			player->CFlashDXPlayer::DrawFrame(it->m_dc);
+		else
+			m_deferredUpdates.push_back(&*it);
+	}
+
+	std::stable_sort(m_deferredUpdates.begin(), m_deferredUpdates.end(), CompareDeferredUpdates);
+
+	for (std::vector<SPlayerUpdate*>::iterator it = m_deferredUpdates.begin(); it != m_deferredUpdates.end(); ++it)
+	{
+		CFlashDXPlayer* player = (CFlashDXPlayer*)(*it)->m_player;
+
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+		float elapsed = float(double(time.QuadPart - startTime.QuadPart) * 1000.0 / double(frequency.QuadPart));
+
+		// Players postponed for too long are drawn anyway so they can't starve
+		if (elapsed + player->GetAverageDrawTime() > m_frameBudget && player->m_numPostponedUpdates < s_maxPostponedUpdates)
+		{
+			// Player stays dirty and is collected again next frame
+			++player->m_numPostponedUpdates;
+			continue;
+		}
+
+		player->CFlashDXPlayer::DrawFrame((*it)->m_dc);
+		player->m_numPostponedUpdates = 0;
+	}
+	m_deferredUpdates.clear();
+
+	// Make sure all GDI work is done before the caller releases DCs
+	GdiFlush();
+
+	m_updates.clear();
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::SetFrameBudget(float budget)
+{
+	m_frameBudget = budget;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::SetNumRenderThreads(unsigned int numThreads)
+{
+	for (size_t i = 0; i < m_livePlayers.size(); ++i)
+	{
+		if (m_livePlayers[i]->m_worker != NULL)
+			return false;
+	}
+	for (size_t i = 0; i < m_freePlayers.size(); ++i)
+	{
+		if (m_freePlayers[i]->m_worker != NULL)
+			return false;
+	}
+
+	for (size_t i = 0; i < m_workers.size(); ++i)
+		delete m_workers[i];
+	m_workers.clear();
+	m_poppedFrames.clear();
+	m_nextWorker = 0;
+
+	for (unsigned int i = 0; i < numThreads; ++i)
+	{
+		CRenderWorker* worker = new CRenderWorker();
+		if (!worker->IsRunning())
+		{
+			delete worker;
+			return false;
+		}
+		m_workers.push_back(worker);
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------
+unsigned int CFlashDX::GetNumRenderThreads() const
+{
+	return (unsigned int)m_workers.size();
+}
+
+//---------------------------------------------------------------------
+struct SInvokeTask
+{
+	void					(*m_func)(IFlashDXPlayer* pPlayer, void* context);
+	IFlashDXPlayer*			m_player;
+	void*					m_context;
+
+	//---------------------------------------------------------------------
+	static void Run(void* context)
+	{
+		SInvokeTask* task = (SInvokeTask*)context;
+		task->m_func(task->m_player, task->m_context);
+	}
+};
+
+//---------------------------------------------------------------------
+void CFlashDX::InvokeOnPlayerThread(IFlashDXPlayer* pPlayer, void (*func)(IFlashDXPlayer* pPlayer, void* context), void* context)
+{
+	CRenderWorker* worker = IsRemotePlayer(pPlayer) ? NULL : ((CFlashDXPlayer*)pPlayer)->m_worker;
+	if (worker == NULL)
+	{
+		func(pPlayer, context);
+		return;
+	}
+
+	SInvokeTask task = { func, pPlayer, context };
+	worker->Invoke(SInvokeTask::Run, &task);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::RenderAsync()
 {
+	for (size_t i = 0; i < m_workers.size(); ++i)
+		m_workers[i]->RequestRender();
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::PopRenderedFrame(SRenderedFrame& frame)
+{
+	if (!m_poppedFrames.empty())
+	{
+		frame = m_poppedFrames.front();
+		m_poppedFrames.pop_front();
+		return true;
+	}
+
+	for (size_t i = 0; i < m_workers.size(); ++i)
+	{
+		CRenderWorker* worker = m_workers[m_nextWorker];
+		m_nextWorker = (m_nextWorker + 1) % (unsigned int)m_workers.size();
+
+		if (worker->PopFrame(frame))
+			return true;
+	}
+
 	return false;
 }
 
+//---------------------------------------------------------------------
+void CFlashDX::ReleaseRenderedFrame(const SRenderedFrame& frame)
+{
+	InterlockedExchange(&((CFlashDXPlayer*)frame.m_player)->m_frameBusy, 0);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::GetMovieProperties(const wchar_t* movie, SMovieProperties& props)
+{
+	// Properties are in the header, no need to read and inflate whole movie
+	CSWFData swf;
+	if (!swf.LoadHeaderFromFile(movie) || !swf.DecompressHeader())
+		return false;
+
+	return CSWFAnalyzer::GetProperties(swf.GetData(), swf.GetSize(), props);
+}
+
 //---------------------------------------------------------------------
 bool CFlashDX::GetMovieProperties(const void* movieData, const unsigned int movieDataSize, SMovieProperties& props)
 {
-	return false;
+	CSWFData swf;
+	if (!swf.LoadHeaderFromMemory(movieData, movieDataSize) || !swf.DecompressHeader())
+		return false;
+
+	return CSWFAnalyzer::GetProperties(swf.GetData(), swf.GetSize(), props);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::AnalyzeMovie(const wchar_t* movie, SMovieCost& cost)
+{
+	CSWFData swf;
+	if (!swf.LoadFromFile(movie))
+		return false;
+
+	return AnalyzeMovie(swf.GetData(), swf.GetSize(), cost);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::AnalyzeMovie(const void* movieData, const unsigned int movieDataSize, SMovieCost& cost)
+{
+	std::vector<BYTE> movie;
+	if (!DecompressMovie((const BYTE*)movieData, movieDataSize, movie))
+		return false;
+
+	CSWFAnalyzer analyzer;
+	return analyzer.Analyze(&movie[0], (unsigned int)movie.size(), cost);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::DecompressMovie(const BYTE* movieData, unsigned int movieDataSize, std::vector<BYTE>& movie)
+{
+	if (movieData == NULL || movieDataSize == 0)
+		return false;
+
+	if (m_movieCache.IsEnabled())
+		return m_movieCache.GetDecompressedMovie(movieData, movieDataSize, movie);
+
+	CSWFData swf;
+	if (!swf.LoadFromMemory(movieData, movieDataSize) || !swf.Decompress())
+		return false;
+
+	movie.swap(swf.GetBuffer());
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::SetMovieCache(unsigned int memoryLimit, const wchar_t* diskCachePath)
+{
+	m_movieCache.SetLimits(memoryLimit, diskCachePath);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::GetMovieCacheStats(SMovieCacheStats& stats)
+{
+	m_movieCache.GetStats(stats);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::SetRenderBufferPoolLimit(unsigned int memoryLimit)
+{
+	m_renderBufferPool.SetLimit(memoryLimit);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::GetRenderBufferPoolStats(SRenderBufferPoolStats& stats)
+{
+	m_renderBufferPool.GetStats(stats);
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::StartTrace()
+{
+	m_tracer.Start();
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::StopTrace(const wchar_t* path)
+{
+	return m_tracer.Stop(path);
+}
+
+//---------------------------------------------------------------------
+static void AddPlayerMemoryTask(IFlashDXPlayer* pPlayer, void* context)
+{
+	IFlashDXPlayer::SMemoryUsage playerUsage;
+	pPlayer->GetMemoryUsage(playerUsage);
+	*(unsigned int*)context += playerUsage.m_total;
+}
+
+//---------------------------------------------------------------------
+void CFlashDX::GetMemoryUsage(SMemoryUsage& usage)
+{
+	memset(&usage, 0, sizeof(usage));
+
+	usage.m_numPlayers = (unsigned int)(m_livePlayers.size() + m_freePlayers.size() + m_remotePlayers.size());
+	for (size_t i = 0; i < m_livePlayers.size(); ++i)
+		InvokeOnPlayerThread(m_livePlayers[i], AddPlayerMemoryTask, &usage.m_players);
+	for (size_t i = 0; i < m_freePlayers.size(); ++i)
+		InvokeOnPlayerThread(m_freePlayers[i], AddPlayerMemoryTask, &usage.m_players);
+	for (size_t i = 0; i < m_remotePlayers.size(); ++i)
+		AddPlayerMemoryTask(m_remotePlayers[i], &usage.m_players);
+
+	SRenderBufferPoolStats poolStats;
+	m_renderBufferPool.GetStats(poolStats);
+	usage.m_renderBuffers = poolStats.m_memoryUsage;
+
+	SMovieCacheStats movieCacheStats;
+	m_movieCache.GetStats(movieCacheStats);
+	usage.m_movieCache = movieCacheStats.m_memoryUsage;
+
+	usage.m_total = usage.m_players + usage.m_renderBuffers + usage.m_movieCache;
+}
+
+//---------------------------------------------------------------------
+struct IFlashDXPlayer* CFlashDX::CreateRemotePlayer(unsigned int width, unsigned int height, const wchar_t* hostCommandLine)
+{
+	CRemotePlayer* player = new CRemotePlayer(width, height);
+	if (!player->Start(hostCommandLine))
+	{
+		delete player;
+		return NULL;
+	}
+
+	m_remotePlayers.push_back(player);
+	return player;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::RunRemoteHost(const wchar_t* channelName)
+{
+	CRemoteHost host;
+	return host.Run(this, channelName);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDX::IsRemotePlayer(IFlashDXPlayer* player) const
+{
+	return std::find(m_remotePlayers.begin(), m_remotePlayers.end(), player) != m_remotePlayers.end();
+}
+
+//---------------------------------------------------------------------
+CMovieCache& CFlashDX::GetMovieCache()
+{
+	return m_movieCache;
+}
+
+//---------------------------------------------------------------------
+CRenderBufferPool& CFlashDX::GetRenderBufferPool()
+{
+	return m_renderBufferPool;
+}
+
+//---------------------------------------------------------------------
+CTracer& CFlashDX::GetTracer()
+{
+	return m_tracer;
 }
\ No newline at end of file
@@ -23,6 +23,10 @@
 #pragma once
 
 #include "IFlashDX.h"
+#include "MovieCache.h"
+#include "RenderBufferPool.h"
+#include "Tracer.h"
+#include <deque>
 
 //---------------------------------------------------------------------
 /// Implementation of IFlashDX interface.
@@ -44,9 +48,89 @@ public:
 	virtual double GetFlashVersion();
 	virtual struct IFlashDXPlayer* CreatePlayer(unsigned int width, unsigned int height);
 	virtual void DestroyPlayer(IFlashDXPlayer* pPlayer);
+	virtual void SetPlayerPoolSize(unsigned int numPlayers, unsigned int width, unsigned int height);
+	virtual struct IFlashDXPlayer* AcquirePlayer(unsigned int width, unsigned int height);
+	virtual void ReleasePlayer(IFlashDXPlayer* pPlayer);
+	virtual void GetPlayerPoolStats(SPlayerPoolStats& stats);
+	virtual unsigned int CollectUpdates(SPlayerUpdate** updates);
+	virtual void DrawAll();
+	virtual void SetFrameBudget(float budget);
+	virtual bool SetNumRenderThreads(unsigned int numThreads);
+	virtual unsigned int GetNumRenderThreads() const;
+	virtual void InvokeOnPlayerThread(IFlashDXPlayer* pPlayer, void (*func)(IFlashDXPlayer* pPlayer, void* context), void* context);
+	virtual void RenderAsync();
+	virtual bool PopRenderedFrame(SRenderedFrame& frame);
+	virtual void ReleaseRenderedFrame(const SRenderedFrame& frame);
 	virtual bool GetMovieProperties(const wchar_t* movie, SMovieProperties& props);
 	virtual bool GetMovieProperties(const void* movieData, const unsigned int movieDataSize, SMovieProperties& props);
+	virtual void SetMovieCache(unsigned int memoryLimit, const wchar_t* diskCachePath = NULL);
+	virtual void GetMovieCacheStats(SMovieCacheStats& stats);
+	virtual void SetRenderBufferPoolLimit(unsigned int memoryLimit);
+	virtual void GetRenderBufferPoolStats(SRenderBufferPoolStats& stats);
+	virtual void StartTrace();
+	virtual bool StopTrace(const wchar_t* path);
+	virtual void GetMemoryUsage(SMemoryUsage& usage);
+	virtual bool AnalyzeMovie(const wchar_t* movie, SMovieCost& cost);
+	virtual bool AnalyzeMovie(const void* movieData, const unsigned int movieDataSize, SMovieCost& cost);
+	virtual struct IFlashDXPlayer* CreateRemotePlayer(unsigned int width, unsigned int height, const wchar_t* hostCommandLine);
+	virtual bool RunRemoteHost(const wchar_t* channelName);
+
+	//---------------------------------------------------------------------
+	/// Returns cache of decompressed movies shared by all players.
+	CMovieCache& GetMovieCache();
+
+	//---------------------------------------------------------------------
+	/// Returns scratch buffers shared by all players.
+	CRenderBufferPool& GetRenderBufferPool();
+
+	//---------------------------------------------------------------------
+	/// Returns tracer of player activity.
+	CTracer& GetTracer();
+
+protected:
+	//---------------------------------------------------------------------
+	/// Returns uncompressed movie data, using movie cache if it is enabled.
+	bool DecompressMovie(const BYTE* movieData, unsigned int movieDataSize, std::vector<BYTE>& movie);
+
+	//---------------------------------------------------------------------
+	/// Creates player without registering it in the live players list.
+	/// Player is created on the least loaded worker thread if there are any.
+	class CFlashDXPlayer* CreatePlayerInstance(unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Destroys player on its owner thread.
+	void DeletePlayerInstance(CFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	/// Removes frames of the player that are not popped yet.
+	void DropRenderedFrames(CFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	void AddLivePlayer(CFlashDXPlayer* player);
+	void RemoveLivePlayer(CFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	/// Checks if the player was created by CreateRemotePlayer().
+	bool IsRemotePlayer(IFlashDXPlayer* player) const;
 
 protected:
 	HMODULE					m_flashLibHandle;		
+	CMovieCache				m_movieCache;
+	CRenderBufferPool		m_renderBufferPool;
+	CTracer					m_tracer;
+
+	std::vector<CFlashDXPlayer*> m_livePlayers;
+	std::vector<CFlashDXPlayer*> m_freePlayers;
+	SPlayerPoolStats		m_poolStats;
+
+	std::vector<SPlayerUpdate> m_updates;
+	std::vector<RECT>		m_updateRects;
+	std::vector<SPlayerUpdate*> m_deferredUpdates;	// non-critical updates drawn within the frame budget
+	float					m_frameBudget;
+
+	std::vector<class CRenderWorker*> m_workers;
+	std::deque<SRenderedFrame> m_poppedFrames;	// frames taken from worker rings but not returned yet
+	unsigned int			m_nextWorker;			// worker to pop first, for fairness
+
+	std::vector<class CRemotePlayer*> m_remotePlayers;
 };
\ No newline at end of file
@@ -22,15 +22,63 @@
 
 #include "stdafx.h"
 #include "FlashDXPlayer.h"
+#include "FlashDX.h"
+#include "SWFData.h"
+#include "SWFAnalyzer.h"
+#include "MovieLoader.h"
+#include "CallRecorder.h"
+#include "DirtyRectTrace.h"
+#include "AlphaCombine.h"
 #include "shlwapi.h"
 #include "algorithm"
+#include "math.h"
 #include "sstream"
 
 using namespace ShockwaveFlashObjects;
 
 //---------------------------------------------------------------------
-CFlashDXPlayer::CFlashDXPlayer(HMODULE flashDLL, unsigned int width, unsigned int height)
+// Movie state has to stay unchanged this long, in milliseconds, to be stored in the frame cache.
+static const DWORD s_minStaticStateTime = 250;
+
+//---------------------------------------------------------------------
+static double GetTimeMs()
+{
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return double(counter.QuadPart) * 1000.0 / double(frequency.QuadPart);
+}
+
+//---------------------------------------------------------------------
+static unsigned int GetRectArea(const RECT& rect)
+{
+	return (unsigned int)((rect.right - rect.left) * (rect.bottom - rect.top));
+}
+
+//---------------------------------------------------------------------
+static unsigned int GetStringSize(const std::wstring& string)
+{
+	return (unsigned int)(string.capacity() * sizeof(wchar_t));
+}
+
+//---------------------------------------------------------------------
+// DrawFrame() stage timing, compiled out unless FLASHDX_DRAW_TIMING is defined.
+// DRAW_TIMING_STAGE() charges time passed since the previous mark to the stage.
+#ifdef FLASHDX_DRAW_TIMING
+#define DRAW_TIMING_START()			double stageStart = GetTimeMs()
+#define DRAW_TIMING_STAGE(stage)	{ double stageEnd = GetTimeMs(); m_drawTimings.AddStageTime(stage, stageEnd - stageStart); stageStart = stageEnd; }
+#else
+#define DRAW_TIMING_START()
+#define DRAW_TIMING_STAGE(stage)
+#endif
+
+//---------------------------------------------------------------------
+CFlashDXPlayer::CFlashDXPlayer(CFlashDX* owner, HMODULE flashDLL, unsigned int width, unsigned int height)
 {
+	m_owner = owner;
 	m_userData = NULL;
 	m_flashInterface = NULL;
 	m_oleObject = NULL;
@@ -38,21 +86,61 @@ CFlashDXPlayer::CFlashDXPlayer(HMODULE flashDLL, unsigned int width, unsigned in
 	m_lastMouseX = 0;
 	m_lastMouseY = 0;
 	m_lastMouseButtons = 0;
+	m_modifierKeys = 0;
+	m_bufferInput = false;
+	m_numQueuedInput = 0;
+
+	m_hitTestThreshold = 0;
+	m_hitTestInput = false;
+	m_mouseOverOpaque = true;
 
 	m_dirtyFlag = false;
+	m_dirtyEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	m_dirtyCallback = NULL;
+	m_dirtyCallbackContext = NULL;
+
+	m_movieLoader = NULL;
+	m_loadProgress = 0;
+	m_waitingForMovie = false;
+	m_recorder = NULL;
+	m_replayer = NULL;
+	m_dirtyRectTrace = NULL;
+
+	m_critical = true;
+	m_numPostponedUpdates = 0;
 
 	m_width = width;
 	m_height = height;
+	m_logicalWidth = width;
+	m_logicalHeight = height;
+	m_resolutionScale = 1.0f;
+	m_hasVisibleRect = false;
+	SetRectEmpty(&m_hiddenDirtyRect);
+	UpdateVisibleRect();
+	m_hiddenTime = GetTickCount();
+
+	m_suspended = false;
+	m_autoSuspended = false;
+	m_resumePlaying = false;
+	m_autoSuspendDelay = INFINITE;
+
+	m_autoFrameCacheKey = true;
+	m_drawnStateTime = 0;
+
+	memset(&m_counters, 0, sizeof(m_counters));
 
 	m_controlSite.Init(this);
 	m_controlSite.AddRef();
 
-	m_alphaBlackDC = NULL;
-	m_alphaBlackBitmap = NULL;
-	m_alphaBlackBuffer = NULL;
-	m_alphaWhiteDC = NULL;
-	m_alphaWhiteBitmap = NULL;
-	m_alphaWhiteBuffer = NULL;
+
+	m_worker = NULL;
+	m_frameDC = NULL;
+	m_frameBitmap = NULL;
+	m_frameBits = NULL;
+	m_frameWidth = 0;
+	m_frameHeight = 0;
+	m_frameBusy = 0;
+	m_renderScratchSize = 0;
 
 	HRESULT hr;
 
@@ -115,13 +203,11 @@ CFlashDXPlayer::CFlashDXPlayer(HMODULE flashDLL, unsigned int width, unsigned in
 //---------------------------------------------------------------------
 CFlashDXPlayer::~CFlashDXPlayer()
 {
-	if (m_alphaBlackDC)
-	{
-		DeleteDC(m_alphaBlackDC);
-		DeleteObject(m_alphaBlackBitmap);
-		DeleteDC(m_alphaWhiteDC);
-		DeleteObject(m_alphaWhiteBitmap);
-	}
+	CancelAsyncLoad();
+	StopRecording();
+	StopReplay();
+	StopDirtyRectTrace();
+	ReleaseFrameBuffer();
 
 	SAFE_RELEASE(m_windowlessObject);
 	SAFE_RELEASE(m_flashInterface);
@@ -136,53 +222,188 @@ CFlashDXPlayer::~CFlashDXPlayer()
 	}
 
 	m_controlSite.Release();
+
+	CloseHandle(m_dirtyEvent);
 }
 
 //---------------------------------------------------------------------
-void CFlashDXPlayer::AddDirtyRect(const RECT* pRect)
+void CFlashDXPlayer::Reset()
 {
-	m_dirtyFlag = true;
-	
-	if (pRect == NULL)
+	// Minimal movie: empty stage, one frame with nothing on it
+	static const BYTE emptyMovie[] =
 	{
-		RECT rect = { 0, 0, m_width, m_height };
-		m_dirtyUnionRect = rect;
-		m_dirtyRects.clear();
-		m_dirtyRects.push_back(m_dirtyUnionRect);
+		'F', 'W', 'S', 10, 17, 0, 0, 0,		// signature, version, file length
+		0x00,								// stage rect with zero bits per field
+		0x00, 0x0C, 0x01, 0x00,				// 12 fps, 1 frame
+		0x40, 0x00,							// ShowFrame
+		0x00, 0x00							// End
+	};
+
+	CancelAsyncLoad();
+	StopRecording();
+	StopReplay();
+	StopDirtyRectTrace();
+
+	if (m_flashInterface)
+	{
+		m_flashInterface->StopPlay();
+		LoadMovieFromMemory(emptyMovie, sizeof(emptyMovie));
 	}
-	else
+
+	m_commandProxy.Discard();
+	m_eventHandlers.clear();
+	m_userData = NULL;
+	m_dirtyCallback = NULL;
+	m_dirtyCallbackContext = NULL;
+
+	m_pacer.SetLimits(0.0f, false);
+	m_pacer.ResetStats();
+
+	m_critical = true;
+	m_numPostponedUpdates = 0;
+
+	m_suspended = false;
+	m_autoSuspended = false;
+	m_resumePlaying = false;
+	m_autoSuspendDelay = INFINITE;
+
+	m_frameCache.SetLimit(0);
+	m_autoFrameCacheKey = true;
+	m_frameCacheKey.clear();
+	m_drawnStateKey.clear();
+
+	SetTransparencyMode(IFlashDXPlayer::TMODE_OPAQUE);
+	SetAdaptiveQuality(0.0f);
+	SetResolutionScale(1.0f);
+	SetVisibleRect(NULL);
+	SetQuality(IFlashDXPlayer::QUALITY_HIGH);
+
+	m_lastMouseX = 0;
+	m_lastMouseY = 0;
+	m_lastMouseButtons = 0;
+	m_modifierKeys = 0;
+	m_inputQueue.Clear();
+	m_bufferInput = false;
+	m_numQueuedInput = 0;
+
+	m_hitMask.Clear();
+	m_hitTestThreshold = 0;
+	m_hitTestInput = false;
+	m_mouseOverOpaque = true;
+
+	m_invokeString.clear();
+	m_tempStorage.clear();
+
+	ResetCounters();
+	ResetDrawTimings();
+
+	m_dirtyFlag = false;
+	m_dirtyRects.Clear();
+	SetRectEmpty(&m_hiddenDirtyRect);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::PrepareFrameBuffer()
+{
+	if (m_frameDC != NULL && m_frameWidth == m_width && m_frameHeight == m_height)
+		return true;
+
+	ReleaseFrameBuffer();
+
+	if (m_width == 0 || m_height == 0)
+		return false;
+
+	BITMAPINFOHEADER bih = {0};
+	bih.biSize = sizeof(BITMAPINFOHEADER);
+	bih.biBitCount = 32;
+	bih.biCompression = BI_RGB;
+	bih.biPlanes = 1;
+	bih.biWidth = LONG(m_width);
+	bih.biHeight = -LONG(m_height);
+
+	m_frameDC = CreateCompatibleDC(NULL);
+	m_frameBitmap = CreateDIBSection(m_frameDC, (BITMAPINFO*)&bih, DIB_RGB_COLORS, (void**)&m_frameBits, 0, 0);
+	if (m_frameBitmap == NULL)
 	{
-		RECT screenRect = {0, 0, m_width, m_height};
+		ReleaseFrameBuffer();
+		return false;
+	}
 
-		RECT newRect = {0};
-		IntersectRect(&newRect, pRect, &screenRect);
+	SelectObject(m_frameDC, m_frameBitmap);
+	m_frameWidth = m_width;
+	m_frameHeight = m_height;
 
-		if (IsRectEmpty(&newRect))
-			return;
+	// New buffer has no content yet
+	AddDirtyRect(NULL);
+	return true;
+}
 
-		#define MIN_MACRO(x, y) ((x) < (y) ? (x) : (y))
-		#define MAX_MACRO(x, y) ((x) > (y) ? (x) : (y))
+//---------------------------------------------------------------------
+void CFlashDXPlayer::ReleaseFrameBuffer()
+{
+	if (m_frameDC)
+		DeleteDC(m_frameDC);
+	if (m_frameBitmap)
+		DeleteObject(m_frameBitmap);
+
+	m_frameDC = NULL;
+	m_frameBitmap = NULL;
+	m_frameBits = NULL;
+	m_frameWidth = 0;
+	m_frameHeight = 0;
+}
 
-		for (std::vector<RECT>::iterator it = m_dirtyRects.begin(); it != m_dirtyRects.end(); ++it)
-			if (it->left <= newRect.left && it->top <= newRect.top &&
-				it->right >= newRect.right && it->bottom >= newRect.bottom)
-			{
-				return; // already included
-			}
+//---------------------------------------------------------------------
+void CFlashDXPlayer::AddDirtyRect(const RECT* pRect)
+{
+	// Keep the last frame of the previous movie until the new one is ready
+	if (m_waitingForMovie || m_suspended)
+	{
+		++m_counters.m_numDroppedDirtyRects;
+		return;
+	}
+
+	RECT screenRect = {0, 0, m_width, m_height};
+	if (pRect == NULL)
+		pRect = &screenRect;
+
+	RECT countedRect;
+	if (IntersectRect(&countedRect, pRect, &screenRect))
+		m_counters.m_dirtyPixels += GetRectArea(countedRect);
+	++m_counters.m_numDirtyRects;
+
+	// Changes outside of the visible rect are drawn when it is scrolled into view.
+	// Without one, only the part outside of the surface is clipped and there is nothing to track.
+	RECT newRect = {0};
+	IntersectRect(&newRect, pRect, &m_visibleRect);
+	if (m_hasVisibleRect && !EqualRect(&newRect, pRect))
+	{
+		RECT hiddenRect;
+		if (IntersectRect(&hiddenRect, pRect, &screenRect))
+			UnionRect(&m_hiddenDirtyRect, &m_hiddenDirtyRect, &hiddenRect);
+	}
 
-		RECT rect = { newRect.left, newRect.top, newRect.right, newRect.bottom };
-		rect.left = MAX_MACRO(rect.left, 0);
-		rect.top = MAX_MACRO(rect.top, 0);
-		rect.right = MIN_MACRO(rect.right, (LONG)m_width);
-		rect.bottom = MIN_MACRO(rect.bottom, (LONG)m_height);
+	if (IsRectEmpty(&newRect))
+		return;
 
-		m_dirtyUnionRect.left = MIN_MACRO(m_dirtyUnionRect.left, newRect.left);
-		m_dirtyUnionRect.top = MIN_MACRO(m_dirtyUnionRect.top, newRect.top);
-		m_dirtyUnionRect.right = MAX_MACRO(m_dirtyUnionRect.right, newRect.right);
-		m_dirtyUnionRect.bottom = MAX_MACRO(m_dirtyUnionRect.bottom, newRect.bottom);
+	if (!m_dirtyFlag)
+	{
+		m_dirtyFlag = true;
+		m_pacer.OnDirty();
 
-		m_dirtyRects.push_back(rect);
+		// Wake up the host waiting for changes
+		SetEvent(m_dirtyEvent);
+		if (m_dirtyCallback)
+			m_dirtyCallback(this, m_dirtyCallbackContext);
 	}
+
+	if (m_dirtyRectTrace)
+		m_dirtyRectTrace->AddRect(newRect, pRect == &screenRect);
+
+	if (pRect == &screenRect)
+		m_dirtyRects.Set(newRect);
+	else
+		m_dirtyRects.Add(newRect, (LONG)m_width, (LONG)m_height);
 }
 
 //---------------------------------------------------------------------
@@ -231,6 +452,8 @@ void CFlashDXPlayer::SetQuality(EQuality quality)
 		_bstr_t newStr(aQualityNames[quality]);
 		m_flashInterface->PutQuality2(newStr);
 	}
+
+	m_qualityController.SetQuality(quality);
 }
 
 //---------------------------------------------------------------------
@@ -258,12 +481,21 @@ void CFlashDXPlayer::SetTransparencyMode(ETransparencyMode mode)
 		}
 	}
 
+	// Mask is rebuilt by the next draws
+	if (mode != m_transpMode)
+		m_hitMask.Clear();
+
 	m_transpMode = mode;
 }
 
 //---------------------------------------------------------------------
 bool CFlashDXPlayer::LoadMovie(const wchar_t* movie)
 {
+	CTraceSpan span(m_owner->GetTracer(), "LoadMovie", this);
+
+	CancelAsyncLoad();
+	ClearFrameCache();
+
 	if (m_flashInterface)
 	{
 		wchar_t fullpath[MAX_PATH];
@@ -274,6 +506,25 @@ bool CFlashDXPlayer::LoadMovie(const wchar_t* movie)
 		if (!PathFileExists(fullpath))
 			return false;
 
+		CSWFData movieHeader;
+		bool hasHeader = movieHeader.LoadHeaderFromFile(fullpath);
+
+		// Only inflated movies go through memory, others are loaded by path as usual
+		if (hasHeader && movieHeader.IsCompressed() && m_owner->GetMovieCache().IsEnabled())
+		{
+			CSWFData swf;
+			std::vector<BYTE> movieData;
+			if (swf.LoadFromFile(fullpath) &&
+				m_owner->GetMovieCache().GetDecompressedMovie(swf.GetData(), swf.GetSize(), movieData))
+			{
+				return LoadMovieFromMemory(&movieData[0], (unsigned int)movieData.size(), fullpath);
+			}
+		}
+
+		if (hasHeader)
+			UpdateMovieFrameRate(movieHeader);
+
+		m_flashInterface->put_Base(_bstr_t(L""));
 		HRESULT hr = m_flashInterface->put_Movie(_bstr_t(fullpath));
 		return SUCCEEDED(hr);
 	}
@@ -281,6 +532,200 @@ bool CFlashDXPlayer::LoadMovie(const wchar_t* movie)
 	return false;
 }
 
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::LoadMovie(const void* movieData, const unsigned int movieDataSize)
+{
+	CTraceSpan span(m_owner->GetTracer(), "LoadMovie", this);
+
+	CancelAsyncLoad();
+	ClearFrameCache();
+
+	if (m_flashInterface == NULL || movieData == NULL || movieDataSize == 0)
+		return false;
+
+	if (m_owner->GetMovieCache().IsEnabled())
+	{
+		std::vector<BYTE> decompressedData;
+		if (m_owner->GetMovieCache().GetDecompressedMovie((const BYTE*)movieData, movieDataSize, decompressedData))
+			return LoadMovieFromMemory(&decompressedData[0], (unsigned int)decompressedData.size());
+	}
+
+	return LoadMovieFromMemory((const BYTE*)movieData, movieDataSize);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::UpdateMovieFrameRate(CSWFData& movieHeader)
+{
+	IFlashDX::SMovieProperties props;
+	if (movieHeader.DecompressHeader() && CSWFAnalyzer::GetProperties(movieHeader.GetData(), movieHeader.GetSize(), props))
+		m_pacer.SetMovieFrameRate(props.m_fps);
+	else
+		m_pacer.SetMovieFrameRate(0);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::LoadMovieAsync(const wchar_t* movie)
+{
+	CancelAsyncLoad();
+	ClearFrameCache();
+
+	if (m_flashInterface == NULL)
+		return false;
+
+	wchar_t fullpath[MAX_PATH];
+
+	if(!_wfullpath(fullpath, movie, MAX_PATH))
+		return false;
+
+	if (!PathFileExists(fullpath))
+		return false;
+
+	m_movieLoader = new CMovieLoader(m_owner->GetMovieCache());
+	if (!m_movieLoader->Start(fullpath))
+	{
+		delete m_movieLoader;
+		m_movieLoader = NULL;
+		return false;
+	}
+
+	m_loadProgress = 0;
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsMovieLoading() const
+{
+	return m_movieLoader != NULL || m_waitingForMovie;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::UpdateAsyncLoad()
+{
+	if (m_movieLoader == NULL)
+		return;
+
+	unsigned int progress = m_movieLoader->GetProgress();
+	if (progress != m_loadProgress)
+	{
+		m_loadProgress = progress;
+		OnProgress(progress);
+	}
+
+	if (!m_movieLoader->IsDone())
+		return;
+
+	std::vector<BYTE> movie;
+	std::wstring path = m_movieLoader->GetPath();
+	bool result = m_movieLoader->IsSucceeded();
+	if (result)
+		movie.swap(m_movieLoader->GetMovie());
+
+	delete m_movieLoader;
+	m_movieLoader = NULL;
+
+	if (result)
+	{
+		// Flash may report the movie complete while loading it
+		m_waitingForMovie = true;
+		result = LoadMovieFromMemory(&movie[0], (unsigned int)movie.size(), path.c_str());
+	}
+
+	if (!result)
+	{
+		m_waitingForMovie = false;
+
+		for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+			m_eventHandlers[i]->OnMovieLoaded(false);
+	}
+	else if (m_waitingForMovie && m_flashInterface->GetReadyState() == 4)
+	{
+		FinishAsyncLoad();
+	}
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::FinishAsyncLoad()
+{
+	m_waitingForMovie = false;
+	AddDirtyRect(NULL);
+
+	for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+		m_eventHandlers[i]->OnMovieLoaded(true);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::CancelAsyncLoad()
+{
+	delete m_movieLoader;
+	m_movieLoader = NULL;
+
+	if (m_waitingForMovie)
+	{
+		m_waitingForMovie = false;
+		AddDirtyRect(NULL);
+	}
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::LoadMovieFromMemory(const BYTE* movieData, unsigned int movieDataSize, const wchar_t* moviePath)
+{
+	CTraceSpan span(m_owner->GetTracer(), "LoadMovieFromMemory", this);
+
+	// Movie loaded from memory has no URL, relative loads resolve against its file directory through Base
+	wchar_t base[MAX_PATH] = L"";
+	if (moviePath)
+	{
+		wcscpy_s(base, moviePath);
+		PathRemoveFileSpec(base);
+		PathAddBackslash(base);
+	}
+	m_flashInterface->put_Base(_bstr_t(base));
+
+	CSWFData movieHeader;
+	if (movieHeader.LoadHeaderFromMemory(movieData, movieDataSize))
+		UpdateMovieFrameRate(movieHeader);
+
+	IPersistStreamInit* pPersistStream = NULL;
+	m_flashInterface->QueryInterface(IID_IPersistStreamInit, (void**) &pPersistStream);
+	if (pPersistStream == NULL)
+		return false;
+
+	// Flash expects 'fUfU' signature and size of the movie in front of the movie data
+	HGLOBAL memory = GlobalAlloc(GMEM_MOVEABLE, movieDataSize + 8);
+	if (memory == NULL)
+	{
+		pPersistStream->Release();
+		return false;
+	}
+
+	DWORD* header = (DWORD*)GlobalLock(memory);
+	header[0] = 0x55665566;
+	header[1] = movieDataSize;
+	memcpy(header + 2, movieData, movieDataSize);
+	GlobalUnlock(memory);
+
+	IStream* pStream = NULL;
+	HRESULT hr = CreateStreamOnHGlobal(memory, TRUE, &pStream);
+	if (FAILED(hr))
+	{
+		GlobalFree(memory);
+		pPersistStream->Release();
+		return false;
+	}
+
+	hr = pPersistStream->InitNew();
+	if (SUCCEEDED(hr))
+		hr = pPersistStream->Load(pStream);
+
+	pStream->Release();
+	pPersistStream->Release();
+
+	// Restore window mode in case InitNew() has reset it
+	SetTransparencyMode(m_transpMode);
+
+	return SUCCEEDED(hr);
+}
+
 //---------------------------------------------------------------------
 COLORREF CFlashDXPlayer::GetBackgroundColor()
 {
@@ -300,6 +745,12 @@ void CFlashDXPlayer::SetBackgroundColor(COLORREF color)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::StartPlaying()
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_START_PLAYING);
+		m_recorder->WriteString(NULL);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->Play();
 }
@@ -307,6 +758,12 @@ void CFlashDXPlayer::StartPlaying()
 //---------------------------------------------------------------------
 void CFlashDXPlayer::StartPlaying(const wchar_t* timelineTarget)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_START_PLAYING);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TPlay(_bstr_t(timelineTarget));
 }
@@ -314,6 +771,12 @@ void CFlashDXPlayer::StartPlaying(const wchar_t* timelineTarget)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::StopPlaying()
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_STOP_PLAYING);
+		m_recorder->WriteString(NULL);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->StopPlay();
 }
@@ -321,6 +784,12 @@ void CFlashDXPlayer::StopPlaying()
 //---------------------------------------------------------------------
 void CFlashDXPlayer::StopPlaying(const wchar_t* timelineTarget)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_STOP_PLAYING);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TStopPlay(_bstr_t(timelineTarget));
 }
@@ -328,6 +797,11 @@ void CFlashDXPlayer::StopPlaying(const wchar_t* timelineTarget)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::Rewind()
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_REWIND);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->Rewind();
 }
@@ -335,6 +809,11 @@ void CFlashDXPlayer::Rewind()
 //---------------------------------------------------------------------
 void CFlashDXPlayer::StepForward()
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_STEP_FORWARD);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->Forward();
 }
@@ -342,6 +821,11 @@ void CFlashDXPlayer::StepForward()
 //---------------------------------------------------------------------
 void CFlashDXPlayer::StepBack()
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_STEP_BACK);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->Back();
 }
@@ -365,6 +849,13 @@ int CFlashDXPlayer::GetCurrentFrame(const wchar_t* timelineTarget /*= L"/"*/)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::GotoFrame(int frame)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_GOTO_FRAME);
+		m_recorder->WriteInt(frame);
+		m_recorder->WriteString(NULL);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->GotoFrame((long)frame);
 }
@@ -372,6 +863,13 @@ void CFlashDXPlayer::GotoFrame(int frame)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::GotoFrame(int frame, const wchar_t* timelineTarget)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_GOTO_FRAME);
+		m_recorder->WriteInt(frame);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TGotoFrame(_bstr_t(timelineTarget), (long)frame);
 }
@@ -379,6 +877,13 @@ void CFlashDXPlayer::GotoFrame(int frame, const wchar_t* timelineTarget)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::CallFrame(int frame, const wchar_t* timelineTarget /*= L"/"*/)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_CALL_FRAME);
+		m_recorder->WriteInt(frame);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TCallFrame(_bstr_t(timelineTarget), frame);
 }
@@ -397,6 +902,13 @@ const wchar_t* CFlashDXPlayer::GetCurrentLabel(const wchar_t* timelineTarget /*=
 //---------------------------------------------------------------------
 void CFlashDXPlayer::GotoLabel(const wchar_t* label, const wchar_t* timelineTarget /*= L"/"*/)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_GOTO_LABEL);
+		m_recorder->WriteString(label);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TGotoLabel(_bstr_t(timelineTarget), _bstr_t(label));
 }
@@ -404,6 +916,13 @@ void CFlashDXPlayer::GotoLabel(const wchar_t* label, const wchar_t* timelineTarg
 //---------------------------------------------------------------------
 void CFlashDXPlayer::CallLabel(const wchar_t* label, const wchar_t* timelineTarget /*= L"/"*/)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_CALL_LABEL);
+		m_recorder->WriteString(label);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TCallLabel(_bstr_t(timelineTarget), _bstr_t(label));
 }
@@ -422,6 +941,13 @@ const wchar_t* CFlashDXPlayer::GetVariable(const wchar_t* name)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::SetVariable(const wchar_t* name, const wchar_t* value)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_SET_VARIABLE);
+		m_recorder->WriteString(name);
+		m_recorder->WriteString(value);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->SetVariable(_bstr_t(name), _bstr_t(value));
 }
@@ -448,6 +974,14 @@ double CFlashDXPlayer::GetPropertyAsNumber(int iProperty, const wchar_t* timelin
 //---------------------------------------------------------------------
 void CFlashDXPlayer::SetProperty(int iProperty, const wchar_t* value, const wchar_t* timelineTarget /*= L"/"*/)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_SET_PROPERTY);
+		m_recorder->WriteInt(iProperty);
+		m_recorder->WriteString(value);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TSetProperty(_bstr_t(timelineTarget), iProperty, _bstr_t(value));
 }
@@ -455,6 +989,14 @@ void CFlashDXPlayer::SetProperty(int iProperty, const wchar_t* value, const wcha
 //---------------------------------------------------------------------
 void CFlashDXPlayer::SetProperty(int iProperty, double value, const wchar_t* timelineTarget /*= L"/"*/)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_SET_PROPERTY_NUMBER);
+		m_recorder->WriteInt(iProperty);
+		m_recorder->WriteDouble(value);
+		m_recorder->WriteString(timelineTarget);
+	}
+
 	if (m_flashInterface)
 		m_flashInterface->TSetPropertyNum(_bstr_t(timelineTarget), iProperty, value);
 }
@@ -462,86 +1004,330 @@ void CFlashDXPlayer::SetProperty(int iProperty, double value, const wchar_t* tim
 //---------------------------------------------------------------------
 void CFlashDXPlayer::ResizePlayer(unsigned int newWidth, unsigned int newHeight)
 {
+	m_logicalWidth = newWidth;
+	m_logicalHeight = newHeight;
+
+	// Flash scales the stage to the surface, so the movie just renders with less pixels
+	if (m_resolutionScale != 1.0f)
+	{
+		newWidth = max((unsigned int)(newWidth * m_resolutionScale + 0.5f), 1u);
+		newHeight = max((unsigned int)(newHeight * m_resolutionScale + 0.5f), 1u);
+	}
+
 	IOleInPlaceObject* pInPlaceObject = NULL;
 	m_oleObject->QueryInterface(__uuidof(IOleInPlaceObject), (LPVOID*) &pInPlaceObject);
 
 	if (pInPlaceObject != NULL)
 	{
-		RECT rect = { 0, 0, newWidth, newHeight };
-		pInPlaceObject->SetObjectRects(&rect, &rect);
-		pInPlaceObject->Release();
-
+		bool wasHidden = IsRectEmpty(&m_visibleRect) != FALSE;
 		m_width = newWidth;
 		m_height = newHeight;
+		UpdateVisibleRect();
 
-		AddDirtyRect(NULL);
-	}
+		if (m_dirtyRectTrace)
+			m_dirtyRectTrace->AddSurface(m_width, m_height);
 
-	if (m_alphaBlackDC)
-	{
-		DeleteDC(m_alphaBlackDC);
-		DeleteObject(m_alphaBlackBitmap);
-		DeleteDC(m_alphaWhiteDC);
-		DeleteObject(m_alphaWhiteBitmap);
+		// Pool buffers of the old size are no longer borrowed
+		m_renderScratchSize = 0;
+
+		RECT rect = { 0, 0, newWidth, newHeight };
+		pInPlaceObject->SetObjectRects(&rect, &m_visibleRect);
+		pInPlaceObject->Release();
 
-		m_alphaBlackDC = NULL;
-		m_alphaBlackBitmap = NULL;
-		m_alphaBlackBuffer = NULL;
-		m_alphaWhiteDC = NULL;
-		m_alphaWhiteBitmap = NULL;
-		m_alphaWhiteBuffer = NULL;
+		SetRectEmpty(&m_hiddenDirtyRect);
+		UpdateHiddenState(wasHidden);
+		AddDirtyRect(NULL);
 	}
 }
 
 //---------------------------------------------------------------------
-bool CFlashDXPlayer::IsNeedUpdate(const RECT** unitedDirtyRect, const RECT** dirtyRects, unsigned int* numDirtyRects)
+void CFlashDXPlayer::SetVisibleRect(const RECT* rect)
 {
-	if (m_dirtyFlag)
-	{
-		while (ReduceNumDirtyRects());
+	m_hasVisibleRect = rect != NULL;
+	if (rect)
+		m_logicalVisibleRect = *rect;
 
-		m_savedUnionRect = m_dirtyUnionRect;
-		m_savedDirtyRects.assign(m_dirtyRects.begin(), m_dirtyRects.end());
+	RECT oldVisibleRect = m_visibleRect;
+	UpdateVisibleRect();
+	if (EqualRect(&oldVisibleRect, &m_visibleRect))
+		return;
 
-		if (unitedDirtyRect)
-			*unitedDirtyRect = &m_savedUnionRect;
-		if (dirtyRects)
-			*dirtyRects = m_savedDirtyRects.size() ? &m_savedDirtyRects.front() : NULL;
-		if (numDirtyRects)
-			*numDirtyRects = (unsigned int)m_savedDirtyRects.size();
-	}
+	UpdateObjectRects();
 
-	return m_dirtyFlag;
+	UpdateHiddenState(IsRectEmpty(&oldVisibleRect) != FALSE);
+	if (m_suspended)
+		return;
+
+	// Draw changes made while the area was hidden
+	RECT revealedRect;
+	if (IntersectRect(&revealedRect, &m_hiddenDirtyRect, &m_visibleRect))
+	{
+		if (EqualRect(&revealedRect, &m_hiddenDirtyRect))
+			SetRectEmpty(&m_hiddenDirtyRect);
+		AddDirtyRect(&revealedRect);
+	}
 }
 
 //---------------------------------------------------------------------
-bool CFlashDXPlayer::ReduceNumDirtyRects()
+void CFlashDXPlayer::Suspend()
 {
-	for (std::vector<RECT>::iterator firstIt = m_dirtyRects.begin(); firstIt != m_dirtyRects.end(); ++firstIt)
+	if (m_suspended)
+		return;
+
+	// Flash is stopped directly, suspension is not a call the recorder should replay
+	m_resumePlaying = GetState() == STATE_PLAYING;
+	if (m_flashInterface)
+		m_flashInterface->StopPlay();
+
+	m_suspended = true;
+	m_dirtyFlag = false;
+	m_dirtyRects.Clear();
+
+	// Frame buffer of worker owned player is released by the worker, once the consumer returns it
+	if (m_worker == NULL)
 	{
-		for (std::vector<RECT>::iterator secondIt = m_dirtyRects.begin(); secondIt != m_dirtyRects.end(); ++secondIt)
-		{
-			if (firstIt == secondIt)
-				continue;
+		ReleaseFrameBuffer();
+		m_drawnStateKey.clear();
+		m_hitMask.Clear();
+	}
+}
 
-			RECT unionRect;
-			if (UnionRect(&unionRect, &(*firstIt), &(*secondIt)))
-			{
-				if (EqualRect(&unionRect, &(*firstIt)))
-				{
-					m_dirtyRects.erase(secondIt);
-					return true;
-				}
-				if (EqualRect(&unionRect, &(*secondIt)))
-				{
-					m_dirtyRects.erase(firstIt);
-					return true;
-				}
-			}
-		}
+//---------------------------------------------------------------------
+void CFlashDXPlayer::Resume()
+{
+	if (!m_suspended)
+		return;
+
+	m_suspended = false;
+	m_autoSuspended = false;
+
+	if (m_resumePlaying && m_flashInterface)
+		m_flashInterface->Play();
+
+	SetRectEmpty(&m_hiddenDirtyRect);
+	AddDirtyRect(NULL);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsSuspended() const
+{
+	return m_suspended;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetAutoSuspend(unsigned int delay)
+{
+	m_autoSuspendDelay = delay;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetFrameCache(unsigned int memoryLimit)
+{
+	m_frameCache.SetLimit(memoryLimit);
+
+	// Players drawn by the user keep their own buffer only for the cache
+	if (memoryLimit == 0 && m_worker == NULL)
+	{
+		ReleaseFrameBuffer();
+		m_drawnStateKey.clear();
 	}
+}
 
-	return false;
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetFrameCacheKey(const wchar_t* key)
+{
+	m_autoFrameCacheKey = key == NULL;
+	m_frameCacheKey = key ? key : L"";
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::GetFrameCacheStats(SFrameCacheStats& stats)
+{
+	m_frameCache.GetStats(stats);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::GetFrameCacheKey(std::wstring& key)
+{
+	if (!m_autoFrameCacheKey)
+	{
+		key = m_frameCacheKey;
+		return;
+	}
+
+	wchar_t frame[16];
+	swprintf_s(frame, L"%d:", (int)m_flashInterface->CurrentFrame());
+	key = frame;
+	key += m_flashInterface->TCurrentLabel(_bstr_t(L"/"));
+}
+
+//---------------------------------------------------------------------
+CRenderBufferPool::SBuffer* CFlashDXPlayer::UpdateFrameCache()
+{
+	std::wstring key;
+	GetFrameCacheKey(key);
+	if (key == m_drawnStateKey)
+		return NULL;
+
+	// Own buffer still holds the previous state. It is complete only if nothing was clipped away.
+	bool bufferComplete = m_frameBits != NULL && m_frameWidth == m_width && m_frameHeight == m_height &&
+		!m_hasVisibleRect && IsRectEmpty(&m_hiddenDirtyRect);
+	if (bufferComplete && !m_drawnStateKey.empty() && GetTickCount() - m_drawnStateTime >= s_minStaticStateTime &&
+		!m_frameCache.Contains(m_drawnStateKey, m_width, m_height))
+	{
+		GdiFlush();
+		m_frameCache.Store(m_drawnStateKey, m_frameBits, m_frameWidth * 4, m_width, m_height);
+	}
+
+	m_drawnStateKey = key;
+	m_drawnStateTime = GetTickCount();
+	if (key.empty())
+		return NULL;
+
+	// Cached image stands in for drawing only when the state change repaints the whole visible part.
+	// Smaller dirty rects come from changes within the state, which the cached image doesn't have.
+	const std::vector<RECT>& dirtyRects = m_dirtyRects.GetRects();
+	bool coversVisibleRect = false;
+	for (unsigned int i = 0; i < dirtyRects.size() && !coversVisibleRect; ++i)
+		coversVisibleRect = EqualRect(&dirtyRects[i], &m_visibleRect) != FALSE;
+	if (!coversVisibleRect)
+		return NULL;
+
+	CRenderBufferPool& bufferPool = m_owner->GetRenderBufferPool();
+	CRenderBufferPool::SBuffer* frame = bufferPool.Acquire(m_width, m_height);
+	if (frame != NULL && !m_frameCache.Restore(key, frame->m_bits, frame->m_width * 4, m_width, m_height))
+	{
+		bufferPool.Release(frame);
+		frame = NULL;
+	}
+	return frame;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::ClearFrameCache()
+{
+	m_frameCache.Clear();
+	m_drawnStateKey.clear();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::UpdateVisibleRect()
+{
+	RECT screenRect = { 0, 0, m_width, m_height };
+	if (!m_hasVisibleRect)
+	{
+		m_visibleRect = screenRect;
+		return;
+	}
+
+	// Round outwards, so scaled rect covers all visible pixels
+	RECT rect;
+	rect.left = (LONG)floor(m_logicalVisibleRect.left * m_resolutionScale);
+	rect.top = (LONG)floor(m_logicalVisibleRect.top * m_resolutionScale);
+	rect.right = (LONG)ceil(m_logicalVisibleRect.right * m_resolutionScale);
+	rect.bottom = (LONG)ceil(m_logicalVisibleRect.bottom * m_resolutionScale);
+
+	if (!IntersectRect(&m_visibleRect, &rect, &screenRect))
+		SetRectEmpty(&m_visibleRect);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::UpdateHiddenState(bool wasHidden)
+{
+	bool hidden = IsRectEmpty(&m_visibleRect) != FALSE;
+	if (hidden == wasHidden)
+		return;
+
+	// Auto suspension counts from the moment the player was hidden, by resize or by visible rect
+	if (hidden)
+		m_hiddenTime = GetTickCount();
+	else if (m_autoSuspended)
+		Resume();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::UpdateObjectRects()
+{
+	IOleInPlaceObject* pInPlaceObject = NULL;
+	m_oleObject->QueryInterface(__uuidof(IOleInPlaceObject), (LPVOID*) &pInPlaceObject);
+
+	if (pInPlaceObject != NULL)
+	{
+		RECT rect = { 0, 0, m_width, m_height };
+		pInPlaceObject->SetObjectRects(&rect, &m_visibleRect);
+		pInPlaceObject->Release();
+	}
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetResolutionScale(float scale)
+{
+	if (scale <= 0.0f || scale == m_resolutionScale)
+		return;
+
+	m_resolutionScale = scale;
+	ResizePlayer(m_logicalWidth, m_logicalHeight);
+}
+
+//---------------------------------------------------------------------
+float CFlashDXPlayer::GetResolutionScale() const
+{
+	return m_resolutionScale;
+}
+
+//---------------------------------------------------------------------
+unsigned int CFlashDXPlayer::GetSurfaceWidth() const
+{
+	return m_width;
+}
+
+//---------------------------------------------------------------------
+unsigned int CFlashDXPlayer::GetSurfaceHeight() const
+{
+	return m_height;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsNeedUpdate(const RECT** unitedDirtyRect, const RECT** dirtyRects, unsigned int* numDirtyRects)
+{
+	// Commands sent from other threads may change the frame, so they go first
+	m_commandProxy.Execute(this);
+
+	if (m_replayer && !m_replayer->Update(this))
+		StopReplay();
+
+	FlushInput();
+	UpdateAsyncLoad();
+
+	if (!m_suspended && m_autoSuspendDelay != INFINITE && IsRectEmpty(&m_visibleRect) &&
+		GetTickCount() - m_hiddenTime >= m_autoSuspendDelay)
+	{
+		Suspend();
+		m_autoSuspended = true;
+	}
+
+	// Dirty player waiting for its turn stays dirty
+	bool needUpdate = m_dirtyFlag && m_pacer.CanUpdate();
+
+	if (needUpdate)
+	{
+		m_dirtyRects.Reduce();
+
+		m_savedUnionRect = m_dirtyRects.GetUnionRect();
+		m_savedDirtyRects.assign(m_dirtyRects.GetRects().begin(), m_dirtyRects.GetRects().end());
+
+		if (m_dirtyRectTrace)
+			m_dirtyRectTrace->AddUpdate((unsigned int)m_savedDirtyRects.size());
+
+		if (unitedDirtyRect)
+			*unitedDirtyRect = &m_savedUnionRect;
+		if (dirtyRects)
+			*dirtyRects = m_savedDirtyRects.size() ? &m_savedDirtyRects.front() : NULL;
+		if (numDirtyRects)
+			*numDirtyRects = (unsigned int)m_savedDirtyRects.size();
+	}
+
+	return needUpdate;
 }
 
 //---------------------------------------------------------------------
@@ -549,17 +1335,36 @@ void CFlashDXPlayer::DrawFrame(HDC dc)
 {
 	if (m_dirtyFlag)
 	{
+		CTraceSpan span(m_owner->GetTracer(), "DrawFrame", this);
+
+		double startTime = GetTimeMs();
+
+		// With the frame cache on, the player draws into its own buffer and copies the changes to the target,
+		// so the shown state can be stored without reading the target back
+		HDC targetDC = dc;
+		if (m_frameCache.IsEnabled() && dc != m_frameDC && PrepareFrameBuffer())
+			dc = m_frameDC;
+
+		// Revisited static screen is copied from the frame cache instead of being drawn
+		CRenderBufferPool::SBuffer* cachedFrame = NULL;
+		if (m_frameCache.IsEnabled())
+			cachedFrame = UpdateFrameCache();
+		m_renderScratchSize = max(m_renderScratchSize, CRenderBufferPool::GetBufferSize(cachedFrame));
+
 		IViewObject* pViewObject = NULL;
 		m_flashInterface->QueryInterface(IID_IViewObject, (LPVOID*) &pViewObject);
 		if (pViewObject != NULL)
 		{
+			DRAW_TIMING_START();
+
 			// Combine regions
+			const std::vector<RECT>& dirtyRects = m_dirtyRects.GetRects();
 			HRGN unionRgn, first, second = NULL;
-			unionRgn = CreateRectRgnIndirect(&m_dirtyRects[0]);
-			if (m_dirtyRects.size() >= 2)
+			unionRgn = CreateRectRgnIndirect(&dirtyRects[0]);
+			if (dirtyRects.size() >= 2)
 				second = CreateRectRgn(0, 0, 1, 1);
 
-			for (std::vector<RECT>::iterator it = m_dirtyRects.begin() + 1; it != m_dirtyRects.end(); ++it)
+			for (std::vector<RECT>::const_iterator it = dirtyRects.begin() + 1; it != dirtyRects.end(); ++it)
 			{
 				// Fill combined region
 				first = unionRgn;
@@ -575,9 +1380,22 @@ void CFlashDXPlayer::DrawFrame(HDC dc)
 
 			RECT clipRgnRect; GetRgnBox(unionRgn, &clipRgnRect);
 			RECTL clipRect = { 0, 0, m_width, m_height };
+			DRAW_TIMING_STAGE(DRAW_STAGE_CLIP_REGION);
 
+			if (cachedFrame != NULL)
+			{
+				SelectClipRgn(dc, unionRgn);
+				BitBlt(dc, clipRgnRect.left, clipRgnRect.top,
+					   clipRgnRect.right - clipRgnRect.left,
+					   clipRgnRect.bottom - clipRgnRect.top,
+					   cachedFrame->m_dc, clipRgnRect.left, clipRgnRect.top, SRCCOPY);
+				DRAW_TIMING_STAGE(DRAW_STAGE_BLIT);
+
+				if (m_transpMode == TMODE_FULL_ALPHA)
+					UpdateHitMask(cachedFrame->m_bits, cachedFrame->m_width * 4);
+			}
 			// Fill background
-			if (m_transpMode != TMODE_FULL_ALPHA)
+			else if (m_transpMode != TMODE_FULL_ALPHA)
 			{
 				// Set clip region
 				SelectClipRgn(dc, unionRgn);
@@ -586,86 +1404,114 @@ void CFlashDXPlayer::DrawFrame(HDC dc)
 				HBRUSH fillColorBrush = CreateSolidBrush(fillColor);
 				FillRgn(dc, unionRgn, fillColorBrush);
 				DeleteObject(fillColorBrush);
+				DRAW_TIMING_STAGE(DRAW_STAGE_BACKGROUND);
 
 				// Draw to main buffer
 				HRESULT hr = pViewObject->Draw(DVASPECT_TRANSPARENT, 1, NULL, NULL, NULL, dc, &clipRect, &clipRect, NULL, 0);
 				assert(SUCCEEDED(hr));
+				DRAW_TIMING_STAGE(DRAW_STAGE_RENDER);
 			}
 			else
 			{
-				if (m_alphaBlackDC == NULL)
+				// Alpha restore buffers are borrowed for this draw only
+				CRenderBufferPool& bufferPool = m_owner->GetRenderBufferPool();
+				CRenderBufferPool::SBuffer* alphaBlack = bufferPool.Acquire(m_width, m_height);
+				CRenderBufferPool::SBuffer* alphaWhite = bufferPool.Acquire(m_width, m_height);
+				m_renderScratchSize = max(m_renderScratchSize, CRenderBufferPool::GetBufferSize(cachedFrame) +
+					CRenderBufferPool::GetBufferSize(alphaBlack) + CRenderBufferPool::GetBufferSize(alphaWhite));
+				if (alphaBlack != NULL && alphaWhite != NULL)
 				{
-					// Create memory buffers
-					BITMAPINFOHEADER bih = {0};
-					bih.biSize = sizeof(BITMAPINFOHEADER);
-					bih.biBitCount = 32;
-					bih.biCompression = BI_RGB;
-					bih.biPlanes = 1;
-					bih.biWidth = LONG(m_width);
-					bih.biHeight = -LONG(m_height);
-
-					m_alphaBlackDC = CreateCompatibleDC(dc);
-					m_alphaBlackBitmap = CreateDIBSection(m_alphaBlackDC, (BITMAPINFO*)&bih, DIB_RGB_COLORS, (void**)&m_alphaBlackBuffer, 0, 0);
-					SelectObject(m_alphaBlackDC, m_alphaBlackBitmap);
-
-					m_alphaWhiteDC = CreateCompatibleDC(dc);
-					m_alphaWhiteBitmap = CreateDIBSection(m_alphaWhiteDC, (BITMAPINFO*)&bih, DIB_RGB_COLORS, (void**)&m_alphaWhiteBuffer, 0, 0);
-					SelectObject(m_alphaWhiteDC, m_alphaWhiteBitmap);
+					HRESULT hr;
+					HBRUSH fillColorBrush;
+
+					// Render frame twice - against white and against black background to calculate alpha
+					SelectClipRgn(alphaBlack->m_dc, unionRgn);
+
+					COLORREF blackColor = 0x00000000;
+					fillColorBrush = CreateSolidBrush(blackColor);
+					FillRgn(alphaBlack->m_dc, unionRgn, fillColorBrush);
+					DeleteObject(fillColorBrush);
+					DRAW_TIMING_STAGE(DRAW_STAGE_BACKGROUND);
+
+					hr = pViewObject->Draw(DVASPECT_TRANSPARENT, 1, NULL, NULL, NULL, alphaBlack->m_dc, &clipRect, &clipRect, NULL, 0);
+					assert(SUCCEEDED(hr));
+					DRAW_TIMING_STAGE(DRAW_STAGE_RENDER);
+
+					// White background
+					SelectClipRgn(alphaWhite->m_dc, unionRgn);
+
+					COLORREF whiteColor = 0x00FFFFFF;
+					fillColorBrush = CreateSolidBrush(whiteColor);
+					FillRgn(alphaWhite->m_dc, unionRgn, fillColorBrush);
+					DeleteObject(fillColorBrush);
+					DRAW_TIMING_STAGE(DRAW_STAGE_BACKGROUND);
+
+					hr = pViewObject->Draw(DVASPECT_TRANSPARENT, 1, NULL, NULL, NULL, alphaWhite->m_dc, &clipRect, &clipRect, NULL, 0);
+					assert(SUCCEEDED(hr));
+
+					// Make sure GDI finished with the buffers before reading them
+					GdiFlush();
+					DRAW_TIMING_STAGE(DRAW_STAGE_RENDER_WHITE);
+
+					// Combine alpha. Pooled buffers hold garbage outside of the dirty rects and may be wider than the player.
+					BYTE* alphaBlackBuffer = alphaBlack->m_bits;
+					BYTE* alphaWhiteBuffer = alphaWhite->m_bits;
+					for (std::vector<RECT>::const_iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it)
+						CombineAlpha(alphaBlackBuffer, alphaBlack->m_width * 4, alphaWhiteBuffer, alphaWhite->m_width * 4, *it);
+
+					UpdateHitMask(alphaBlackBuffer, alphaBlack->m_width * 4);
+					DRAW_TIMING_STAGE(DRAW_STAGE_ALPHA_COMBINE);
+
+					// Blit result to target DC
+					SelectClipRgn(dc, unionRgn);
+					BitBlt(dc, clipRgnRect.left, clipRgnRect.top,
+						   clipRgnRect.right - clipRgnRect.left,
+						   clipRgnRect.bottom - clipRgnRect.top,
+						   alphaBlack->m_dc, clipRgnRect.left, clipRgnRect.top, SRCCOPY);
+					DRAW_TIMING_STAGE(DRAW_STAGE_BLIT);
 				}
 
-				HRESULT hr;
-				HBRUSH fillColorBrush;
-
-				// Render frame twice - against white and against black background to calculate alpha
-				SelectClipRgn(m_alphaBlackDC, unionRgn);
-
-				COLORREF blackColor = 0x00000000;
-				fillColorBrush = CreateSolidBrush(blackColor);
-				FillRgn(m_alphaBlackDC, unionRgn, fillColorBrush);
-				DeleteObject(fillColorBrush);
-
-				hr = pViewObject->Draw(DVASPECT_TRANSPARENT, 1, NULL, NULL, NULL, m_alphaBlackDC, &clipRect, &clipRect, NULL, 0);
-				assert(SUCCEEDED(hr));
-
-				// White background
-				SelectClipRgn(m_alphaWhiteDC, unionRgn);
-
-				COLORREF whiteColor = 0x00FFFFFF;
-				fillColorBrush = CreateSolidBrush(whiteColor);
-				FillRgn(m_alphaWhiteDC, unionRgn, fillColorBrush);
-				DeleteObject(fillColorBrush);
-
-				hr = pViewObject->Draw(DVASPECT_TRANSPARENT, 1, NULL, NULL, NULL, m_alphaWhiteDC, &clipRect, &clipRect, NULL, 0);
-				assert(SUCCEEDED(hr));
-
-				// Combine alpha
-				for (LONG y = clipRgnRect.top; y < clipRgnRect.bottom; ++y)
-				{
-					int offset = y * m_width * 4 + clipRgnRect.left * 4;
-					for (LONG x = clipRgnRect.left; x < clipRgnRect.right; ++x)
-					{
-						BYTE blackRed = m_alphaBlackBuffer[offset];
-						BYTE whiteRed = m_alphaWhiteBuffer[offset];
-						m_alphaBlackBuffer[offset + 3] = 255 - (whiteRed - blackRed);
-						offset += 4;
-					}
-				}
+				bufferPool.Release(alphaBlack);
+				bufferPool.Release(alphaWhite);
+			}
 
-				// Blit result to target DC
-				BitBlt(dc, clipRgnRect.left, clipRgnRect.top,
+			if (dc != targetDC)
+			{
+				SelectClipRgn(targetDC, unionRgn);
+				BitBlt(targetDC, clipRgnRect.left, clipRgnRect.top,
 					   clipRgnRect.right - clipRgnRect.left,
 					   clipRgnRect.bottom - clipRgnRect.top,
-					   m_alphaBlackDC, clipRgnRect.left, clipRgnRect.top, SRCCOPY);
+					   dc, clipRgnRect.left, clipRgnRect.top, SRCCOPY);
+				DRAW_TIMING_STAGE(DRAW_STAGE_BLIT);
 			}
 
 			DeleteObject(unionRgn);
 			pViewObject->Release();
 		}
 
+		m_owner->GetRenderBufferPool().Release(cachedFrame);
+
+		++m_counters.m_numFrames;
+		const std::vector<RECT>& dirtyRects = m_dirtyRects.GetRects();
+		m_counters.m_numDrawnRects += (unsigned int)dirtyRects.size();
+		for (std::vector<RECT>::const_iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it)
+			m_counters.m_drawnPixels += GetRectArea(*it);
+
 		m_dirtyFlag = false;
-		m_dirtyRects.clear();
-		m_dirtyUnionRect.left = m_dirtyUnionRect.top = LONG_MAX;
-		m_dirtyUnionRect.right = m_dirtyUnionRect.bottom = -LONG_MAX;
+		m_dirtyRects.Clear();
+
+		m_pacer.OnUpdate();
+
+		float drawTime = float(GetTimeMs() - startTime);
+#ifdef FLASHDX_DRAW_TIMING
+		m_drawTimings.EndFrame(drawTime);
+#endif
+		if (m_dirtyRectTrace)
+			m_dirtyRectTrace->AddDraw(drawTime);
+
+		EQuality newQuality;
+		if (m_qualityController.AddDrawTime(drawTime, newQuality))
+			SetQuality(newQuality);
 	}
 }
 
@@ -673,15 +1519,392 @@ void CFlashDXPlayer::DrawFrame(HDC dc)
 WPARAM CFlashDXPlayer::CreateMouseWParam(WPARAM highWord)
 {
 	WPARAM result = highWord;
-	result |= GetAsyncKeyState(VK_CONTROL) ? MK_CONTROL : 0;
-	result |= GetAsyncKeyState(VK_SHIFT) ? MK_SHIFT : 0;
+	result |= m_modifierKeys;
 	result |= m_lastMouseButtons;
 	return result;
 }
 
+//---------------------------------------------------------------------
+HANDLE CFlashDXPlayer::GetDirtyEvent()
+{
+	return m_dirtyEvent;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetDirtyCallback(void (*callback)(IFlashDXPlayer* pPlayer, void* context), void* context)
+{
+	m_dirtyCallback = callback;
+	m_dirtyCallbackContext = context;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetFramePacing(float maxRate, bool useMovieFrameRate)
+{
+	m_pacer.SetLimits(maxRate, useMovieFrameRate);
+}
+
+//---------------------------------------------------------------------
+unsigned int CFlashDXPlayer::GetTimeToNextUpdate()
+{
+	// Buffered input is delivered by the next update
+	if (!m_inputQueue.IsEmpty())
+		return 0;
+
+	unsigned int timeToNextUpdate = m_dirtyFlag ? m_pacer.GetTimeToNextUpdate() : INFINITE;
+	if (m_replayer)
+		timeToNextUpdate = min(timeToNextUpdate, m_replayer->GetTimeToNextCall());
+
+	return timeToNextUpdate;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::GetPacingStats(SPacingStats& stats)
+{
+	m_pacer.GetStats(stats);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::ResetPacingStats()
+{
+	m_pacer.ResetStats();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetAdaptiveQuality(float drawBudget, EQuality minQuality, EQuality maxQuality)
+{
+	m_qualityController.SetBudget(drawBudget, minQuality, maxQuality, GetQuality());
+}
+
+//---------------------------------------------------------------------
+float CFlashDXPlayer::GetAverageDrawTime() const
+{
+	return m_qualityController.GetAverageDrawTime();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetCritical(bool critical)
+{
+	m_critical = critical;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsCritical() const
+{
+	return m_critical;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::GetDrawTimings(SDrawTimings& timings)
+{
+#ifdef FLASHDX_DRAW_TIMING
+	m_drawTimings.GetStats(timings);
+	return true;
+#else
+	memset(&timings, 0, sizeof(timings));
+	return false;
+#endif
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::ResetDrawTimings()
+{
+#ifdef FLASHDX_DRAW_TIMING
+	m_drawTimings.Reset();
+#endif
+}
+
 //---------------------------------------------------------------------
 void CFlashDXPlayer::SetMousePos(unsigned int x, unsigned int y)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_MOUSE_MOVE);
+		m_recorder->WriteInt(x);
+		m_recorder->WriteInt(y);
+	}
+
+	++m_counters.m_numInputEvents;
+	if (m_bufferInput)
+	{
+		m_inputQueue.AddMouseMove(x, y);
+		++m_numQueuedInput;
+	}
+	else
+		DeliverMouseMove(x, y);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetMouseButtonState(unsigned int x, unsigned int y, EMouseButton button, bool pressed)
+{
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_MOUSE_BUTTON);
+		m_recorder->WriteInt(x);
+		m_recorder->WriteInt(y);
+		m_recorder->WriteInt(button);
+		m_recorder->WriteInt(pressed);
+	}
+
+	++m_counters.m_numInputEvents;
+	if (m_bufferInput)
+	{
+		m_inputQueue.AddMouseButton(x, y, button, pressed);
+		++m_numQueuedInput;
+	}
+	else
+		DeliverMouseButton(x, y, button, pressed);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SendMouseWheel(int delta)
+{
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_MOUSE_WHEEL);
+		m_recorder->WriteInt(delta);
+	}
+
+	++m_counters.m_numInputEvents;
+	if (m_bufferInput)
+	{
+		m_inputQueue.AddMouseWheel(delta);
+		++m_numQueuedInput;
+	}
+	else
+		DeliverMouseWheel(delta);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SendKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended)
+{
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_KEY);
+		m_recorder->WriteInt(pressed);
+		m_recorder->WriteInt((int)virtualKey);
+		m_recorder->WriteInt((int)extended);
+	}
+
+	++m_counters.m_numInputEvents;
+	if (m_bufferInput)
+	{
+		m_inputQueue.AddKey(pressed, virtualKey, extended);
+		++m_numQueuedInput;
+	}
+	else
+		DeliverKey(pressed, virtualKey, extended);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SendChar(UINT_PTR character, LONG_PTR extended)
+{
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_CHAR);
+		m_recorder->WriteInt((int)character);
+		m_recorder->WriteInt((int)extended);
+	}
+
+	++m_counters.m_numInputEvents;
+	if (m_bufferInput)
+	{
+		m_inputQueue.AddChar(character, extended);
+		++m_numQueuedInput;
+	}
+	else
+		DeliverChar(character, extended);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetInputBuffering(bool enable)
+{
+	if (!enable)
+		FlushInput();
+	m_bufferInput = enable;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::FlushInput()
+{
+	if (m_inputQueue.IsEmpty())
+		return;
+
+	m_inputQueue.TakeEvents(m_inputEvents);
+
+	// Moves and wheel deltas merged in the queue
+	m_counters.m_numDroppedInput += m_numQueuedInput - (unsigned int)m_inputEvents.size();
+	m_numQueuedInput = 0;
+
+	for (size_t i = 0; i < m_inputEvents.size(); ++i)
+	{
+		const CInputQueue::SEvent& event = m_inputEvents[i];
+		switch (event.m_type)
+		{
+		case CInputQueue::MOUSE_MOVE:
+			DeliverMouseMove(event.m_x, event.m_y);
+			break;
+		case CInputQueue::MOUSE_BUTTON:
+			DeliverMouseButton(event.m_x, event.m_y, event.m_button, event.m_pressed);
+			break;
+		case CInputQueue::MOUSE_WHEEL:
+			DeliverMouseWheel(event.m_delta);
+			break;
+		case CInputQueue::KEY:
+			DeliverKey(event.m_pressed, event.m_key, event.m_extended);
+			break;
+		case CInputQueue::CHAR:
+			DeliverChar(event.m_key, event.m_extended);
+			break;
+		}
+	}
+
+	m_inputEvents.clear();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::SetHitTest(unsigned char alphaThreshold, bool filterInput)
+{
+	m_hitTestInput = filterInput && alphaThreshold != 0;
+	m_mouseOverOpaque = true;
+
+	if (alphaThreshold != m_hitTestThreshold)
+	{
+		m_hitTestThreshold = alphaThreshold;
+		m_hitMask.Clear();
+
+		// Redraw everything to fill the mask
+		if (alphaThreshold != 0)
+			AddDirtyRect(NULL);
+	}
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsOpaqueAt(unsigned int x, unsigned int y) const
+{
+	return IsSurfaceOpaqueAt((unsigned int)(x * m_resolutionScale), (unsigned int)(y * m_resolutionScale));
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsSurfaceOpaqueAt(unsigned int x, unsigned int y) const
+{
+	if (x >= m_width || y >= m_height)
+		return false;
+
+	// Parts not drawn since the mask was reset count as opaque
+	if (m_hitTestThreshold == 0 || m_transpMode != TMODE_FULL_ALPHA ||
+		m_hitMask.GetWidth() != m_width || m_hitMask.GetHeight() != m_height)
+	{
+		return true;
+	}
+
+	return m_hitMask.IsOpaque(x, y);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::UpdateHitMask(const BYTE* bits, unsigned int pitch)
+{
+	if (m_hitTestThreshold == 0)
+		return;
+
+	if (m_hitMask.GetWidth() != m_width || m_hitMask.GetHeight() != m_height)
+		m_hitMask.Resize(m_width, m_height);
+
+	const std::vector<RECT>& dirtyRects = m_dirtyRects.GetRects();
+	for (std::vector<RECT>::const_iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it)
+		m_hitMask.Update(bits, pitch, *it, m_hitTestThreshold);
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::StartRecording(const wchar_t* path)
+{
+	StopRecording();
+
+	m_recorder = new CCallRecorder();
+	if (!m_recorder->Start(path))
+	{
+		StopRecording();
+		return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::StopRecording()
+{
+	delete m_recorder;
+	m_recorder = NULL;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::StartReplay(const wchar_t* path)
+{
+	StopReplay();
+
+	m_replayer = new CCallReplayer();
+	if (!m_replayer->Start(path))
+	{
+		StopReplay();
+		return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::StopReplay()
+{
+	delete m_replayer;
+	m_replayer = NULL;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::IsReplaying() const
+{
+	return m_replayer != NULL;
+}
+
+//---------------------------------------------------------------------
+bool CFlashDXPlayer::StartDirtyRectTrace(const wchar_t* path)
+{
+	StopDirtyRectTrace();
+
+	m_dirtyRectTrace = new CDirtyRectTraceWriter();
+	if (!m_dirtyRectTrace->Start(path))
+	{
+		StopDirtyRectTrace();
+		return false;
+	}
+
+	m_dirtyRectTrace->AddSurface(m_width, m_height);
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::StopDirtyRectTrace()
+{
+	delete m_dirtyRectTrace;
+	m_dirtyRectTrace = NULL;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::DeliverMouseMove(unsigned int x, unsigned int y)
+{
+	CTraceSpan span(m_owner->GetTracer(), "DeliverMouseMove", this);
+
+	x = (unsigned int)(x * m_resolutionScale);
+	y = (unsigned int)(y * m_resolutionScale);
+
+	// Only the move leaving opaque area goes through, so Flash can roll out. Drags are never filtered.
+	if (m_hitTestInput && m_lastMouseButtons == 0)
+	{
+		bool wasOverOpaque = m_mouseOverOpaque;
+		m_mouseOverOpaque = IsSurfaceOpaqueAt(x, y);
+		if (!m_mouseOverOpaque && !wasOverOpaque)
+		{
+			++m_counters.m_numDroppedInput;
+			return;
+		}
+	}
+
 	LRESULT lr;
 	m_windowlessObject->OnWindowMessage(WM_MOUSEMOVE, CreateMouseWParam(0), MAKELPARAM(x, y), &lr);
 	m_lastMouseX = x;
@@ -689,8 +1912,20 @@ void CFlashDXPlayer::SetMousePos(unsigned int x, unsigned int y)
 }
 
 //---------------------------------------------------------------------
-void CFlashDXPlayer::SetMouseButtonState(unsigned int x, unsigned int y, EMouseButton button, bool pressed)
+void CFlashDXPlayer::DeliverMouseButton(unsigned int x, unsigned int y, EMouseButton button, bool pressed)
 {
+	CTraceSpan span(m_owner->GetTracer(), "DeliverMouseButton", this);
+
+	x = (unsigned int)(x * m_resolutionScale);
+	y = (unsigned int)(y * m_resolutionScale);
+
+	// Releases are sent only for presses Flash has seen
+	if (m_hitTestInput && m_lastMouseButtons == 0 && (!pressed || !IsSurfaceOpaqueAt(x, y)))
+	{
+		++m_counters.m_numDroppedInput;
+		return;
+	}
+
 	m_lastMouseX = x;
 	m_lastMouseY = y;
 
@@ -739,15 +1974,37 @@ void CFlashDXPlayer::SetMouseButtonState(unsigned int x, unsigned int y, EMouseB
 }
 
 //---------------------------------------------------------------------
-void CFlashDXPlayer::SendMouseWheel(int delta)
+void CFlashDXPlayer::DeliverMouseWheel(int delta)
 {
+	CTraceSpan span(m_owner->GetTracer(), "DeliverMouseWheel", this);
+
+	if (m_hitTestInput && m_lastMouseButtons == 0 && !m_mouseOverOpaque)
+	{
+		++m_counters.m_numDroppedInput;
+		return;
+	}
+
 	LRESULT lr;
 	m_windowlessObject->OnWindowMessage(WM_MOUSEWHEEL, CreateMouseWParam(MAKEWPARAM(0, delta)), MAKELPARAM(m_lastMouseX, m_lastMouseY), &lr);
 }
 
 //---------------------------------------------------------------------
-void CFlashDXPlayer::SendKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended)
+void CFlashDXPlayer::DeliverKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended)
 {
+	CTraceSpan span(m_owner->GetTracer(), "DeliverKey", this);
+
+	// Modifiers for mouse messages, cheaper than asking the system on every mouse event
+	WPARAM modifier = 0;
+	if (virtualKey == VK_CONTROL || virtualKey == VK_LCONTROL || virtualKey == VK_RCONTROL)
+		modifier = MK_CONTROL;
+	else if (virtualKey == VK_SHIFT || virtualKey == VK_LSHIFT || virtualKey == VK_RSHIFT)
+		modifier = MK_SHIFT;
+
+	if (pressed)
+		m_modifierKeys |= modifier;
+	else
+		m_modifierKeys &= ~modifier;
+
 	LRESULT lr;
 	if (pressed)
 		m_windowlessObject->OnWindowMessage(WM_KEYDOWN, (WPARAM)virtualKey, (LPARAM)extended, &lr);
@@ -756,12 +2013,97 @@ void CFlashDXPlayer::SendKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extende
 }
 
 //---------------------------------------------------------------------
-void CFlashDXPlayer::SendChar(UINT_PTR character, LONG_PTR extended)
+void CFlashDXPlayer::DeliverChar(UINT_PTR character, LONG_PTR extended)
 {
+	CTraceSpan span(m_owner->GetTracer(), "DeliverChar", this);
+
 	LRESULT lr;
 	m_windowlessObject->OnWindowMessage(WM_CHAR, (WPARAM)character, (LPARAM)extended, &lr);
 }
 
+//---------------------------------------------------------------------
+void CFlashDXPlayer::GetCounters(SCounters& counters)
+{
+	counters = m_counters;
+}
+
+//---------------------------------------------------------------------
+unsigned int CFlashDXPlayer::GetFlashCallCounters(SFlashCallCounter* counters, unsigned int maxCounters)
+{
+	unsigned int index = 0;
+	for (std::map<std::wstring, unsigned int>::const_iterator it = m_flashCallCounts.begin();
+		 it != m_flashCallCounts.end() && counters != NULL && index < maxCounters; ++it, ++index)
+	{
+		counters[index].m_name = it->first.c_str();
+		counters[index].m_numCalls = it->second;
+	}
+
+	return (unsigned int)m_flashCallCounts.size();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::ResetCounters()
+{
+	memset(&m_counters, 0, sizeof(m_counters));
+	m_flashCallCounts.clear();
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::GetMemoryUsage(SMemoryUsage& usage)
+{
+	memset(&usage, 0, sizeof(usage));
+
+	if (m_frameBits != NULL)
+		usage.m_frameBuffer = m_frameWidth * m_frameHeight * 4;
+	usage.m_renderScratch = m_renderScratchSize;
+	usage.m_dirtyRects = m_dirtyRects.GetMemoryUsage() + (unsigned int)(m_savedDirtyRects.capacity() * sizeof(RECT));
+	usage.m_strings = GetStringSize(m_invokeString) + GetStringSize(m_tempStorage) +
+		GetStringSize(m_frameCacheKey) + GetStringSize(m_drawnStateKey);
+
+	usage.m_eventHandlers = (unsigned int)(m_eventHandlers.capacity() * sizeof(IFlashDXEventHandler*));
+	for (std::vector<IFlashDXEventHandler*>::const_iterator it = m_eventHandlers.begin(); it != m_eventHandlers.end(); ++it)
+		usage.m_eventHandlers += (*it)->GetMemoryUsage();
+
+	SFrameCacheStats frameCacheStats;
+	m_frameCache.GetStats(frameCacheStats);
+	usage.m_frameCache = frameCacheStats.m_memoryUsage;
+
+	// Loader thread owns the movie until it is done
+	if (m_movieLoader != NULL && m_movieLoader->IsSucceeded())
+		usage.m_movie = (unsigned int)m_movieLoader->GetMovie().capacity();
+
+	usage.m_hitMask = m_hitMask.GetMemoryUsage();
+	usage.m_input = m_inputQueue.GetMemoryUsage() + (unsigned int)(m_inputEvents.capacity() * sizeof(CInputQueue::SEvent));
+
+	usage.m_other = sizeof(*this);
+	for (std::map<std::wstring, unsigned int>::const_iterator it = m_flashCallCounts.begin(); it != m_flashCallCounts.end(); ++it)
+		usage.m_other += SMemoryUsage::GetTreeNodeSize<std::map<std::wstring, unsigned int>::value_type>() + GetStringSize(it->first);
+
+	usage.m_total = usage.m_frameBuffer + usage.m_dirtyRects + usage.m_strings + usage.m_eventHandlers + usage.m_frameCache +
+		usage.m_movie + usage.m_hitMask + usage.m_input + usage.m_other;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::CountFlashCall(const wchar_t* request)
+{
+	// Request is <invoke name="function" returntype="xml">...</invoke>, attribute may be single quoted
+	static const wchar_t s_nameAttribute[] = L"name=";
+	const wchar_t* name = wcsstr(request, s_nameAttribute);
+	if (name == NULL)
+		return;
+
+	name += sizeof(s_nameAttribute) / sizeof(wchar_t) - 1;
+	wchar_t quote = *name++;
+	if (quote != L'"' && quote != L'\'')
+		return;
+
+	const wchar_t* nameEnd = wcschr(name, quote);
+	if (nameEnd == NULL)
+		return;
+
+	++m_flashCallCounts[std::wstring(name, nameEnd)];
+}
+
 //---------------------------------------------------------------------
 void CFlashDXPlayer::EnableSound(bool enable)
 {
@@ -771,11 +2113,21 @@ void CFlashDXPlayer::EnableSound(bool enable)
 //---------------------------------------------------------------------
 const wchar_t* CFlashDXPlayer::CallFunction(const wchar_t* request)
 {
+	if (m_recorder)
+	{
+		m_recorder->BeginCall(CALL_CALL_FUNCTION);
+		m_recorder->WriteString(request);
+	}
+
+	CTraceSpan span(m_owner->GetTracer(), "CallFunction", this);
+	m_counters.m_bytesSent += wcslen(request) * sizeof(wchar_t);
+
 	BSTR response = NULL;
 	HRESULT hr = m_flashInterface->raw_CallFunction(_bstr_t(request), &response);
 
 	if (response)
 	{
+		m_counters.m_bytesReceived += SysStringByteLen(response);
 		m_tempStorage = response;
 		return m_tempStorage.c_str();
 	}
@@ -786,6 +2138,8 @@ const wchar_t* CFlashDXPlayer::CallFunction(const wchar_t* request)
 //---------------------------------------------------------------------
 void CFlashDXPlayer::SetReturnValue(const wchar_t* returnValue)
 {
+	if (returnValue)
+		m_counters.m_bytesSent += wcslen(returnValue) * sizeof(wchar_t);
 	m_flashInterface->SetReturnValue(returnValue);
 }
 
@@ -817,9 +2171,21 @@ unsigned int CFlashDXPlayer::GetNumEventHandlers() const
 	return (unsigned int)m_eventHandlers.size();
 }
 
+//---------------------------------------------------------------------
+struct IFlashDXPlayerProxy* CFlashDXPlayer::GetCommandProxy()
+{
+	return &m_commandProxy;
+}
+
 //---------------------------------------------------------------------
 HRESULT CFlashDXPlayer::FlashCall(const wchar_t* request)
 {
+	CTraceSpan span(m_owner->GetTracer(), "FlashCall", this);
+
+	++m_counters.m_numFlashCalls;
+	m_counters.m_bytesReceived += wcslen(request) * sizeof(wchar_t);
+	CountFlashCall(request);
+
 	for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
 	{
 		HRESULT result = m_eventHandlers[i]->FlashCall(request);
@@ -831,10 +2197,31 @@ HRESULT CFlashDXPlayer::FlashCall(const wchar_t* request)
 //---------------------------------------------------------------------
 HRESULT CFlashDXPlayer::FSCommand(const wchar_t* command, const wchar_t* args)
 {
+	CTraceSpan span(m_owner->GetTracer(), "FSCommand", this);
+
+	++m_counters.m_numFSCommands;
+
 	for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
 	{
 		HRESULT result = m_eventHandlers[i]->FSCommand(command, args);
 		if (result != E_NOTIMPL) return result;
 	}
 	return E_NOTIMPL;
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::OnProgress(long percentDone)
+{
+	for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+		m_eventHandlers[i]->OnProgress(percentDone);
+}
+
+//---------------------------------------------------------------------
+void CFlashDXPlayer::OnReadyStateChange(long newState)
+{
+	for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+		m_eventHandlers[i]->OnReadyStateChange(newState);
+
+	if (newState == 4 && m_waitingForMovie && m_movieLoader == NULL)
+		FinishAsyncLoad();
 }
\ No newline at end of file
@@ -25,6 +25,16 @@
 #include "IFlashDX.h"
 #include "ControlSite.h"
 #include "FlashSink.h"
+#include "CommandProxy.h"
+#include "FramePacer.h"
+#include "QualityController.h"
+#include "FrameCache.h"
+#include "InputQueue.h"
+#include "HitMask.h"
+#include "RenderBufferPool.h"
+#include "DrawTimings.h"
+#include "DirtyRects.h"
+#include <map>
 
 //---------------------------------------------------------------------
 /// Implementation of IFlashDXPlayer interface.
@@ -34,12 +44,24 @@ class CFlashDXPlayer : public IFlashDXPlayer
 public:
 	//---------------------------------------------------------------------
 	/// Constructor.
-	CFlashDXPlayer(HMODULE flashDLL, unsigned int width, unsigned int height);
+	CFlashDXPlayer(class CFlashDX* owner, HMODULE flashDLL, unsigned int width, unsigned int height);
 
 	//---------------------------------------------------------------------
 	/// Destructor.
 	virtual ~CFlashDXPlayer();
 
+	//---------------------------------------------------------------------
+	/// Unloads movie and restores default settings, so the player can be reused.
+	void Reset();
+
+	//---------------------------------------------------------------------
+	/// Creates frame buffer rendered by worker thread, or recreates it if player was resized.
+	bool PrepareFrameBuffer();
+
+	//---------------------------------------------------------------------
+	/// Releases frame buffer rendered by worker thread.
+	void ReleaseFrameBuffer();
+
 	//---------------------------------------------------------------------
 	/// Adds dirty rectangle.
 	void AddDirtyRect(const RECT* pRect);
@@ -49,6 +71,11 @@ public:
 	HRESULT FlashCall(const wchar_t* request);
 	HRESULT FSCommand(const wchar_t* command, const wchar_t* args);
 
+	//---------------------------------------------------------------------
+	/// Forwards loading events to event handlers.
+	void OnProgress(long percentDone);
+	void OnReadyStateChange(long newState);
+
 	//---------------------------------------------------------------------
 	// IFlashDXPlayer implementations.
 	//---------------------------------------------------------------------
@@ -60,6 +87,9 @@ public:
 	virtual ETransparencyMode GetTransparencyMode() const;
 	virtual void SetTransparencyMode(ETransparencyMode mode);
 	virtual bool LoadMovie(const wchar_t* movie);
+	virtual bool LoadMovie(const void* movieData, const unsigned int movieDataSize);
+	virtual bool LoadMovieAsync(const wchar_t* movie);
+	virtual bool IsMovieLoading() const;
 	virtual COLORREF GetBackgroundColor();
 	virtual void SetBackgroundColor(COLORREF color);
 	virtual void StartPlaying();
@@ -84,13 +114,52 @@ public:
 	virtual void SetProperty(int iProperty, const wchar_t* value, const wchar_t* timelineTarget = L"/");
 	virtual void SetProperty(int iProperty, double value, const wchar_t* timelineTarget = L"/");
 	virtual void ResizePlayer(unsigned int newWidth, unsigned int newHeight);
+	virtual void SetResolutionScale(float scale);
+	virtual float GetResolutionScale() const;
+	virtual unsigned int GetSurfaceWidth() const;
+	virtual unsigned int GetSurfaceHeight() const;
+	virtual void SetVisibleRect(const RECT* rect);
+	virtual void Suspend();
+	virtual void Resume();
+	virtual bool IsSuspended() const;
+	virtual void SetAutoSuspend(unsigned int delay);
+	virtual void SetFrameCache(unsigned int memoryLimit);
+	virtual void SetFrameCacheKey(const wchar_t* key);
+	virtual void GetFrameCacheStats(SFrameCacheStats& stats);
 	virtual bool IsNeedUpdate(const RECT** unitedDirtyRect = NULL, const RECT** dirtyRects = NULL, unsigned int* numDirtyRects = NULL);
 	virtual void DrawFrame(HDC dc);
+	virtual HANDLE GetDirtyEvent();
+	virtual void SetDirtyCallback(void (*callback)(IFlashDXPlayer* pPlayer, void* context), void* context);
+	virtual void SetFramePacing(float maxRate, bool useMovieFrameRate);
+	virtual unsigned int GetTimeToNextUpdate();
+	virtual void GetPacingStats(SPacingStats& stats);
+	virtual void ResetPacingStats();
+	virtual void SetAdaptiveQuality(float drawBudget, EQuality minQuality = QUALITY_LOW, EQuality maxQuality = QUALITY_HIGH);
+	virtual float GetAverageDrawTime() const;
+	virtual void SetCritical(bool critical);
+	virtual bool IsCritical() const;
+	virtual bool GetDrawTimings(SDrawTimings& timings);
+	virtual void ResetDrawTimings();
 	virtual void SetMousePos(unsigned int x, unsigned int y);
 	virtual void SetMouseButtonState(unsigned int x, unsigned int y, EMouseButton button, bool pressed);
 	virtual void SendMouseWheel(int delta);
 	virtual void SendKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended);
 	virtual void SendChar(UINT_PTR character, LONG_PTR extended);
+	virtual void SetInputBuffering(bool enable);
+	virtual void FlushInput();
+	virtual void SetHitTest(unsigned char alphaThreshold, bool filterInput);
+	virtual bool IsOpaqueAt(unsigned int x, unsigned int y) const;
+	virtual bool StartRecording(const wchar_t* path);
+	virtual void StopRecording();
+	virtual bool StartReplay(const wchar_t* path);
+	virtual void StopReplay();
+	virtual bool IsReplaying() const;
+	virtual bool StartDirtyRectTrace(const wchar_t* path);
+	virtual void StopDirtyRectTrace();
+	virtual void GetCounters(SCounters& counters);
+	virtual unsigned int GetFlashCallCounters(SFlashCallCounter* counters, unsigned int maxCounters);
+	virtual void ResetCounters();
+	virtual void GetMemoryUsage(SMemoryUsage& usage);
 	virtual void EnableSound(bool enable);
 	virtual const wchar_t* CallFunction(const wchar_t* request);
 	virtual void SetReturnValue(const wchar_t* returnValue);
@@ -98,28 +167,105 @@ public:
 	virtual void RemoveEventHandler(struct IFlashDXEventHandler* pHandler);
 	virtual struct IFlashDXEventHandler* GetEventHandlerByIndex(unsigned int index);
 	virtual unsigned int GetNumEventHandlers() const;
+	virtual struct IFlashDXPlayerProxy* GetCommandProxy();
 
 protected:
 	//---------------------------------------------------------------------
 	WPARAM CreateMouseWParam(WPARAM highWord);
 	//---------------------------------------------------------------------
-	bool ReduceNumDirtyRects();
+	void DeliverMouseMove(unsigned int x, unsigned int y);
+	void DeliverMouseButton(unsigned int x, unsigned int y, EMouseButton button, bool pressed);
+	void DeliverMouseWheel(int delta);
+	void DeliverKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended);
+	void DeliverChar(UINT_PTR character, LONG_PTR extended);
+	//---------------------------------------------------------------------
+	bool IsSurfaceOpaqueAt(unsigned int x, unsigned int y) const;
+	void UpdateHitMask(const BYTE* bits, unsigned int pitch);
+	//---------------------------------------------------------------------
+	void CountFlashCall(const wchar_t* request);
+	//---------------------------------------------------------------------
+	bool LoadMovieFromMemory(const BYTE* movieData, unsigned int movieDataSize, const wchar_t* moviePath = NULL);
+	//---------------------------------------------------------------------
+	void UpdateMovieFrameRate(class CSWFData& movieHeader);
+	//---------------------------------------------------------------------
+	void UpdateAsyncLoad();
+	void FinishAsyncLoad();
+	void CancelAsyncLoad();
+	//---------------------------------------------------------------------
+	void UpdateVisibleRect();
+	void UpdateHiddenState(bool wasHidden);
+	//---------------------------------------------------------------------
+	void GetFrameCacheKey(std::wstring& key);
+	CRenderBufferPool::SBuffer* UpdateFrameCache();
+	void ClearFrameCache();
+	void UpdateObjectRects();
 
 public:
-	unsigned int			m_width;
+	unsigned int			m_width;			// size of the rendered surface
 	unsigned int			m_height;
+	unsigned int			m_logicalWidth;		// size passed by the user, surface size is this scaled by m_resolutionScale
+	unsigned int			m_logicalHeight;
+	float					m_resolutionScale;
+	RECT					m_visibleRect;		// visible part of the surface, clip rect of the Flash object
 	ETransparencyMode		m_transpMode;
+	bool					m_critical;
+	unsigned int			m_numPostponedUpdates;	// DrawAll() calls that skipped the player in a row
 
 	ShockwaveFlashObjects::IShockwaveFlash* m_flashInterface;
 
+	// Worker thread owning the player, NULL if player lives on CFlashDX thread
+	class CRenderWorker*	m_worker;
+
+	// Frame buffer rendered by worker thread
+	HDC						m_frameDC;
+	HBITMAP					m_frameBitmap;
+	BYTE*					m_frameBits;
+	unsigned int			m_frameWidth;
+	unsigned int			m_frameHeight;
+	volatile LONG			m_frameBusy;		// frame is rendered or held by consumer
+	unsigned int			m_renderScratchSize;	// most pool memory borrowed by one draw
+
 protected:
+	class CFlashDX*			m_owner;
 	CControlSite			m_controlSite;
 	CFlashSink				m_flashSink;
+	CCommandProxy			m_commandProxy;
 	IOleObject*				m_oleObject;
 	IOleInPlaceObjectWindowless* m_windowlessObject;
 
-	RECT					m_dirtyUnionRect;
-	std::vector<RECT>		m_dirtyRects;
+	class CMovieLoader*		m_movieLoader;
+	class CCallRecorder*	m_recorder;
+	class CCallReplayer*	m_replayer;
+	class CDirtyRectTraceWriter* m_dirtyRectTrace;
+	unsigned int			m_loadProgress;
+	bool					m_waitingForMovie;	// new movie is passed to Flash, but not ready yet
+
+	HANDLE					m_dirtyEvent;
+	void					(*m_dirtyCallback)(IFlashDXPlayer* pPlayer, void* context);
+	void*					m_dirtyCallbackContext;
+	CFramePacer				m_pacer;
+	CQualityController		m_qualityController;
+#ifdef FLASHDX_DRAW_TIMING
+	CDrawTimings			m_drawTimings;
+#endif
+
+	RECT					m_logicalVisibleRect;
+	bool					m_hasVisibleRect;
+	RECT					m_hiddenDirtyRect;	// changes outside of the visible rect, not drawn yet
+	DWORD					m_hiddenTime;		// tick count when the visible rect became empty
+
+	bool					m_suspended;
+	bool					m_autoSuspended;	// suspended because of being hidden, resumed when shown
+	bool					m_resumePlaying;	// movie was playing when suspended
+	unsigned int			m_autoSuspendDelay;
+
+	CFrameCache				m_frameCache;
+	std::wstring			m_frameCacheKey;
+	bool					m_autoFrameCacheKey;	// key is made of the main timeline frame and label
+	std::wstring			m_drawnStateKey;		// state shown on the target surface
+	DWORD					m_drawnStateTime;		// tick count when the state was drawn first
+
+	CDirtyRects				m_dirtyRects;
 	bool					m_dirtyFlag;
 
 	RECT					m_savedUnionRect;
@@ -130,17 +276,23 @@ protected:
 	unsigned int			m_lastMouseX;
 	unsigned int			m_lastMouseY;
 	intptr_t				m_lastMouseButtons;
+	WPARAM					m_modifierKeys;		// MK_CONTROL and MK_SHIFT, tracked from SendKey()
+
+	CInputQueue				m_inputQueue;
+	std::vector<CInputQueue::SEvent> m_inputEvents;	// events being delivered
+	bool					m_bufferInput;
+	unsigned int			m_numQueuedInput;	// events added to the queue since the last flush
+
+	CHitMask				m_hitMask;
+	BYTE					m_hitTestThreshold;	// zero if hit testing is disabled
+	bool					m_hitTestInput;		// drop mouse input over transparent pixels
+	bool					m_mouseOverOpaque;
 
 	std::wstring			m_invokeString;
 	std::wstring			m_tempStorage;
 
-	std::vector<struct IFlashDXEventHandler*> m_eventHandlers;
+	SCounters				m_counters;
+	std::map<std::wstring, unsigned int> m_flashCallCounts;
 
-	// Alpha restore buffers
-	HDC						m_alphaBlackDC;
-	HBITMAP					m_alphaBlackBitmap;
-	BYTE*					m_alphaBlackBuffer;
-	HDC						m_alphaWhiteDC;
-	HBITMAP					m_alphaWhiteBitmap;
-	BYTE*					m_alphaWhiteBuffer;
+	std::vector<struct IFlashDXEventHandler*> m_eventHandlers;
 };
\ No newline at end of file
@@ -155,9 +155,13 @@ HRESULT STDMETHODCALLTYPE CFlashSink::Invoke(DISPID dispIdMember, REFIID riid, L
 		if (pDispParams->cArgs != 2 || pDispParams->rgvarg[0].vt != VT_BSTR || pDispParams->rgvarg[1].vt != VT_BSTR) return E_INVALIDARG;
 		return m_flashPlayer->FSCommand(pDispParams->rgvarg[1].bstrVal, pDispParams->rgvarg[0].bstrVal);
 	case 0x7a6: // OnProgress
-		return E_NOTIMPL;
+		if (pDispParams->cArgs != 1 || pDispParams->rgvarg[0].vt != VT_I4) return E_INVALIDARG;
+		m_flashPlayer->OnProgress(pDispParams->rgvarg[0].lVal);
+		return NOERROR;
 	case DISPID_READYSTATECHANGE:
-		return E_NOTIMPL;
+		if (pDispParams->cArgs != 1 || pDispParams->rgvarg[0].vt != VT_I4) return E_INVALIDARG;
+		m_flashPlayer->OnReadyStateChange(pDispParams->rgvarg[0].lVal);
+		return NOERROR;
 	}
 
 	return DISP_E_MEMBERNOTFOUND;
@@ -0,0 +1,219 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "FrameCache.h"
+
+//---------------------------------------------------------------------
+// Run header flag, set for literal runs followed by count pixels.
+// Repeat runs are followed by a single pixel.
+static const DWORD s_literalFlag = 0x80000000;
+
+//---------------------------------------------------------------------
+// Shorter repeats are stored as literals.
+static const unsigned int s_minRepeat = 3;
+
+//---------------------------------------------------------------------
+static void EncodeRow(const DWORD* pixels, unsigned int width, std::vector<DWORD>& data)
+{
+	unsigned int x = 0;
+	size_t literalHeader = (size_t)-1;
+
+	while (x < width)
+	{
+		unsigned int repeat = 1;
+		while (x + repeat < width && pixels[x + repeat] == pixels[x])
+			++repeat;
+
+		if (repeat >= s_minRepeat)
+		{
+			data.push_back(repeat);
+			data.push_back(pixels[x]);
+			literalHeader = (size_t)-1;
+		}
+		else
+		{
+			// Extend previous literal run or start a new one
+			if (literalHeader == (size_t)-1)
+			{
+				literalHeader = data.size();
+				data.push_back(s_literalFlag);
+			}
+			data[literalHeader] += repeat;
+			data.insert(data.end(), pixels + x, pixels + x + repeat);
+		}
+
+		x += repeat;
+	}
+}
+
+//---------------------------------------------------------------------
+static bool DecodeRow(const DWORD*& src, const DWORD* end, DWORD* pixels, unsigned int width)
+{
+	unsigned int x = 0;
+	while (x < width)
+	{
+		if (src >= end)
+			return false;
+
+		DWORD header = *src++;
+		unsigned int count = header & ~s_literalFlag;
+		if (count == 0 || x + count > width)
+			return false;
+
+		if (header & s_literalFlag)
+		{
+			if ((unsigned int)(end - src) < count)
+				return false;
+			memcpy(pixels + x, src, count * sizeof(DWORD));
+			src += count;
+		}
+		else
+		{
+			if (src >= end)
+				return false;
+			DWORD pixel = *src++;
+			for (unsigned int i = 0; i < count; ++i)
+				pixels[x + i] = pixel;
+		}
+
+		x += count;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------
+CFrameCache::CFrameCache()
+{
+	m_memoryLimit = 0;
+	m_memoryUsage = 0;
+	m_numHits = 0;
+	m_numMisses = 0;
+}
+
+//---------------------------------------------------------------------
+void CFrameCache::SetLimit(unsigned int memoryLimit)
+{
+	m_memoryLimit = memoryLimit;
+	Trim();
+}
+
+//---------------------------------------------------------------------
+bool CFrameCache::IsEnabled() const
+{
+	return m_memoryLimit != 0;
+}
+
+//---------------------------------------------------------------------
+bool CFrameCache::Contains(const std::wstring& key, unsigned int width, unsigned int height) const
+{
+	EntryMap::const_iterator it = m_entryMap.find(key);
+	return it != m_entryMap.end() && it->second->m_width == width && it->second->m_height == height;
+}
+
+//---------------------------------------------------------------------
+void CFrameCache::Store(const std::wstring& key, const BYTE* bits, unsigned int pitch, unsigned int width, unsigned int height)
+{
+	EntryMap::iterator it = m_entryMap.find(key);
+	if (it != m_entryMap.end())
+		Remove(it);
+
+	m_entries.push_front(SEntry());
+	SEntry& entry = m_entries.front();
+	entry.m_key = key;
+	entry.m_width = width;
+	entry.m_height = height;
+
+	for (unsigned int y = 0; y < height; ++y)
+		EncodeRow((const DWORD*)(bits + y * pitch), width, entry.m_data);
+
+	// Shrink capacity, encoder grows the vector in steps
+	std::vector<DWORD>(entry.m_data).swap(entry.m_data);
+
+	m_entryMap[key] = m_entries.begin();
+	m_memoryUsage += (unsigned int)(entry.m_data.size() * sizeof(DWORD));
+
+	Trim();
+}
+
+//---------------------------------------------------------------------
+bool CFrameCache::Restore(const std::wstring& key, BYTE* bits, unsigned int pitch, unsigned int width, unsigned int height)
+{
+	EntryMap::iterator it = m_entryMap.find(key);
+	if (it == m_entryMap.end() || it->second->m_width != width || it->second->m_height != height)
+	{
+		++m_numMisses;
+		return false;
+	}
+
+	const std::vector<DWORD>& data = it->second->m_data;
+	const DWORD* src = data.empty() ? NULL : &data.front();
+	const DWORD* end = src + data.size();
+
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		if (!DecodeRow(src, end, (DWORD*)(bits + y * pitch), width))
+		{
+			Remove(it);
+			++m_numMisses;
+			return false;
+		}
+	}
+
+	// Move to front
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+	++m_numHits;
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CFrameCache::Clear()
+{
+	m_entries.clear();
+	m_entryMap.clear();
+	m_memoryUsage = 0;
+}
+
+//---------------------------------------------------------------------
+void CFrameCache::GetStats(IFlashDXPlayer::SFrameCacheStats& stats) const
+{
+	stats.m_numHits = m_numHits;
+	stats.m_numMisses = m_numMisses;
+	stats.m_numFrames = (unsigned int)m_entries.size();
+	stats.m_memoryUsage = m_memoryUsage;
+	stats.m_memoryLimit = m_memoryLimit;
+}
+
+//---------------------------------------------------------------------
+void CFrameCache::Remove(EntryMap::iterator it)
+{
+	m_memoryUsage -= (unsigned int)(it->second->m_data.size() * sizeof(DWORD));
+	m_entries.erase(it->second);
+	m_entryMap.erase(it);
+}
+
+//---------------------------------------------------------------------
+void CFrameCache::Trim()
+{
+	while (m_memoryUsage > m_memoryLimit && !m_entries.empty())
+		Remove(m_entryMap.find(m_entries.back().m_key));
+}
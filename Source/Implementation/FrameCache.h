@@ -0,0 +1,95 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+#include <list>
+#include <map>
+
+//---------------------------------------------------------------------
+/// LRU cache of rendered frames of a single player, keyed by movie state.
+/// Frames are kept run-length encoded, static UI screens mostly consist of flat areas.
+//---------------------------------------------------------------------
+class CFrameCache
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CFrameCache();
+
+	//---------------------------------------------------------------------
+	/// Sets memory limit. Zero disables the cache and drops all frames.
+	void SetLimit(unsigned int memoryLimit);
+
+	//---------------------------------------------------------------------
+	/// Checks if the cache is enabled.
+	bool IsEnabled() const;
+
+	//---------------------------------------------------------------------
+	/// Checks if frame of the specified size is cached for the key.
+	bool Contains(const std::wstring& key, unsigned int width, unsigned int height) const;
+
+	//---------------------------------------------------------------------
+	/// Compresses and stores 32 bit frame, replacing previous frame of the key.
+	void Store(const std::wstring& key, const BYTE* bits, unsigned int pitch, unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Decompresses cached frame into 32 bit buffer. Counts hits and misses.
+	bool Restore(const std::wstring& key, BYTE* bits, unsigned int pitch, unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Drops all frames, e.g. when a new movie is loaded.
+	void Clear();
+
+	//---------------------------------------------------------------------
+	/// Returns statistics.
+	void GetStats(IFlashDXPlayer::SFrameCacheStats& stats) const;
+
+protected:
+	//---------------------------------------------------------------------
+	struct SEntry
+	{
+		std::wstring			m_key;
+		unsigned int			m_width;
+		unsigned int			m_height;
+		std::vector<DWORD>		m_data;
+	};
+
+	typedef std::list<SEntry> EntryList;
+	typedef std::map<std::wstring, EntryList::iterator> EntryMap;
+
+	//---------------------------------------------------------------------
+	void Remove(EntryMap::iterator it);
+	//---------------------------------------------------------------------
+	void Trim();
+
+protected:
+	EntryList				m_entries;			// most recently used first
+	EntryMap				m_entryMap;
+
+	unsigned int			m_memoryLimit;
+	unsigned int			m_memoryUsage;
+
+	unsigned int			m_numHits;
+	unsigned int			m_numMisses;
+};
@@ -0,0 +1,175 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "FramePacer.h"
+#include <math.h>
+
+//---------------------------------------------------------------------
+CFramePacer::CFramePacer()
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_frequency = frequency.QuadPart;
+
+	m_interval = 0;
+	m_maxRate = 0.0f;
+	m_useMovieFrameRate = false;
+	m_movieFrameRate = 0;
+
+	m_lastUpdate = 0;
+	m_dirtySince = 0;
+	m_hasUpdate = false;
+
+	ResetStats();
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::SetMovieFrameRate(unsigned int fps)
+{
+	m_movieFrameRate = fps;
+	UpdateInterval();
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::SetLimits(float maxRate, bool useMovieFrameRate)
+{
+	m_maxRate = maxRate;
+	m_useMovieFrameRate = useMovieFrameRate;
+	UpdateInterval();
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::UpdateInterval()
+{
+	// The lowest of the enabled rates wins
+	float rate = m_maxRate;
+	if (m_useMovieFrameRate && m_movieFrameRate != 0 && (rate <= 0.0f || m_movieFrameRate < rate))
+		rate = (float)m_movieFrameRate;
+
+	m_interval = rate > 0.0f ? (__int64)(m_frequency / rate) : 0;
+}
+
+//---------------------------------------------------------------------
+__int64 CFramePacer::GetTime() const
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::OnDirty()
+{
+	m_dirtySince = GetTime();
+}
+
+//---------------------------------------------------------------------
+bool CFramePacer::CanUpdate() const
+{
+	if (m_interval == 0 || !m_hasUpdate)
+		return true;
+
+	return GetTime() - m_lastUpdate >= m_interval;
+}
+
+//---------------------------------------------------------------------
+unsigned int CFramePacer::GetTimeToNextUpdate() const
+{
+	if (m_interval == 0 || !m_hasUpdate)
+		return 0;
+
+	__int64 left = m_lastUpdate + m_interval - GetTime();
+	if (left <= 0)
+		return 0;
+
+	// Round up, so the caller doesn't wake up too early
+	return (unsigned int)((left * 1000 + m_frequency - 1) / m_frequency);
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::OnUpdate()
+{
+	__int64 now = GetTime();
+
+	if (m_hasUpdate)
+	{
+		// Update is due when the player became dirty, but not earlier than pacing allows
+		__int64 due = max(m_lastUpdate + m_interval, m_dirtySince);
+		double lateness = (double)max(now - due, (__int64)0);
+
+		m_latenessSum += lateness;
+		m_latenessSquaredSum += lateness * lateness;
+		m_maxLateness = max(m_maxLateness, lateness);
+
+		// Interval is only meaningful if the player was kept waiting by pacing
+		if (m_dirtySince <= m_lastUpdate + m_interval)
+		{
+			m_intervalSum += double(now - m_lastUpdate);
+			++m_numPacedUpdates;
+		}
+	}
+
+	++m_numUpdates;
+	m_lastUpdate = now;
+	m_hasUpdate = true;
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::GetStats(IFlashDXPlayer::SPacingStats& stats) const
+{
+	double toMs = 1000.0 / double(m_frequency);
+	unsigned int numMeasured = m_numUpdates > 1 ? m_numUpdates - 1 : 0;
+
+	stats.m_updateInterval = float(double(m_interval) * toMs);
+	stats.m_numUpdates = m_numUpdates;
+	stats.m_numPacedUpdates = m_numPacedUpdates;
+	stats.m_meanInterval = m_numPacedUpdates ? float(m_intervalSum / m_numPacedUpdates * toMs) : 0.0f;
+
+	if (numMeasured)
+	{
+		double mean = m_latenessSum / numMeasured;
+		double variance = max(m_latenessSquaredSum / numMeasured - mean * mean, 0.0);
+
+		stats.m_meanLateness = float(mean * toMs);
+		stats.m_jitter = float(sqrt(variance) * toMs);
+		stats.m_maxLateness = float(m_maxLateness * toMs);
+	}
+	else
+	{
+		stats.m_meanLateness = 0.0f;
+		stats.m_jitter = 0.0f;
+		stats.m_maxLateness = 0.0f;
+	}
+}
+
+//---------------------------------------------------------------------
+void CFramePacer::ResetStats()
+{
+	m_numUpdates = 0;
+	m_numPacedUpdates = 0;
+	m_intervalSum = 0.0;
+	m_latenessSum = 0.0;
+	m_latenessSquaredSum = 0.0;
+	m_maxLateness = 0.0;
+	m_hasUpdate = false;
+}
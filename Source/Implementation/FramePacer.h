@@ -0,0 +1,91 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Limits rate of player updates and measures how regular they are.
+//---------------------------------------------------------------------
+class CFramePacer
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CFramePacer();
+
+	//---------------------------------------------------------------------
+	/// Sets frame rate of the loaded movie. Zero if unknown.
+	void SetMovieFrameRate(unsigned int fps);
+
+	//---------------------------------------------------------------------
+	/// Sets pacing limits. Zero rate and no movie frame rate disable pacing.
+	void SetLimits(float maxRate, bool useMovieFrameRate);
+
+	//---------------------------------------------------------------------
+	/// Should be called when the player becomes dirty.
+	void OnDirty();
+
+	//---------------------------------------------------------------------
+	/// Checks if enough time passed since the last update.
+	bool CanUpdate() const;
+
+	//---------------------------------------------------------------------
+	/// Returns milliseconds left until CanUpdate() allows update.
+	unsigned int GetTimeToNextUpdate() const;
+
+	//---------------------------------------------------------------------
+	/// Should be called when the player is drawn.
+	void OnUpdate();
+
+	//---------------------------------------------------------------------
+	/// Returns or resets statistics.
+	void GetStats(IFlashDXPlayer::SPacingStats& stats) const;
+	void ResetStats();
+
+protected:
+	//---------------------------------------------------------------------
+	__int64 GetTime() const;
+	//---------------------------------------------------------------------
+	void UpdateInterval();
+
+protected:
+	__int64					m_frequency;		// performance counter ticks per second
+	__int64					m_interval;			// minimal ticks between updates, zero if pacing is disabled
+
+	float					m_maxRate;
+	bool					m_useMovieFrameRate;
+	unsigned int			m_movieFrameRate;
+
+	__int64					m_lastUpdate;
+	__int64					m_dirtySince;
+	bool					m_hasUpdate;
+
+	// Statistics, in ticks
+	unsigned int			m_numUpdates;
+	unsigned int			m_numPacedUpdates;	// updates that were waiting for their turn
+	double					m_intervalSum;
+	double					m_latenessSum;
+	double					m_latenessSquaredSum;
+	double					m_maxLateness;
+};
@@ -0,0 +1,96 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "HitMask.h"
+
+//---------------------------------------------------------------------
+CHitMask::CHitMask()
+{
+	m_width = 0;
+	m_height = 0;
+	m_stride = 0;
+}
+
+//---------------------------------------------------------------------
+void CHitMask::Resize(unsigned int width, unsigned int height)
+{
+	m_width = width;
+	m_height = height;
+	m_stride = (width + 31) / 32;
+	m_bits.assign(m_stride * height, 0xFFFFFFFF);
+}
+
+//---------------------------------------------------------------------
+void CHitMask::Clear()
+{
+	std::vector<DWORD>().swap(m_bits);
+	m_width = 0;
+	m_height = 0;
+	m_stride = 0;
+}
+
+//---------------------------------------------------------------------
+unsigned int CHitMask::GetWidth() const
+{
+	return m_width;
+}
+
+//---------------------------------------------------------------------
+unsigned int CHitMask::GetHeight() const
+{
+	return m_height;
+}
+
+//---------------------------------------------------------------------
+void CHitMask::Update(const BYTE* bits, unsigned int pitch, const RECT& rect, BYTE alphaThreshold)
+{
+	LONG right = rect.right < (LONG)m_width ? rect.right : (LONG)m_width;
+	LONG bottom = rect.bottom < (LONG)m_height ? rect.bottom : (LONG)m_height;
+
+	for (LONG y = rect.top; y < bottom; ++y)
+	{
+		DWORD* row = &m_bits[y * m_stride];
+		const BYTE* alpha = bits + y * pitch + rect.left * 4 + 3;
+		for (LONG x = rect.left; x < right; ++x)
+		{
+			DWORD bit = 1u << (x & 31);
+			if (*alpha >= alphaThreshold)
+				row[x >> 5] |= bit;
+			else
+				row[x >> 5] &= ~bit;
+			alpha += 4;
+		}
+	}
+}
+
+//---------------------------------------------------------------------
+bool CHitMask::IsOpaque(unsigned int x, unsigned int y) const
+{
+	return (m_bits[y * m_stride + (x >> 5)] & (1u << (x & 31))) != 0;
+}
+
+//---------------------------------------------------------------------
+unsigned int CHitMask::GetMemoryUsage() const
+{
+	return (unsigned int)(m_bits.capacity() * sizeof(DWORD));
+}
@@ -0,0 +1,65 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+//---------------------------------------------------------------------
+/// One bit per pixel mask of opaque pixels, used for hit testing of FULL_ALPHA players.
+//---------------------------------------------------------------------
+class CHitMask
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CHitMask();
+
+	//---------------------------------------------------------------------
+	/// Resizes the mask. All pixels are opaque until updated.
+	void Resize(unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Frees the mask.
+	void Clear();
+
+	//---------------------------------------------------------------------
+	/// Returns mask size.
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+
+	//---------------------------------------------------------------------
+	/// Updates rectangle of the mask from alpha of 32 bit BGRA pixels.
+	void Update(const BYTE* bits, unsigned int pitch, const RECT& rect, BYTE alphaThreshold);
+
+	//---------------------------------------------------------------------
+	/// Checks if pixel is opaque. Coordinates must be inside of the mask.
+	bool IsOpaque(unsigned int x, unsigned int y) const;
+
+	//---------------------------------------------------------------------
+	/// Returns bytes allocated for the mask.
+	unsigned int GetMemoryUsage() const;
+
+protected:
+	std::vector<DWORD>		m_bits;
+	unsigned int			m_width;
+	unsigned int			m_height;
+	unsigned int			m_stride;			// DWORDs per row
+};
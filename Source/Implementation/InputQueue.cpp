@@ -0,0 +1,112 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "InputQueue.h"
+
+//---------------------------------------------------------------------
+void CInputQueue::AddMouseMove(unsigned int x, unsigned int y)
+{
+	if (!m_events.empty() && m_events.back().m_type == MOUSE_MOVE)
+	{
+		m_events.back().m_x = x;
+		m_events.back().m_y = y;
+		return;
+	}
+
+	SEvent& event = AddEvent(MOUSE_MOVE);
+	event.m_x = x;
+	event.m_y = y;
+}
+
+//---------------------------------------------------------------------
+void CInputQueue::AddMouseButton(unsigned int x, unsigned int y, IFlashDXPlayer::EMouseButton button, bool pressed)
+{
+	SEvent& event = AddEvent(MOUSE_BUTTON);
+	event.m_x = x;
+	event.m_y = y;
+	event.m_button = button;
+	event.m_pressed = pressed;
+}
+
+//---------------------------------------------------------------------
+void CInputQueue::AddMouseWheel(int delta)
+{
+	if (!m_events.empty() && m_events.back().m_type == MOUSE_WHEEL)
+	{
+		m_events.back().m_delta += delta;
+		return;
+	}
+
+	SEvent& event = AddEvent(MOUSE_WHEEL);
+	event.m_delta = delta;
+}
+
+//---------------------------------------------------------------------
+void CInputQueue::AddKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended)
+{
+	SEvent& event = AddEvent(KEY);
+	event.m_pressed = pressed;
+	event.m_key = virtualKey;
+	event.m_extended = extended;
+}
+
+//---------------------------------------------------------------------
+void CInputQueue::AddChar(UINT_PTR character, LONG_PTR extended)
+{
+	SEvent& event = AddEvent(CHAR);
+	event.m_key = character;
+	event.m_extended = extended;
+}
+
+//---------------------------------------------------------------------
+bool CInputQueue::IsEmpty() const
+{
+	return m_events.empty();
+}
+
+//---------------------------------------------------------------------
+void CInputQueue::TakeEvents(std::vector<SEvent>& events)
+{
+	events.insert(events.end(), m_events.begin(), m_events.end());
+	m_events.clear();
+}
+
+//---------------------------------------------------------------------
+void CInputQueue::Clear()
+{
+	m_events.clear();
+}
+
+//---------------------------------------------------------------------
+unsigned int CInputQueue::GetMemoryUsage() const
+{
+	return (unsigned int)(m_events.capacity() * sizeof(SEvent));
+}
+
+//---------------------------------------------------------------------
+CInputQueue::SEvent& CInputQueue::AddEvent(EType type)
+{
+	SEvent event = {type};
+	m_events.push_back(event);
+	return m_events.back();
+}
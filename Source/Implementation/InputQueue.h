@@ -0,0 +1,88 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Input events buffered until the player's next tick.
+/// Consecutive mouse moves collapse into the last one and consecutive wheel deltas are summed,
+/// button and key transitions keep their order.
+//---------------------------------------------------------------------
+class CInputQueue
+{
+public:
+	//---------------------------------------------------------------------
+	enum EType
+	{
+		MOUSE_MOVE,
+		MOUSE_BUTTON,
+		MOUSE_WHEEL,
+		KEY,
+		CHAR,
+	};
+
+	//---------------------------------------------------------------------
+	struct SEvent
+	{
+		EType					m_type;
+		unsigned int			m_x;			// mouse events
+		unsigned int			m_y;
+		IFlashDXPlayer::EMouseButton m_button;
+		bool					m_pressed;		// button and key events
+		int						m_delta;		// wheel events
+		UINT_PTR				m_key;			// virtual key or character
+		LONG_PTR				m_extended;
+	};
+
+	//---------------------------------------------------------------------
+	/// Adds events.
+	void AddMouseMove(unsigned int x, unsigned int y);
+	void AddMouseButton(unsigned int x, unsigned int y, IFlashDXPlayer::EMouseButton button, bool pressed);
+	void AddMouseWheel(int delta);
+	void AddKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended);
+	void AddChar(UINT_PTR character, LONG_PTR extended);
+
+	//---------------------------------------------------------------------
+	/// Checks if there are events to deliver.
+	bool IsEmpty() const;
+
+	//---------------------------------------------------------------------
+	/// Moves all queued events to the end of the array, leaving the queue empty.
+	void TakeEvents(std::vector<SEvent>& events);
+
+	//---------------------------------------------------------------------
+	/// Drops all queued events.
+	void Clear();
+
+	//---------------------------------------------------------------------
+	/// Returns bytes allocated for events.
+	unsigned int GetMemoryUsage() const;
+
+protected:
+	//---------------------------------------------------------------------
+	SEvent& AddEvent(EType type);
+
+protected:
+	std::vector<SEvent>		m_events;
+};
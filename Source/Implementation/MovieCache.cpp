@@ -0,0 +1,242 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "MovieCache.h"
+#include "SWFData.h"
+
+//---------------------------------------------------------------------
+static unsigned __int64 HashData(const BYTE* data, unsigned int size)
+{
+	// FNV-1a
+	unsigned __int64 hash = 14695981039346656037ULL;
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+//---------------------------------------------------------------------
+CMovieCache::CMovieCache()
+{
+	InitializeCriticalSection(&m_lock);
+
+	m_memoryLimit = 0;
+	m_memoryUsage = 0;
+	m_memoryHits = 0;
+	m_diskHits = 0;
+	m_misses = 0;
+}
+
+//---------------------------------------------------------------------
+CMovieCache::~CMovieCache()
+{
+	DeleteCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+void CMovieCache::SetLimits(unsigned int memoryLimit, const wchar_t* diskCachePath)
+{
+	EnterCriticalSection(&m_lock);
+
+	m_memoryLimit = memoryLimit;
+	m_diskPath = diskCachePath ? diskCachePath : L"";
+	if (!m_diskPath.empty())
+		CreateDirectoryW(m_diskPath.c_str(), NULL);
+
+	Trim();
+
+	LeaveCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+bool CMovieCache::IsEnabled() const
+{
+	return m_memoryLimit != 0;
+}
+
+//---------------------------------------------------------------------
+bool CMovieCache::GetDecompressedMovie(const BYTE* data, unsigned int size, std::vector<BYTE>& movie)
+{
+	CSWFData swf;
+	if (!swf.LoadFromMemory(data, size))
+		return false;
+
+	// Nothing to save on uncompressed movies
+	if (!swf.IsCompressed())
+	{
+		movie.swap(swf.GetBuffer());
+		return true;
+	}
+
+	unsigned __int64 hash = HashData(data, size);
+
+	EnterCriticalSection(&m_lock);
+
+	EntryMap::iterator it = m_entryMap.find(hash);
+	if (it != m_entryMap.end() && it->second->m_sourceSize == size)
+	{
+		// Move to front
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		movie = it->second->m_data;
+		++m_memoryHits;
+
+		LeaveCriticalSection(&m_lock);
+		return true;
+	}
+
+	LeaveCriticalSection(&m_lock);
+
+	// Inflate outside of the lock, other players may use the cache meanwhile
+	bool fromDisk = ReadFromDisk(hash, movie);
+	if (!fromDisk)
+	{
+		if (!swf.Decompress())
+			return false;
+		movie.swap(swf.GetBuffer());
+		WriteToDisk(hash, movie);
+	}
+
+	std::vector<BYTE> entryData(movie);
+
+	EnterCriticalSection(&m_lock);
+
+	if (fromDisk)
+		++m_diskHits;
+	else
+		++m_misses;
+
+	Insert(hash, size, entryData);
+
+	LeaveCriticalSection(&m_lock);
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CMovieCache::GetStats(IFlashDX::SMovieCacheStats& stats)
+{
+	EnterCriticalSection(&m_lock);
+
+	stats.m_memoryHits = m_memoryHits;
+	stats.m_diskHits = m_diskHits;
+	stats.m_misses = m_misses;
+	stats.m_numEntries = (unsigned int)m_entries.size();
+	stats.m_memoryUsage = m_memoryUsage;
+	stats.m_memoryLimit = m_memoryLimit;
+
+	LeaveCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+void CMovieCache::Insert(unsigned __int64 hash, unsigned int sourceSize, std::vector<BYTE>& data)
+{
+	if (data.size() > m_memoryLimit)
+		return;
+
+	EntryMap::iterator it = m_entryMap.find(hash);
+	if (it != m_entryMap.end())
+	{
+		m_memoryUsage -= (unsigned int)it->second->m_data.size();
+		m_entries.erase(it->second);
+		m_entryMap.erase(it);
+	}
+
+	m_entries.push_front(SEntry());
+	SEntry& entry = m_entries.front();
+	entry.m_hash = hash;
+	entry.m_sourceSize = sourceSize;
+	entry.m_data.swap(data);
+
+	m_entryMap[hash] = m_entries.begin();
+	m_memoryUsage += (unsigned int)entry.m_data.size();
+
+	Trim();
+}
+
+//---------------------------------------------------------------------
+void CMovieCache::Trim()
+{
+	while (m_memoryUsage > m_memoryLimit && !m_entries.empty())
+	{
+		SEntry& entry = m_entries.back();
+		m_memoryUsage -= (unsigned int)entry.m_data.size();
+		m_entryMap.erase(entry.m_hash);
+		m_entries.pop_back();
+	}
+}
+
+//---------------------------------------------------------------------
+std::wstring CMovieCache::GetDiskPath(unsigned __int64 hash) const
+{
+	wchar_t name[32];
+	swprintf_s(name, L"\\%016I64x.swf", hash);
+
+	EnterCriticalSection(&m_lock);
+	std::wstring path = m_diskPath.empty() ? std::wstring() : m_diskPath + name;
+	LeaveCriticalSection(&m_lock);
+
+	return path;
+}
+
+//---------------------------------------------------------------------
+bool CMovieCache::ReadFromDisk(unsigned __int64 hash, std::vector<BYTE>& data) const
+{
+	std::wstring path = GetDiskPath(hash);
+	if (path.empty())
+		return false;
+
+	CSWFData swf;
+	if (!swf.LoadFromFile(path.c_str()) || swf.IsCompressed())
+		return false;
+
+	data.swap(swf.GetBuffer());
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CMovieCache::WriteToDisk(unsigned __int64 hash, const std::vector<BYTE>& data) const
+{
+	if (data.empty())
+		return;
+
+	std::wstring path = GetDiskPath(hash);
+	if (path.empty())
+		return;
+
+	// Write to temporary file first, so other processes never see partially written movie
+	std::wstring tempPath = path + L".tmp";
+
+	HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	DWORD written = 0;
+	BOOL result = WriteFile(file, &data[0], (DWORD)data.size(), &written, NULL);
+	CloseHandle(file);
+
+	if (result && written == data.size())
+		MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+	else
+		DeleteFileW(tempPath.c_str());
+}
@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+#include <list>
+#include <map>
+
+//---------------------------------------------------------------------
+/// Content addressed LRU cache of decompressed movies.
+//---------------------------------------------------------------------
+class CMovieCache
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CMovieCache();
+
+	//---------------------------------------------------------------------
+	/// Destructor.
+	~CMovieCache();
+
+	//---------------------------------------------------------------------
+	/// Sets memory limit and disk cache location. Zero memory limit disables the cache.
+	void SetLimits(unsigned int memoryLimit, const wchar_t* diskCachePath);
+
+	//---------------------------------------------------------------------
+	/// Checks if the cache is enabled.
+	bool IsEnabled() const;
+
+	//---------------------------------------------------------------------
+	/// Returns decompressed copy of the movie, inflating it only if it is not cached yet.
+	bool GetDecompressedMovie(const BYTE* data, unsigned int size, std::vector<BYTE>& movie);
+
+	//---------------------------------------------------------------------
+	/// Returns statistics.
+	void GetStats(IFlashDX::SMovieCacheStats& stats);
+
+protected:
+	//---------------------------------------------------------------------
+	struct SEntry
+	{
+		unsigned __int64		m_hash;
+		unsigned int			m_sourceSize;
+		std::vector<BYTE>		m_data;
+	};
+
+	typedef std::list<SEntry> EntryList;
+	typedef std::map<unsigned __int64, EntryList::iterator> EntryMap;
+
+	//---------------------------------------------------------------------
+	void Insert(unsigned __int64 hash, unsigned int sourceSize, std::vector<BYTE>& data);
+	//---------------------------------------------------------------------
+	void Trim();
+	//---------------------------------------------------------------------
+	/// Returns empty path when disk cache is disabled. Takes the lock, SetLimits may change the path meanwhile.
+	std::wstring GetDiskPath(unsigned __int64 hash) const;
+	bool ReadFromDisk(unsigned __int64 hash, std::vector<BYTE>& data) const;
+	void WriteToDisk(unsigned __int64 hash, const std::vector<BYTE>& data) const;
+
+protected:
+	mutable CRITICAL_SECTION	m_lock;
+
+	EntryList				m_entries;			// most recently used first
+	EntryMap				m_entryMap;
+
+	unsigned int			m_memoryLimit;
+	unsigned int			m_memoryUsage;
+	std::wstring			m_diskPath;
+
+	unsigned int			m_memoryHits;
+	unsigned int			m_diskHits;
+	unsigned int			m_misses;
+};
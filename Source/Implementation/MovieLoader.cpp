@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "MovieLoader.h"
+#include "MovieCache.h"
+#include "SWFData.h"
+#include <process.h>
+
+//---------------------------------------------------------------------
+CMovieLoader::CMovieLoader(CMovieCache& movieCache)
+:
+	m_movieCache(movieCache)
+{
+	m_thread = NULL;
+	m_state = STATE_LOADING;
+	m_progress = 0;
+	m_cancel = 0;
+}
+
+//---------------------------------------------------------------------
+CMovieLoader::~CMovieLoader()
+{
+	if (m_thread)
+	{
+		InterlockedExchange(&m_cancel, 1);
+		WaitForSingleObject(m_thread, INFINITE);
+		CloseHandle(m_thread);
+	}
+}
+
+//---------------------------------------------------------------------
+bool CMovieLoader::Start(const wchar_t* path)
+{
+	assert(m_thread == NULL);
+
+	m_path = path;
+	m_thread = (HANDLE)_beginthreadex(NULL, 0, ThreadProc, this, 0, NULL);
+	return m_thread != NULL;
+}
+
+//---------------------------------------------------------------------
+bool CMovieLoader::IsDone() const
+{
+	return m_state != STATE_LOADING;
+}
+
+//---------------------------------------------------------------------
+bool CMovieLoader::IsSucceeded() const
+{
+	return m_state == STATE_SUCCEEDED;
+}
+
+//---------------------------------------------------------------------
+unsigned int CMovieLoader::GetProgress() const
+{
+	return (unsigned int)m_progress;
+}
+
+//---------------------------------------------------------------------
+std::vector<BYTE>& CMovieLoader::GetMovie()
+{
+	return m_movie;
+}
+
+//---------------------------------------------------------------------
+const std::wstring& CMovieLoader::GetPath() const
+{
+	return m_path;
+}
+
+//---------------------------------------------------------------------
+unsigned int __stdcall CMovieLoader::ThreadProc(void* param)
+{
+	CMovieLoader* loader = (CMovieLoader*)param;
+
+	bool result = loader->Load();
+
+	// Movie data must be complete before the owner sees the new state
+	MemoryBarrier();
+	InterlockedExchange(&loader->m_state, result ? STATE_SUCCEEDED : STATE_FAILED);
+	return 0;
+}
+
+//---------------------------------------------------------------------
+bool CMovieLoader::Load()
+{
+	CSWFData swf;
+	if (!swf.LoadFromFile(m_path.c_str(), &m_progress, &m_cancel))
+		return false;
+
+	if (m_cancel)
+		return false;
+
+	if (m_movieCache.IsEnabled() && m_movieCache.GetDecompressedMovie(swf.GetData(), swf.GetSize(), m_movie))
+		return true;
+
+	// Data stays intact if it can't be inflated here (LZMA), Flash will do it then
+	swf.Decompress();
+
+	m_movie.swap(swf.GetBuffer());
+	return true;
+}
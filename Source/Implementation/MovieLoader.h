@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+class CMovieCache;
+
+//---------------------------------------------------------------------
+/// Reads and decompresses movie file on a background thread.
+//---------------------------------------------------------------------
+class CMovieLoader
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CMovieLoader(CMovieCache& movieCache);
+
+	//---------------------------------------------------------------------
+	/// Destructor. Cancels loading and waits for the thread.
+	~CMovieLoader();
+
+	//---------------------------------------------------------------------
+	/// Starts loading of the movie file.
+	bool Start(const wchar_t* path);
+
+	//---------------------------------------------------------------------
+	/// Checks if loading is finished, successfully or not.
+	bool IsDone() const;
+	bool IsSucceeded() const;
+
+	//---------------------------------------------------------------------
+	/// Returns reading progress in percents.
+	unsigned int GetProgress() const;
+
+	//---------------------------------------------------------------------
+	/// Returns uncompressed movie. Valid when loading succeeded.
+	std::vector<BYTE>& GetMovie();
+
+	//---------------------------------------------------------------------
+	/// Returns full path of the movie file.
+	const std::wstring& GetPath() const;
+
+protected:
+	//---------------------------------------------------------------------
+	enum EState
+	{
+		STATE_LOADING = 0,
+		STATE_SUCCEEDED,
+		STATE_FAILED
+	};
+
+	//---------------------------------------------------------------------
+	static unsigned int __stdcall ThreadProc(void* param);
+	//---------------------------------------------------------------------
+	bool Load();
+
+protected:
+	CMovieCache&			m_movieCache;
+	std::wstring			m_path;
+	HANDLE					m_thread;
+
+	volatile LONG			m_state;
+	volatile LONG			m_progress;
+	volatile LONG			m_cancel;
+
+	std::vector<BYTE>		m_movie;
+};
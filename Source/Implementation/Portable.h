@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+//---------------------------------------------------------------------
+/// The few Win32 types and calls used by platform independent parts: CSharedRing, CDirtyRects, CombineAlpha.
+/// Lets them build without windows.h, for tests and tools on other systems.
+//---------------------------------------------------------------------
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <stdint.h>
+
+typedef uint8_t			BYTE;
+typedef uint16_t		WORD;
+typedef uint32_t		DWORD;
+typedef int32_t			LONG;
+typedef int				BOOL;
+
+#ifndef TRUE
+#define TRUE	1
+#define FALSE	0
+#endif
+
+#define MemoryBarrier()	__sync_synchronize()
+
+struct RECT
+{
+	LONG					left;
+	LONG					top;
+	LONG					right;
+	LONG					bottom;
+};
+
+//---------------------------------------------------------------------
+// Rect functions behave as the Win32 ones, empty results are all zeros.
+inline BOOL SetRect(RECT* rect, int left, int top, int right, int bottom)
+{
+	rect->left = left;
+	rect->top = top;
+	rect->right = right;
+	rect->bottom = bottom;
+	return TRUE;
+}
+
+//---------------------------------------------------------------------
+inline BOOL SetRectEmpty(RECT* rect)
+{
+	return SetRect(rect, 0, 0, 0, 0);
+}
+
+//---------------------------------------------------------------------
+inline BOOL IsRectEmpty(const RECT* rect)
+{
+	return rect->left >= rect->right || rect->top >= rect->bottom;
+}
+
+//---------------------------------------------------------------------
+inline BOOL EqualRect(const RECT* first, const RECT* second)
+{
+	return first->left == second->left && first->top == second->top &&
+		   first->right == second->right && first->bottom == second->bottom;
+}
+
+//---------------------------------------------------------------------
+inline BOOL IntersectRect(RECT* result, const RECT* first, const RECT* second)
+{
+	RECT rect;
+	rect.left = first->left > second->left ? first->left : second->left;
+	rect.top = first->top > second->top ? first->top : second->top;
+	rect.right = first->right < second->right ? first->right : second->right;
+	rect.bottom = first->bottom < second->bottom ? first->bottom : second->bottom;
+
+	if (IsRectEmpty(&rect))
+	{
+		SetRectEmpty(result);
+		return FALSE;
+	}
+
+	*result = rect;
+	return TRUE;
+}
+
+//---------------------------------------------------------------------
+inline BOOL UnionRect(RECT* result, const RECT* first, const RECT* second)
+{
+	if (IsRectEmpty(first))
+	{
+		if (IsRectEmpty(second))
+		{
+			SetRectEmpty(result);
+			return FALSE;
+		}
+		*result = *second;
+		return TRUE;
+	}
+	if (IsRectEmpty(second))
+	{
+		*result = *first;
+		return TRUE;
+	}
+
+	RECT rect;
+	rect.left = first->left < second->left ? first->left : second->left;
+	rect.top = first->top < second->top ? first->top : second->top;
+	rect.right = first->right > second->right ? first->right : second->right;
+	rect.bottom = first->bottom > second->bottom ? first->bottom : second->bottom;
+	*result = rect;
+	return TRUE;
+}
+
+#endif
@@ -0,0 +1,130 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "QualityController.h"
+
+//---------------------------------------------------------------------
+// Draw time smoothing and hysteresis parameters. Delays are in draws.
+static const float s_smoothing = 0.2f;				// weight of the newest sample
+static const float s_upgradeThreshold = 0.6f;		// fraction of the budget that allows higher quality
+static const unsigned int s_downgradeDelay = 3;
+static const unsigned int s_minUpgradeDelay = 30;
+static const unsigned int s_maxUpgradeDelay = 480;
+
+//---------------------------------------------------------------------
+CQualityController::CQualityController()
+{
+	m_budget = 0.0f;
+	m_minQuality = IFlashDXPlayer::QUALITY_LOW;
+	m_maxQuality = IFlashDXPlayer::QUALITY_BEST;
+	m_quality = IFlashDXPlayer::QUALITY_HIGH;
+
+	m_averageDrawTime = 0.0f;
+	m_hasDrawTime = false;
+
+	m_numOverBudget = 0;
+	m_numUnderBudget = 0;
+	m_numSinceUpgrade = s_maxUpgradeDelay;
+	m_upgradeDelay = s_minUpgradeDelay;
+}
+
+//---------------------------------------------------------------------
+void CQualityController::SetBudget(float budget, IFlashDXPlayer::EQuality minQuality, IFlashDXPlayer::EQuality maxQuality, IFlashDXPlayer::EQuality quality)
+{
+	// Automatic Flash modes are not part of the quality ladder
+	m_budget = budget;
+	m_minQuality = min((int)minQuality, (int)IFlashDXPlayer::QUALITY_BEST);
+	m_maxQuality = max(min((int)maxQuality, (int)IFlashDXPlayer::QUALITY_BEST), m_minQuality);
+
+	m_numOverBudget = 0;
+	m_numUnderBudget = 0;
+	m_numSinceUpgrade = s_maxUpgradeDelay;
+	m_upgradeDelay = s_minUpgradeDelay;
+
+	SetQuality(quality);
+}
+
+//---------------------------------------------------------------------
+bool CQualityController::IsEnabled() const
+{
+	return m_budget > 0.0f;
+}
+
+//---------------------------------------------------------------------
+void CQualityController::SetQuality(IFlashDXPlayer::EQuality quality)
+{
+	m_quality = max(m_minQuality, min((int)quality, m_maxQuality));
+}
+
+//---------------------------------------------------------------------
+bool CQualityController::AddDrawTime(float drawTime, IFlashDXPlayer::EQuality& newQuality)
+{
+	m_averageDrawTime = m_hasDrawTime ? m_averageDrawTime + (drawTime - m_averageDrawTime) * s_smoothing : drawTime;
+	m_hasDrawTime = true;
+
+	if (!IsEnabled())
+		return false;
+
+	if (m_numSinceUpgrade < s_maxUpgradeDelay)
+		++m_numSinceUpgrade;
+
+	// Separate thresholds and delays for both directions keep quality from thrashing
+	if (m_averageDrawTime > m_budget)
+	{
+		m_numUnderBudget = 0;
+		if (++m_numOverBudget < s_downgradeDelay || m_quality == m_minQuality)
+			return false;
+
+		// Quick fall after an upgrade means the upgrade was a mistake, be more careful next time
+		if (m_numSinceUpgrade < m_upgradeDelay)
+			m_upgradeDelay = min(m_upgradeDelay * 2, s_maxUpgradeDelay);
+
+		--m_quality;
+	}
+	else if (m_averageDrawTime < m_budget * s_upgradeThreshold)
+	{
+		m_numOverBudget = 0;
+		if (++m_numUnderBudget < m_upgradeDelay || m_quality == m_maxQuality)
+			return false;
+
+		++m_quality;
+		m_numSinceUpgrade = 0;
+	}
+	else
+	{
+		m_numOverBudget = 0;
+		m_numUnderBudget = 0;
+		return false;
+	}
+
+	m_numOverBudget = 0;
+	m_numUnderBudget = 0;
+	newQuality = (IFlashDXPlayer::EQuality)m_quality;
+	return true;
+}
+
+//---------------------------------------------------------------------
+float CQualityController::GetAverageDrawTime() const
+{
+	return m_averageDrawTime;
+}
@@ -0,0 +1,70 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Picks player quality that keeps measured draw time within the budget.
+//---------------------------------------------------------------------
+class CQualityController
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CQualityController();
+
+	//---------------------------------------------------------------------
+	/// Configures the controller. Zero budget disables it.
+	void SetBudget(float budget, IFlashDXPlayer::EQuality minQuality, IFlashDXPlayer::EQuality maxQuality, IFlashDXPlayer::EQuality quality);
+
+	//---------------------------------------------------------------------
+	/// Checks if the controller is enabled.
+	bool IsEnabled() const;
+
+	//---------------------------------------------------------------------
+	/// Tells the controller about quality set by user.
+	void SetQuality(IFlashDXPlayer::EQuality quality);
+
+	//---------------------------------------------------------------------
+	/// Adds measured draw time in milliseconds. Returns true if quality should be changed.
+	bool AddDrawTime(float drawTime, IFlashDXPlayer::EQuality& newQuality);
+
+	//---------------------------------------------------------------------
+	/// Returns smoothed draw time in milliseconds.
+	float GetAverageDrawTime() const;
+
+protected:
+	float					m_budget;
+	int						m_minQuality;
+	int						m_maxQuality;
+	int						m_quality;
+
+	float					m_averageDrawTime;
+	bool					m_hasDrawTime;
+
+	unsigned int			m_numOverBudget;		// consecutive draws over the budget
+	unsigned int			m_numUnderBudget;		// consecutive draws well under the budget
+	unsigned int			m_numSinceUpgrade;
+	unsigned int			m_upgradeDelay;			// draws under the budget required to raise quality
+};
@@ -0,0 +1,375 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "RemoteChannel.h"
+
+//---------------------------------------------------------------------
+// Shared memory header: 'FDXH' signature and protocol version.
+static const DWORD s_remoteSignature = 0x48584446;
+static const DWORD s_remoteVersion = 1;
+
+//---------------------------------------------------------------------
+// Ring capacities. Frame ring holds two full frames of the initial size, within limits.
+static const unsigned int s_commandRingSize = 256 * 1024;
+static const unsigned int s_eventRingSize = 1024 * 1024;
+static const unsigned int s_minFrameRingSize = 4 * 1024 * 1024;
+static const unsigned int s_maxFrameRingSize = 64 * 1024 * 1024;
+
+//---------------------------------------------------------------------
+static unsigned int GetFrameRingSize(unsigned int width, unsigned int height)
+{
+	unsigned int size = s_minFrameRingSize;
+	while (size < s_maxFrameRingSize && size < width * height * 4 * 2)
+		size *= 2;
+	return size;
+}
+
+//---------------------------------------------------------------------
+CRemoteMessage::CRemoteMessage(ERemoteMessage type)
+{
+	m_data.push_back((BYTE)type);
+}
+
+//---------------------------------------------------------------------
+void CRemoteMessage::WriteInt(int value)
+{
+	WriteData(&value, sizeof(value));
+}
+
+//---------------------------------------------------------------------
+void CRemoteMessage::WriteDouble(double value)
+{
+	WriteData(&value, sizeof(value));
+}
+
+//---------------------------------------------------------------------
+void CRemoteMessage::WriteString(const wchar_t* value)
+{
+	WORD length = 0xFFFF;
+	if (value != NULL)
+	{
+		size_t valueLength = wcslen(value);
+		length = (WORD)(valueLength < 0xFFFE ? valueLength : 0xFFFE);
+	}
+
+	WriteData(&length, sizeof(length));
+	if (value != NULL)
+		WriteData(value, length * sizeof(wchar_t));
+}
+
+//---------------------------------------------------------------------
+void CRemoteMessage::WriteData(const void* data, unsigned int size)
+{
+	m_data.insert(m_data.end(), (const BYTE*)data, (const BYTE*)data + size);
+}
+
+//---------------------------------------------------------------------
+const std::vector<BYTE>& CRemoteMessage::GetData() const
+{
+	return m_data;
+}
+
+//---------------------------------------------------------------------
+CRemoteMessageReader::CRemoteMessageReader(const std::vector<BYTE>& message) :
+	m_message(message)
+{
+	m_position = 1;
+	m_valid = !message.empty();
+}
+
+//---------------------------------------------------------------------
+ERemoteMessage CRemoteMessageReader::GetType() const
+{
+	if (m_message.empty() || m_message[0] >= REMOTE_MESSAGE_COUNT)
+		return REMOTE_MESSAGE_COUNT;
+	return (ERemoteMessage)m_message[0];
+}
+
+//---------------------------------------------------------------------
+int CRemoteMessageReader::ReadInt()
+{
+	int value = 0;
+	ReadData(&value, sizeof(value));
+	return value;
+}
+
+//---------------------------------------------------------------------
+double CRemoteMessageReader::ReadDouble()
+{
+	double value = 0.0;
+	ReadData(&value, sizeof(value));
+	return value;
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CRemoteMessageReader::ReadString(std::wstring& value)
+{
+	value.clear();
+
+	WORD length = 0;
+	if (!ReadData(&length, sizeof(length)) || length == 0xFFFF)
+		return NULL;
+
+	if (m_position + length * sizeof(wchar_t) > m_message.size())
+	{
+		m_valid = false;
+		return NULL;
+	}
+
+	value.assign((const wchar_t*)&m_message[m_position], length);
+	m_position += length * sizeof(wchar_t);
+	return value.c_str();
+}
+
+//---------------------------------------------------------------------
+bool CRemoteMessageReader::ReadData(void* data, unsigned int size)
+{
+	if (m_position + size > m_message.size())
+	{
+		memset(data, 0, size);
+		m_valid = false;
+		return false;
+	}
+
+	memcpy(data, &m_message[m_position], size);
+	m_position += size;
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteMessageReader::IsValid() const
+{
+	return m_valid;
+}
+
+//---------------------------------------------------------------------
+CRemoteChannel::CRemoteChannel()
+{
+	m_isHost = false;
+	m_mapping = NULL;
+	m_memory = NULL;
+	m_peerProcess = NULL;
+	m_sendEvent = NULL;
+	m_receiveEvent = NULL;
+	m_frameEvent = NULL;
+}
+
+//---------------------------------------------------------------------
+CRemoteChannel::~CRemoteChannel()
+{
+	if (m_memory)
+		UnmapViewOfFile(m_memory);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_peerProcess)
+		CloseHandle(m_peerProcess);
+	if (m_sendEvent)
+		CloseHandle(m_sendEvent);
+	if (m_receiveEvent)
+		CloseHandle(m_receiveEvent);
+	if (m_frameEvent)
+		CloseHandle(m_frameEvent);
+}
+
+//---------------------------------------------------------------------
+bool CRemoteChannel::Create(const wchar_t* name, unsigned int width, unsigned int height)
+{
+	m_isHost = false;
+
+	unsigned int frameRingSize = GetFrameRingSize(width, height);
+	DWORD commandRingOffset = sizeof(SRemoteHeader);
+	DWORD eventRingOffset = commandRingOffset + CSharedRing::GetMemorySize(s_commandRingSize);
+	DWORD frameRingOffset = eventRingOffset + CSharedRing::GetMemorySize(s_eventRingSize);
+	DWORD memorySize = frameRingOffset + CSharedRing::GetMemorySize(frameRingSize);
+
+	m_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, memorySize, name);
+	if (m_mapping == NULL || GetLastError() == ERROR_ALREADY_EXISTS)
+		return false;
+
+	m_memory = (BYTE*)MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, memorySize);
+	if (m_memory == NULL)
+		return false;
+
+	SRemoteHeader* header = (SRemoteHeader*)m_memory;
+	memset(header, 0, sizeof(SRemoteHeader));
+	header->m_clientProcessId = GetCurrentProcessId();
+	header->m_width = width;
+	header->m_height = height;
+	header->m_commandRingOffset = commandRingOffset;
+	header->m_eventRingOffset = eventRingOffset;
+	header->m_frameRingOffset = frameRingOffset;
+	header->m_timeToNextUpdate = INFINITE;
+
+	m_sendRing.Create(m_memory + commandRingOffset, s_commandRingSize);
+	m_receiveRing.Create(m_memory + eventRingOffset, s_eventRingSize);
+	m_frameRing.Create(m_memory + frameRingOffset, frameRingSize);
+
+	if (!OpenEvents(name, true))
+		return false;
+
+	// Host checks the signature, so it goes last
+	MemoryBarrier();
+	header->m_version = s_remoteVersion;
+	header->m_signature = s_remoteSignature;
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteChannel::Open(const wchar_t* name)
+{
+	m_isHost = true;
+
+	m_mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, name);
+	if (m_mapping == NULL)
+		return false;
+
+	m_memory = (BYTE*)MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (m_memory == NULL)
+		return false;
+
+	SRemoteHeader* header = (SRemoteHeader*)m_memory;
+	if (header->m_signature != s_remoteSignature || header->m_version != s_remoteVersion)
+		return false;
+
+	if (!m_receiveRing.Attach(m_memory + header->m_commandRingOffset) ||
+		!m_sendRing.Attach(m_memory + header->m_eventRingOffset) ||
+		!m_frameRing.Attach(m_memory + header->m_frameRingOffset))
+		return false;
+
+	if (!OpenEvents(name, false))
+		return false;
+
+	m_peerProcess = OpenProcess(SYNCHRONIZE, FALSE, header->m_clientProcessId);
+	return m_peerProcess != NULL;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteChannel::OpenEvents(const wchar_t* name, bool create)
+{
+	std::wstring hostEventName = std::wstring(name) + L"_Host";
+	std::wstring clientEventName = std::wstring(name) + L"_Client";
+	std::wstring frameEventName = std::wstring(name) + L"_Frame";
+
+	HANDLE hostEvent, clientEvent;
+	if (create)
+	{
+		hostEvent = CreateEventW(NULL, FALSE, FALSE, hostEventName.c_str());
+		clientEvent = CreateEventW(NULL, FALSE, FALSE, clientEventName.c_str());
+		m_frameEvent = CreateEventW(NULL, FALSE, FALSE, frameEventName.c_str());
+	}
+	else
+	{
+		hostEvent = OpenEventW(EVENT_ALL_ACCESS, FALSE, hostEventName.c_str());
+		clientEvent = OpenEventW(EVENT_ALL_ACCESS, FALSE, clientEventName.c_str());
+		m_frameEvent = OpenEventW(EVENT_ALL_ACCESS, FALSE, frameEventName.c_str());
+	}
+
+	m_sendEvent = m_isHost ? clientEvent : hostEvent;
+	m_receiveEvent = m_isHost ? hostEvent : clientEvent;
+	return m_sendEvent != NULL && m_receiveEvent != NULL && m_frameEvent != NULL;
+}
+
+//---------------------------------------------------------------------
+void CRemoteChannel::SetPeerProcess(HANDLE process)
+{
+	if (m_peerProcess)
+		CloseHandle(m_peerProcess);
+	m_peerProcess = process;
+}
+
+//---------------------------------------------------------------------
+HANDLE CRemoteChannel::GetPeerProcess() const
+{
+	return m_peerProcess;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteChannel::IsPeerAlive() const
+{
+	return m_peerProcess != NULL && WaitForSingleObject(m_peerProcess, 0) == WAIT_TIMEOUT;
+}
+
+//---------------------------------------------------------------------
+SRemoteHeader* CRemoteChannel::GetHeader()
+{
+	return (SRemoteHeader*)m_memory;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteChannel::Send(const CRemoteMessage& message, unsigned int timeout)
+{
+	const std::vector<BYTE>& data = message.GetData();
+	if (data.size() > m_sendRing.GetMaxMessageSize())
+		return false;
+
+	DWORD startTime = GetTickCount();
+	while (!m_sendRing.Write(&data[0], (unsigned int)data.size()))
+	{
+		if (!IsPeerAlive() || GetTickCount() - startTime >= timeout)
+			return false;
+		Sleep(1);
+	}
+
+	SetEvent(m_sendEvent);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteChannel::Receive(std::vector<BYTE>& message)
+{
+	return m_receiveRing.Read(message);
+}
+
+//---------------------------------------------------------------------
+void CRemoteChannel::Wait(unsigned int timeout, bool dispatchMessages)
+{
+	HANDLE handles[] = { m_receiveEvent, m_peerProcess };
+	DWORD numHandles = m_peerProcess ? 2 : 1;
+
+	if (!dispatchMessages)
+	{
+		WaitForMultipleObjects(numHandles, handles, FALSE, timeout);
+		return;
+	}
+
+	MsgWaitForMultipleObjects(numHandles, handles, FALSE, timeout, QS_ALLINPUT);
+
+	MSG msg;
+	while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+	{
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+}
+
+//---------------------------------------------------------------------
+CSharedRing& CRemoteChannel::GetFrameRing()
+{
+	return m_frameRing;
+}
+
+//---------------------------------------------------------------------
+HANDLE CRemoteChannel::GetFrameEvent()
+{
+	return m_frameEvent;
+}
@@ -0,0 +1,274 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "SharedRing.h"
+
+//---------------------------------------------------------------------
+/// Messages between remote player and its host process. Values are part of the protocol, bump
+/// s_remoteVersion when changing them. Calls marked "replies" are answered with REMOTE_RESULT.
+//---------------------------------------------------------------------
+enum ERemoteMessage
+{
+	// Client to host, calls of IFlashDXPlayer methods
+	REMOTE_SET_QUALITY = 0,			// quality
+	REMOTE_SET_TRANSPARENCY_MODE,	// mode
+	REMOTE_LOAD_MOVIE,				// path; replies success
+	REMOTE_MOVIE_DATA,				// size, part of movie passed to LoadMovie() from memory
+	REMOTE_LOAD_MOVIE_DATA,			// replies success
+	REMOTE_LOAD_MOVIE_ASYNC,		// path; replies success
+	REMOTE_GET_BACKGROUND_COLOR,	// replies color
+	REMOTE_SET_BACKGROUND_COLOR,	// color
+	REMOTE_START_PLAYING,			// target
+	REMOTE_STOP_PLAYING,			// target
+	REMOTE_REWIND,
+	REMOTE_STEP_FORWARD,
+	REMOTE_STEP_BACK,
+	REMOTE_GET_CURRENT_FRAME,		// target; replies frame
+	REMOTE_GOTO_FRAME,				// frame, target
+	REMOTE_CALL_FRAME,				// frame, target
+	REMOTE_GET_CURRENT_LABEL,		// target; replies label
+	REMOTE_GOTO_LABEL,				// label, target
+	REMOTE_CALL_LABEL,				// label, target
+	REMOTE_GET_VARIABLE,			// name; replies value
+	REMOTE_SET_VARIABLE,			// name, value
+	REMOTE_GET_PROPERTY,			// property, target; replies value
+	REMOTE_GET_PROPERTY_NUMBER,		// property, target; replies value
+	REMOTE_SET_PROPERTY,			// property, value, target
+	REMOTE_SET_PROPERTY_NUMBER,		// property, value, target
+	REMOTE_RESIZE,					// width, height; replies surface size
+	REMOTE_SET_RESOLUTION_SCALE,	// scale; replies surface size
+	REMOTE_SET_VISIBLE_RECT,		// has rect, rect
+	REMOTE_SUSPEND,
+	REMOTE_RESUME,
+	REMOTE_SET_AUTO_SUSPEND,		// delay
+	REMOTE_SET_FRAME_CACHE,			// memory limit
+	REMOTE_SET_FRAME_CACHE_KEY,		// key
+	REMOTE_GET_FRAME_CACHE_STATS,	// replies stats
+	REMOTE_SET_FRAME_PACING,		// max rate, use movie frame rate
+	REMOTE_GET_PACING_STATS,		// replies stats
+	REMOTE_RESET_PACING_STATS,
+	REMOTE_SET_ADAPTIVE_QUALITY,	// draw budget, min quality, max quality
+	REMOTE_GET_DRAW_TIMINGS,		// replies success, timings
+	REMOTE_RESET_DRAW_TIMINGS,
+	REMOTE_MOUSE_MOVE,				// x, y
+	REMOTE_MOUSE_BUTTON,			// x, y, button, pressed
+	REMOTE_MOUSE_WHEEL,				// delta
+	REMOTE_KEY,						// pressed, virtual key, extended
+	REMOTE_CHAR,					// character, extended
+	REMOTE_SET_INPUT_BUFFERING,		// enable
+	REMOTE_FLUSH_INPUT,
+	REMOTE_SET_HIT_TEST,			// alpha threshold, filter input
+	REMOTE_START_RECORDING,			// path; replies success
+	REMOTE_STOP_RECORDING,
+	REMOTE_START_REPLAY,			// path; replies success
+	REMOTE_STOP_REPLAY,
+	REMOTE_START_DIRTY_RECT_TRACE,	// path; replies success
+	REMOTE_STOP_DIRTY_RECT_TRACE,
+	REMOTE_GET_COUNTERS,			// replies counters
+	REMOTE_GET_FLASH_CALL_COUNTERS,	// replies number of names, names and counts
+	REMOTE_RESET_COUNTERS,
+	REMOTE_GET_MEMORY_USAGE,		// replies usage
+	REMOTE_ENABLE_SOUND,			// enable
+	REMOTE_CALL_FUNCTION,			// request; replies result
+	REMOTE_RETURN,					// result, return value; answers REMOTE_FLASH_CALL
+	REMOTE_QUIT,
+
+	// Host to client
+	REMOTE_READY,					// player is created
+	REMOTE_RESULT,					// call result
+	REMOTE_FLASH_CALL,				// request; client answers with REMOTE_RETURN
+	REMOTE_FS_COMMAND,				// command, args
+	REMOTE_PROGRESS,				// percent done
+	REMOTE_READY_STATE,				// new state
+	REMOTE_MOVIE_LOADED,			// success
+	REMOTE_FRAME,					// frame ring only: SRemoteFrame, pixels of the rect
+	REMOTE_MESSAGE_COUNT
+};
+
+//---------------------------------------------------------------------
+/// Builds message. Integers are 32 bit, strings are WORD length (0xFFFF for NULL) followed by UTF-16 characters.
+//---------------------------------------------------------------------
+class CRemoteMessage
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CRemoteMessage(ERemoteMessage type);
+
+	//---------------------------------------------------------------------
+	/// Writes arguments.
+	void WriteInt(int value);
+	void WriteDouble(double value);
+	void WriteString(const wchar_t* value);
+	void WriteData(const void* data, unsigned int size);
+
+	//---------------------------------------------------------------------
+	/// Returns encoded message.
+	const std::vector<BYTE>& GetData() const;
+
+protected:
+	std::vector<BYTE>		m_data;
+};
+
+//---------------------------------------------------------------------
+/// Reads message built by CRemoteMessage. Reads past the end return zeros and invalidate the reader.
+//---------------------------------------------------------------------
+class CRemoteMessageReader
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor. Message must outlive the reader.
+	CRemoteMessageReader(const std::vector<BYTE>& message);
+
+	//---------------------------------------------------------------------
+	/// Returns message type, REMOTE_MESSAGE_COUNT for empty or unknown message.
+	ERemoteMessage GetType() const;
+
+	//---------------------------------------------------------------------
+	/// Reads arguments. ReadString() returns NULL for NULL string, value otherwise.
+	int ReadInt();
+	double ReadDouble();
+	const wchar_t* ReadString(std::wstring& value);
+	bool ReadData(void* data, unsigned int size);
+
+	//---------------------------------------------------------------------
+	/// Checks that no read went past the end.
+	bool IsValid() const;
+
+protected:
+	const std::vector<BYTE>& m_message;
+	unsigned int			m_position;
+	bool					m_valid;
+};
+
+//---------------------------------------------------------------------
+/// Part of a frame, follows REMOTE_FRAME type in the frame ring. Rows of the rect follow it without gaps.
+//---------------------------------------------------------------------
+struct SRemoteFrame
+{
+	int						m_surfaceWidth;
+	int						m_surfaceHeight;
+	RECT					m_rect;
+	int						m_last;				// frame is complete, its rects may be drawn
+};
+
+//---------------------------------------------------------------------
+/// Beginning of the memory shared by remote player and its host.
+//---------------------------------------------------------------------
+struct SRemoteHeader
+{
+	DWORD					m_signature;
+	DWORD					m_version;
+	DWORD					m_clientProcessId;
+	DWORD					m_width;			// size of the player created by the host
+	DWORD					m_height;
+	DWORD					m_commandRingOffset;
+	DWORD					m_eventRingOffset;
+	DWORD					m_frameRingOffset;
+
+	// Player status, published by the host after every update
+	volatile LONG			m_state;
+	volatile LONG			m_quality;
+	volatile LONG			m_movieLoading;
+	volatile LONG			m_suspended;
+	volatile LONG			m_replaying;
+	volatile LONG			m_timeToNextUpdate;
+	volatile LONG			m_averageDrawTime;	// microseconds
+};
+
+//---------------------------------------------------------------------
+/// Two way connection between remote player and its host over named shared memory.
+/// Commands go to the host, results and events come back on another ring, frames on the third one.
+//---------------------------------------------------------------------
+class CRemoteChannel
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CRemoteChannel();
+
+	//---------------------------------------------------------------------
+	/// Destructor. Closes the connection.
+	~CRemoteChannel();
+
+	//---------------------------------------------------------------------
+	/// Creates shared memory and events. Called by the client.
+	bool Create(const wchar_t* name, unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Opens the channel created by the client and its process. Called by the host.
+	bool Open(const wchar_t* name);
+
+	//---------------------------------------------------------------------
+	/// Sets process on the other side, the channel takes ownership of the handle.
+	void SetPeerProcess(HANDLE process);
+	HANDLE GetPeerProcess() const;
+
+	//---------------------------------------------------------------------
+	/// Checks if the other side is still running.
+	bool IsPeerAlive() const;
+
+	//---------------------------------------------------------------------
+	/// Returns shared header.
+	SRemoteHeader* GetHeader();
+
+	//---------------------------------------------------------------------
+	/// Sends message, waiting up to timeout milliseconds for room while the other side is alive.
+	/// Zero timeout drops the message at once if the ring is full.
+	bool Send(const CRemoteMessage& message, unsigned int timeout = INFINITE);
+
+	//---------------------------------------------------------------------
+	/// Takes next message from the other side. Returns false if there are none.
+	bool Receive(std::vector<BYTE>& message);
+
+	//---------------------------------------------------------------------
+	/// Waits for a message from the other side or its exit, optionally dispatching window messages meanwhile.
+	void Wait(unsigned int timeout, bool dispatchMessages = false);
+
+	//---------------------------------------------------------------------
+	/// Frame ring, written by the host and read by the client.
+	CSharedRing& GetFrameRing();
+
+	//---------------------------------------------------------------------
+	/// Auto reset event set by the host when a frame is complete or an event is sent.
+	HANDLE GetFrameEvent();
+
+protected:
+	//---------------------------------------------------------------------
+	bool OpenEvents(const wchar_t* name, bool create);
+
+protected:
+	bool					m_isHost;
+	HANDLE					m_mapping;
+	BYTE*					m_memory;
+	HANDLE					m_peerProcess;
+
+	CSharedRing				m_sendRing;
+	CSharedRing				m_receiveRing;
+	CSharedRing				m_frameRing;
+
+	HANDLE					m_sendEvent;		// set after sending, the other side waits on it
+	HANDLE					m_receiveEvent;
+	HANDLE					m_frameEvent;
+};
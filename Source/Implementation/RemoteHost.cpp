@@ -0,0 +1,675 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "RemoteHost.h"
+
+//---------------------------------------------------------------------
+// Longest sleep of the host loop, Flash wakes it up earlier through window messages.
+static const unsigned int s_maxWaitTime = 100;
+// Sleep while the frame ring is full and the client hasn't taken the previous parts yet.
+static const unsigned int s_frameRetryTime = 2;
+
+//---------------------------------------------------------------------
+CRemoteHost::CRemoteHost()
+{
+	m_player = NULL;
+	m_running = false;
+
+	m_surfaceDC = NULL;
+	m_surfaceBitmap = NULL;
+	m_surfaceBits = NULL;
+	m_surfaceWidth = 0;
+	m_surfaceHeight = 0;
+
+	m_sendingRect = 0;
+	m_sendingRow = 0;
+}
+
+//---------------------------------------------------------------------
+CRemoteHost::~CRemoteHost()
+{
+	ReleaseSurface();
+}
+
+//---------------------------------------------------------------------
+bool CRemoteHost::Run(IFlashDX* flashDX, const wchar_t* channelName)
+{
+	if (!m_channel.Open(channelName))
+		return false;
+
+	SRemoteHeader* header = m_channel.GetHeader();
+	m_player = flashDX->CreatePlayer(header->m_width, header->m_height);
+	if (m_player == NULL)
+		return false;
+
+	m_player->AddEventHandler(this);
+	PublishStatus();
+
+	m_running = m_channel.Send(CRemoteMessage(REMOTE_READY));
+	while (m_running && m_channel.IsPeerAlive())
+	{
+		ProcessCommands(NULL);
+		if (!m_running)
+			break;
+
+		Update();
+		PublishStatus();
+
+		unsigned int timeout = m_sendingRects.empty() ? min(m_player->GetTimeToNextUpdate(), s_maxWaitTime) : s_frameRetryTime;
+		m_channel.Wait(timeout, true);
+	}
+
+	m_player->RemoveEventHandler(this);
+	flashDX->DestroyPlayer(m_player);
+	m_player = NULL;
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteHost::ProcessCommands(std::vector<BYTE>* returnMessage)
+{
+	std::vector<BYTE> message;
+	while (m_running && m_channel.Receive(message))
+	{
+		if (CRemoteMessageReader(message).GetType() != REMOTE_RETURN)
+		{
+			ExecuteCommand(message);
+			continue;
+		}
+
+		// Answer to FlashCall() is taken by the innermost call waiting for it
+		if (returnMessage != NULL)
+		{
+			returnMessage->swap(message);
+			return false;
+		}
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::ExecuteCommand(const std::vector<BYTE>& message)
+{
+	CRemoteMessageReader reader(message);
+	CRemoteMessage result(REMOTE_RESULT);
+	int arg0 = 0, arg1 = 0, arg2 = 0, arg3 = 0;
+	double number = 0.0;
+	std::wstring string0, string1;
+	const wchar_t* text0;
+	const wchar_t* text1;
+
+	switch (reader.GetType())
+	{
+	case REMOTE_SET_QUALITY:
+		m_player->SetQuality((IFlashDXPlayer::EQuality)reader.ReadInt());
+		break;
+	case REMOTE_SET_TRANSPARENCY_MODE:
+		m_player->SetTransparencyMode((IFlashDXPlayer::ETransparencyMode)reader.ReadInt());
+		break;
+	case REMOTE_LOAD_MOVIE:
+		text0 = reader.ReadString(string0);
+		result.WriteInt(m_player->LoadMovie(text0));
+		SendResult(result);
+		break;
+	case REMOTE_MOVIE_DATA:
+		arg0 = reader.ReadInt();
+		if (arg0 > 0)
+		{
+			unsigned int offset = (unsigned int)m_movieData.size();
+			m_movieData.resize(offset + arg0);
+			reader.ReadData(&m_movieData[offset], arg0);
+		}
+		break;
+	case REMOTE_LOAD_MOVIE_DATA:
+		result.WriteInt(!m_movieData.empty() && m_player->LoadMovie(&m_movieData[0], (unsigned int)m_movieData.size()));
+		std::vector<BYTE>().swap(m_movieData);
+		SendResult(result);
+		break;
+	case REMOTE_LOAD_MOVIE_ASYNC:
+		text0 = reader.ReadString(string0);
+		result.WriteInt(m_player->LoadMovieAsync(text0));
+		SendResult(result);
+		break;
+	case REMOTE_GET_BACKGROUND_COLOR:
+		result.WriteInt((int)m_player->GetBackgroundColor());
+		SendResult(result);
+		break;
+	case REMOTE_SET_BACKGROUND_COLOR:
+		m_player->SetBackgroundColor((COLORREF)reader.ReadInt());
+		break;
+	case REMOTE_START_PLAYING:
+		text0 = reader.ReadString(string0);
+		if (text0)
+			m_player->StartPlaying(text0);
+		else
+			m_player->StartPlaying();
+		break;
+	case REMOTE_STOP_PLAYING:
+		text0 = reader.ReadString(string0);
+		if (text0)
+			m_player->StopPlaying(text0);
+		else
+			m_player->StopPlaying();
+		break;
+	case REMOTE_REWIND:
+		m_player->Rewind();
+		break;
+	case REMOTE_STEP_FORWARD:
+		m_player->StepForward();
+		break;
+	case REMOTE_STEP_BACK:
+		m_player->StepBack();
+		break;
+	case REMOTE_GET_CURRENT_FRAME:
+		text0 = reader.ReadString(string0);
+		if (text0)
+			result.WriteInt(m_player->GetCurrentFrame(text0));
+		else
+		{
+			// Plain call would be ambiguous with the defaulted overload
+			int (IFlashDXPlayer::*getCurrentFrame)() = &IFlashDXPlayer::GetCurrentFrame;
+			result.WriteInt((m_player->*getCurrentFrame)());
+		}
+		SendResult(result);
+		break;
+	case REMOTE_GOTO_FRAME:
+		arg0 = reader.ReadInt();
+		text0 = reader.ReadString(string0);
+		if (text0)
+			m_player->GotoFrame(arg0, text0);
+		else
+			m_player->GotoFrame(arg0);
+		break;
+	case REMOTE_CALL_FRAME:
+		arg0 = reader.ReadInt();
+		text0 = reader.ReadString(string0);
+		m_player->CallFrame(arg0, text0);
+		break;
+	case REMOTE_GET_CURRENT_LABEL:
+		text0 = reader.ReadString(string0);
+		result.WriteString(m_player->GetCurrentLabel(text0));
+		SendResult(result);
+		break;
+	case REMOTE_GOTO_LABEL:
+		text0 = reader.ReadString(string0);
+		text1 = reader.ReadString(string1);
+		m_player->GotoLabel(text0, text1);
+		break;
+	case REMOTE_CALL_LABEL:
+		text0 = reader.ReadString(string0);
+		text1 = reader.ReadString(string1);
+		m_player->CallLabel(text0, text1);
+		break;
+	case REMOTE_GET_VARIABLE:
+		text0 = reader.ReadString(string0);
+		result.WriteString(m_player->GetVariable(text0));
+		SendResult(result);
+		break;
+	case REMOTE_SET_VARIABLE:
+		text0 = reader.ReadString(string0);
+		text1 = reader.ReadString(string1);
+		m_player->SetVariable(text0, text1);
+		break;
+	case REMOTE_GET_PROPERTY:
+		arg0 = reader.ReadInt();
+		text0 = reader.ReadString(string0);
+		result.WriteString(m_player->GetProperty(arg0, text0));
+		SendResult(result);
+		break;
+	case REMOTE_GET_PROPERTY_NUMBER:
+		arg0 = reader.ReadInt();
+		text0 = reader.ReadString(string0);
+		result.WriteDouble(m_player->GetPropertyAsNumber(arg0, text0));
+		SendResult(result);
+		break;
+	case REMOTE_SET_PROPERTY:
+		arg0 = reader.ReadInt();
+		text0 = reader.ReadString(string0);
+		text1 = reader.ReadString(string1);
+		m_player->SetProperty(arg0, text0, text1);
+		break;
+	case REMOTE_SET_PROPERTY_NUMBER:
+		arg0 = reader.ReadInt();
+		number = reader.ReadDouble();
+		text0 = reader.ReadString(string0);
+		m_player->SetProperty(arg0, number, text0);
+		break;
+	case REMOTE_RESIZE:
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		m_player->ResizePlayer(arg0, arg1);
+		result.WriteInt(m_player->GetSurfaceWidth());
+		result.WriteInt(m_player->GetSurfaceHeight());
+		SendResult(result);
+		break;
+	case REMOTE_SET_RESOLUTION_SCALE:
+		m_player->SetResolutionScale((float)reader.ReadDouble());
+		result.WriteInt(m_player->GetSurfaceWidth());
+		result.WriteInt(m_player->GetSurfaceHeight());
+		SendResult(result);
+		break;
+	case REMOTE_SET_VISIBLE_RECT:
+		{
+			arg0 = reader.ReadInt();
+			RECT rect;
+			reader.ReadData(&rect, sizeof(rect));
+			m_player->SetVisibleRect(arg0 ? &rect : NULL);
+		}
+		break;
+	case REMOTE_SUSPEND:
+		m_player->Suspend();
+		break;
+	case REMOTE_RESUME:
+		m_player->Resume();
+		break;
+	case REMOTE_SET_AUTO_SUSPEND:
+		m_player->SetAutoSuspend(reader.ReadInt());
+		break;
+	case REMOTE_SET_FRAME_CACHE:
+		m_player->SetFrameCache(reader.ReadInt());
+		break;
+	case REMOTE_SET_FRAME_CACHE_KEY:
+		text0 = reader.ReadString(string0);
+		m_player->SetFrameCacheKey(text0);
+		break;
+	case REMOTE_GET_FRAME_CACHE_STATS:
+		{
+			IFlashDXPlayer::SFrameCacheStats stats;
+			m_player->GetFrameCacheStats(stats);
+			result.WriteData(&stats, sizeof(stats));
+			SendResult(result);
+		}
+		break;
+	case REMOTE_SET_FRAME_PACING:
+		number = reader.ReadDouble();
+		arg0 = reader.ReadInt();
+		m_player->SetFramePacing((float)number, arg0 != 0);
+		break;
+	case REMOTE_GET_PACING_STATS:
+		{
+			IFlashDXPlayer::SPacingStats stats;
+			m_player->GetPacingStats(stats);
+			result.WriteData(&stats, sizeof(stats));
+			SendResult(result);
+		}
+		break;
+	case REMOTE_RESET_PACING_STATS:
+		m_player->ResetPacingStats();
+		break;
+	case REMOTE_SET_ADAPTIVE_QUALITY:
+		number = reader.ReadDouble();
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		m_player->SetAdaptiveQuality((float)number, (IFlashDXPlayer::EQuality)arg0, (IFlashDXPlayer::EQuality)arg1);
+		break;
+	case REMOTE_GET_DRAW_TIMINGS:
+		{
+			IFlashDXPlayer::SDrawTimings timings;
+			result.WriteInt(m_player->GetDrawTimings(timings));
+			result.WriteData(&timings, sizeof(timings));
+			SendResult(result);
+		}
+		break;
+	case REMOTE_RESET_DRAW_TIMINGS:
+		m_player->ResetDrawTimings();
+		break;
+	case REMOTE_MOUSE_MOVE:
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		m_player->SetMousePos(arg0, arg1);
+		break;
+	case REMOTE_MOUSE_BUTTON:
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		arg2 = reader.ReadInt();
+		arg3 = reader.ReadInt();
+		m_player->SetMouseButtonState(arg0, arg1, (IFlashDXPlayer::EMouseButton)arg2, arg3 != 0);
+		break;
+	case REMOTE_MOUSE_WHEEL:
+		m_player->SendMouseWheel(reader.ReadInt());
+		break;
+	case REMOTE_KEY:
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		arg2 = reader.ReadInt();
+		m_player->SendKey(arg0 != 0, (UINT_PTR)arg1, (LONG_PTR)arg2);
+		break;
+	case REMOTE_CHAR:
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		m_player->SendChar((UINT_PTR)arg0, (LONG_PTR)arg1);
+		break;
+	case REMOTE_SET_INPUT_BUFFERING:
+		m_player->SetInputBuffering(reader.ReadInt() != 0);
+		break;
+	case REMOTE_FLUSH_INPUT:
+		m_player->FlushInput();
+		break;
+	case REMOTE_SET_HIT_TEST:
+		arg0 = reader.ReadInt();
+		arg1 = reader.ReadInt();
+		m_player->SetHitTest((unsigned char)arg0, arg1 != 0);
+		break;
+	case REMOTE_START_RECORDING:
+		text0 = reader.ReadString(string0);
+		result.WriteInt(m_player->StartRecording(text0));
+		SendResult(result);
+		break;
+	case REMOTE_STOP_RECORDING:
+		m_player->StopRecording();
+		break;
+	case REMOTE_START_REPLAY:
+		text0 = reader.ReadString(string0);
+		result.WriteInt(m_player->StartReplay(text0));
+		SendResult(result);
+		break;
+	case REMOTE_STOP_REPLAY:
+		m_player->StopReplay();
+		break;
+	case REMOTE_START_DIRTY_RECT_TRACE:
+		text0 = reader.ReadString(string0);
+		result.WriteInt(m_player->StartDirtyRectTrace(text0));
+		SendResult(result);
+		break;
+	case REMOTE_STOP_DIRTY_RECT_TRACE:
+		m_player->StopDirtyRectTrace();
+		break;
+	case REMOTE_GET_COUNTERS:
+		{
+			IFlashDXPlayer::SCounters counters;
+			m_player->GetCounters(counters);
+			result.WriteData(&counters, sizeof(counters));
+			SendResult(result);
+		}
+		break;
+	case REMOTE_GET_FLASH_CALL_COUNTERS:
+		{
+			std::vector<IFlashDXPlayer::SFlashCallCounter> counters(m_player->GetFlashCallCounters(NULL, 0));
+			if (!counters.empty())
+				m_player->GetFlashCallCounters(&counters[0], (unsigned int)counters.size());
+
+			result.WriteInt((int)counters.size());
+			for (unsigned int i = 0; i < counters.size(); ++i)
+			{
+				result.WriteString(counters[i].m_name);
+				result.WriteInt(counters[i].m_numCalls);
+			}
+			SendResult(result);
+		}
+		break;
+	case REMOTE_RESET_COUNTERS:
+		m_player->ResetCounters();
+		break;
+	case REMOTE_GET_MEMORY_USAGE:
+		{
+			IFlashDXPlayer::SMemoryUsage usage;
+			m_player->GetMemoryUsage(usage);
+
+			// Copy of the surface frames are sent from
+			unsigned int surfaceSize = m_surfaceWidth * m_surfaceHeight * 4;
+			usage.m_frameBuffer += surfaceSize;
+			usage.m_total += surfaceSize;
+
+			result.WriteData(&usage, sizeof(usage));
+			SendResult(result);
+		}
+		break;
+	case REMOTE_ENABLE_SOUND:
+		m_player->EnableSound(reader.ReadInt() != 0);
+		break;
+	case REMOTE_CALL_FUNCTION:
+		text0 = reader.ReadString(string0);
+		result.WriteString(m_player->CallFunction(text0));
+		SendResult(result);
+		break;
+	case REMOTE_QUIT:
+		m_running = false;
+		break;
+	default:
+		break;
+	}
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::SendResult(CRemoteMessage& result)
+{
+	// Status read by the client right after the call has to reflect it
+	PublishStatus();
+	m_channel.Send(result);
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::SendEvent(const CRemoteMessage& event)
+{
+	m_channel.Send(event);
+
+	// Client may sleep on its dirty event rather than poll
+	SetEvent(m_channel.GetFrameEvent());
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::PublishStatus()
+{
+	SRemoteHeader* header = m_channel.GetHeader();
+	header->m_state = m_player->GetState();
+	header->m_quality = m_player->GetQuality();
+	header->m_movieLoading = m_player->IsMovieLoading();
+	header->m_suspended = m_player->IsSuspended();
+	header->m_replaying = m_player->IsReplaying();
+	header->m_timeToNextUpdate = m_player->GetTimeToNextUpdate();
+	header->m_averageDrawTime = (LONG)(m_player->GetAverageDrawTime() * 1000.0f);
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::Update()
+{
+	const RECT* dirtyRects = NULL;
+	unsigned int numDirtyRects = 0;
+	if (m_player->IsNeedUpdate(NULL, &dirtyRects, &numDirtyRects) && PrepareSurface())
+	{
+		for (unsigned int i = 0; i < numDirtyRects; ++i)
+			m_pendingRects.Add(dirtyRects[i], m_surfaceWidth, m_surfaceHeight);
+
+		m_player->DrawFrame(m_surfaceDC);
+	}
+
+	// Rects drawn while the previous frame is being sent wait for it, the ring is never waited for
+	if (m_sendingRects.empty() && !m_pendingRects.GetRects().empty())
+	{
+		m_pendingRects.Reduce();
+		m_sendingRects = m_pendingRects.GetRects();
+		m_pendingRects.Clear();
+		m_sendingRect = 0;
+		m_sendingRow = m_sendingRects[0].top;
+	}
+
+	if (!m_sendingRects.empty() && SendFrame())
+		m_sendingRects.clear();
+}
+
+//---------------------------------------------------------------------
+bool CRemoteHost::PrepareSurface()
+{
+	unsigned int width = m_player->GetSurfaceWidth();
+	unsigned int height = m_player->GetSurfaceHeight();
+	if (m_surfaceDC != NULL && m_surfaceWidth == width && m_surfaceHeight == height)
+		return true;
+
+	ReleaseSurface();
+
+	if (width == 0 || height == 0)
+		return false;
+
+	BITMAPINFOHEADER bih = {0};
+	bih.biSize = sizeof(BITMAPINFOHEADER);
+	bih.biBitCount = 32;
+	bih.biCompression = BI_RGB;
+	bih.biPlanes = 1;
+	bih.biWidth = LONG(width);
+	bih.biHeight = -LONG(height);
+
+	m_surfaceDC = CreateCompatibleDC(NULL);
+	m_surfaceBitmap = CreateDIBSection(m_surfaceDC, (BITMAPINFO*)&bih, DIB_RGB_COLORS, (void**)&m_surfaceBits, 0, 0);
+	if (m_surfaceBitmap == NULL)
+	{
+		ReleaseSurface();
+		return false;
+	}
+
+	SelectObject(m_surfaceDC, m_surfaceBitmap);
+	m_surfaceWidth = width;
+	m_surfaceHeight = height;
+
+	// Resized player redraws everything, parts of the old size are of no use
+	m_pendingRects.Clear();
+	m_sendingRects.clear();
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::ReleaseSurface()
+{
+	if (m_surfaceDC)
+		DeleteDC(m_surfaceDC);
+	if (m_surfaceBitmap)
+		DeleteObject(m_surfaceBitmap);
+
+	m_surfaceDC = NULL;
+	m_surfaceBitmap = NULL;
+	m_surfaceBits = NULL;
+	m_surfaceWidth = 0;
+	m_surfaceHeight = 0;
+}
+
+//---------------------------------------------------------------------
+bool CRemoteHost::SendFrame()
+{
+	CSharedRing& ring = m_channel.GetFrameRing();
+
+	// Parts are a quarter of the ring at most, so the client can drain some while more are written
+	const unsigned int maxPartSize = ring.GetMaxMessageSize() / 4 - sizeof(BYTE) - sizeof(SRemoteFrame);
+
+	while (m_sendingRect < m_sendingRects.size())
+	{
+		const RECT& rect = m_sendingRects[m_sendingRect];
+		LONG rowSize = (rect.right - rect.left) * 4;
+		LONG numRows = rect.bottom - m_sendingRow;
+
+		if (rowSize > 0 && numRows > 0)
+		{
+			numRows = max(min(numRows, LONG(maxPartSize) / rowSize), 1);
+
+			SRemoteFrame frame;
+			frame.m_surfaceWidth = m_surfaceWidth;
+			frame.m_surfaceHeight = m_surfaceHeight;
+			SetRect(&frame.m_rect, rect.left, m_sendingRow, rect.right, m_sendingRow + numRows);
+			frame.m_last = m_sendingRect + 1 == m_sendingRects.size() && frame.m_rect.bottom == rect.bottom;
+
+			if (!ring.BeginWrite(sizeof(BYTE) + sizeof(frame) + rowSize * numRows))
+				return false;
+
+			BYTE type = REMOTE_FRAME;
+			ring.WriteData(&type, sizeof(type));
+			ring.WriteData(&frame, sizeof(frame));
+			for (LONG y = frame.m_rect.top; y < frame.m_rect.bottom; ++y)
+				ring.WriteData(m_surfaceBits + (y * m_surfaceWidth + rect.left) * 4, rowSize);
+			ring.EndWrite();
+
+			m_sendingRow += numRows;
+		}
+
+		if (rowSize <= 0 || m_sendingRow >= rect.bottom)
+		{
+			if (++m_sendingRect < m_sendingRects.size())
+				m_sendingRow = m_sendingRects[m_sendingRect].top;
+		}
+	}
+
+	SetEvent(m_channel.GetFrameEvent());
+	return true;
+}
+
+//---------------------------------------------------------------------
+HRESULT CRemoteHost::FlashCall(const wchar_t* request)
+{
+	CRemoteMessage call(REMOTE_FLASH_CALL);
+	call.WriteString(request);
+	SendEvent(call);
+
+	// Client calls into the player while handling the request, serve it until the answer comes
+	std::vector<BYTE> answer;
+	while (m_running && ProcessCommands(&answer))
+	{
+		if (!m_channel.IsPeerAlive())
+		{
+			m_running = false;
+			break;
+		}
+		m_channel.Wait(s_maxWaitTime);
+	}
+
+	if (answer.empty())
+		return E_FAIL;
+
+	CRemoteMessageReader reader(answer);
+	std::wstring returnValue;
+	HRESULT result = (HRESULT)reader.ReadInt();
+	const wchar_t* value = reader.ReadString(returnValue);
+	if (value)
+		m_player->SetReturnValue(value);
+	return result;
+}
+
+//---------------------------------------------------------------------
+HRESULT CRemoteHost::FSCommand(const wchar_t* command, const wchar_t* args)
+{
+	CRemoteMessage event(REMOTE_FS_COMMAND);
+	event.WriteString(command);
+	event.WriteString(args);
+	SendEvent(event);
+	return S_OK;
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::OnProgress(long percentDone)
+{
+	CRemoteMessage event(REMOTE_PROGRESS);
+	event.WriteInt(percentDone);
+	SendEvent(event);
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::OnReadyStateChange(long newState)
+{
+	CRemoteMessage event(REMOTE_READY_STATE);
+	event.WriteInt(newState);
+	SendEvent(event);
+}
+
+//---------------------------------------------------------------------
+void CRemoteHost::OnMovieLoaded(bool success)
+{
+	CRemoteMessage event(REMOTE_MOVIE_LOADED);
+	event.WriteInt(success);
+	SendEvent(event);
+}
@@ -0,0 +1,95 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+#include "DirtyRects.h"
+#include "RemoteChannel.h"
+
+//---------------------------------------------------------------------
+/// Runs player in the helper process on behalf of CRemotePlayer in the client process.
+/// Executes commands from the client, forwards player events and streams dirty parts of frames back.
+//---------------------------------------------------------------------
+class CRemoteHost : public IFlashDXEventHandler
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CRemoteHost();
+
+	//---------------------------------------------------------------------
+	/// Destructor.
+	virtual ~CRemoteHost();
+
+	//---------------------------------------------------------------------
+	/// Connects to the client and serves it until it quits or exits. Called on the thread that owns players.
+	bool Run(IFlashDX* flashDX, const wchar_t* channelName);
+
+	//---------------------------------------------------------------------
+	// IFlashDXEventHandler implementation.
+	virtual HRESULT FlashCall(const wchar_t* request);
+	virtual HRESULT FSCommand(const wchar_t* command, const wchar_t* args);
+	virtual void OnProgress(long percentDone);
+	virtual void OnReadyStateChange(long newState);
+	virtual void OnMovieLoaded(bool success);
+
+protected:
+	//---------------------------------------------------------------------
+	/// Executes received commands. Stops and returns false at REMOTE_RETURN if returnMessage is given.
+	bool ProcessCommands(std::vector<BYTE>* returnMessage);
+	//---------------------------------------------------------------------
+	void ExecuteCommand(const std::vector<BYTE>& message);
+	//---------------------------------------------------------------------
+	/// Draws the player if it is dirty and sends what fits into the frame ring.
+	void Update();
+	//---------------------------------------------------------------------
+	bool PrepareSurface();
+	void ReleaseSurface();
+	//---------------------------------------------------------------------
+	/// Writes next parts of the frame being sent. Returns false if the ring is full.
+	bool SendFrame();
+	//---------------------------------------------------------------------
+	void PublishStatus();
+	//---------------------------------------------------------------------
+	void SendResult(CRemoteMessage& result);
+	void SendEvent(const CRemoteMessage& event);
+
+protected:
+	CRemoteChannel			m_channel;
+	IFlashDXPlayer*			m_player;
+	bool					m_running;
+	std::vector<BYTE>		m_movieData;			// collected REMOTE_MOVIE_DATA parts
+
+	// Copy of the player surface, frames are read from here
+	HDC						m_surfaceDC;
+	HBITMAP					m_surfaceBitmap;
+	BYTE*					m_surfaceBits;
+	unsigned int			m_surfaceWidth;
+	unsigned int			m_surfaceHeight;
+
+	// Rects drawn since the frame being sent was taken, and that frame
+	CDirtyRects				m_pendingRects;
+	std::vector<RECT>		m_sendingRects;
+	unsigned int			m_sendingRect;
+	LONG					m_sendingRow;
+};
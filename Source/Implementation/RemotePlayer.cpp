@@ -0,0 +1,1162 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "RemotePlayer.h"
+#include <algorithm>
+
+//---------------------------------------------------------------------
+// Time the host has to create its player, and to quit before it is terminated, in milliseconds.
+static const unsigned int s_startTimeout = 10000;
+static const unsigned int s_quitTimeout = 2000;
+// Longest sleep while waiting for the host, its exit is noticed earlier.
+static const unsigned int s_maxWaitTime = 100;
+// Host that neither makes room for a command nor sends anything back for this long is terminated.
+static const unsigned int s_callTimeout = 10000;
+// Movies loaded from memory are sent in parts, well below the command ring capacity.
+static const unsigned int s_movieDataPartSize = 64 * 1024;
+
+//---------------------------------------------------------------------
+// Makes channel names unique within the process.
+static volatile LONG s_numChannels = 0;
+
+//---------------------------------------------------------------------
+CRemotePlayer::CRemotePlayer(unsigned int width, unsigned int height)
+{
+	m_header = NULL;
+	m_userData = 0;
+	m_transpMode = TMODE_OPAQUE;
+	m_width = width;
+	m_height = height;
+	m_surfaceWidth = width;
+	m_surfaceHeight = height;
+	m_resolutionScale = 1.0f;
+	m_critical = true;
+	m_hitTestThreshold = 0;
+
+	m_frameDC = NULL;
+	m_frameBitmap = NULL;
+	m_frameBits = NULL;
+	m_frameWidth = 0;
+	m_frameHeight = 0;
+	SetRectEmpty(&m_updateUnionRect);
+
+	m_dirtyCallback = NULL;
+	m_dirtyCallbackContext = NULL;
+	m_hasReturnValue = false;
+	m_lastHostActivity = 0;
+}
+
+//---------------------------------------------------------------------
+CRemotePlayer::~CRemotePlayer()
+{
+	HANDLE process = m_channel.GetPeerProcess();
+	if (m_channel.IsPeerAlive())
+	{
+		m_channel.Send(CRemoteMessage(REMOTE_QUIT), s_quitTimeout);
+		if (WaitForSingleObject(process, s_quitTimeout) != WAIT_OBJECT_0)
+			TerminateProcess(process, 1);
+	}
+
+	ReleaseFrameBuffer();
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::Start(const wchar_t* hostCommandLine)
+{
+	wchar_t name[64];
+	swprintf_s(name, L"Local\\FlashDX_%u_%d", (unsigned int)GetCurrentProcessId(), (int)InterlockedIncrement(&s_numChannels));
+
+	if (!m_channel.Create(name, m_width, m_height))
+		return false;
+	m_header = m_channel.GetHeader();
+
+	// CreateProcessW() may modify the command line
+	std::wstring commandLine = std::wstring(hostCommandLine) + L" " + name;
+	std::vector<wchar_t> commandLineBuffer(commandLine.begin(), commandLine.end());
+	commandLineBuffer.push_back(0);
+
+	STARTUPINFOW startupInfo = {0};
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo = {0};
+	if (!CreateProcessW(NULL, &commandLineBuffer[0], NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &startupInfo, &processInfo))
+		return false;
+
+	CloseHandle(processInfo.hThread);
+	m_channel.SetPeerProcess(processInfo.hProcess);
+
+	DWORD startTime = GetTickCount();
+	std::vector<BYTE> message;
+	while (m_channel.IsPeerAlive() && GetTickCount() - startTime < s_startTimeout)
+	{
+		while (m_channel.Receive(message))
+		{
+			if (CRemoteMessageReader(message).GetType() == REMOTE_READY)
+				return true;
+		}
+		m_channel.Wait(s_maxWaitTime);
+	}
+
+	TerminateProcess(processInfo.hProcess, 1);
+	return false;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::Send(const CRemoteMessage& message)
+{
+	DWORD startTime = GetTickCount();
+	if (m_channel.Send(message, s_callTimeout))
+		return true;
+
+	// Oversized message fails at once, only waiting out the whole timeout means the host is stuck
+	if (GetTickCount() - startTime >= s_callTimeout && m_channel.IsPeerAlive())
+		AbandonHost();
+	return false;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SendInput(const CRemoteMessage& message)
+{
+	// Stale input is worth less than a blocked client
+	m_channel.Send(message, 0);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::AbandonHost()
+{
+	HANDLE process = m_channel.GetPeerProcess();
+	TerminateProcess(process, 1);
+	WaitForSingleObject(process, s_quitTimeout);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::Call(const CRemoteMessage& call, std::vector<BYTE>& result)
+{
+	result.clear();
+	if (!Send(call))
+		return;
+
+	// Events coming back prove the host is alive, so long FlashCall chains don't time out
+	m_lastHostActivity = GetTickCount();
+	while (!Pump(&result))
+	{
+		if (!m_channel.IsPeerAlive())
+		{
+			result.clear();
+			return;
+		}
+		if (GetTickCount() - m_lastHostActivity >= s_callTimeout)
+		{
+			AbandonHost();
+			result.clear();
+			return;
+		}
+		m_channel.Wait(s_maxWaitTime);
+	}
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::CallWithPath(ERemoteMessage type, const wchar_t* path)
+{
+	CRemoteMessage call(type);
+	call.WriteString(path);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return CRemoteMessageReader(result).ReadInt() != 0;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::Pump(std::vector<BYTE>* result)
+{
+	ReceiveFrames();
+
+	std::vector<BYTE> message;
+	while (m_channel.Receive(message))
+	{
+		m_lastHostActivity = GetTickCount();
+
+		if (CRemoteMessageReader(message).GetType() != REMOTE_RESULT)
+			HandleEvent(message);
+		else if (result != NULL)
+		{
+			result->swap(message);
+			return true;
+		}
+	}
+	return false;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::HandleEvent(const std::vector<BYTE>& message)
+{
+	CRemoteMessageReader reader(message);
+	std::wstring string0, string1;
+	const wchar_t* text0;
+	const wchar_t* text1;
+
+	switch (reader.GetType())
+	{
+	case REMOTE_FLASH_CALL:
+		{
+			text0 = reader.ReadString(string0);
+
+			// Handlers may make calls that end up in nested FlashCall
+			std::wstring returnValue;
+			bool hasReturnValue = m_hasReturnValue;
+			m_returnValue.swap(returnValue);
+			m_hasReturnValue = false;
+
+			HRESULT result = E_NOTIMPL;
+			for (unsigned int i = 0; i < m_eventHandlers.size() && result == E_NOTIMPL; ++i)
+				result = m_eventHandlers[i]->FlashCall(text0);
+
+			CRemoteMessage answer(REMOTE_RETURN);
+			answer.WriteInt(result);
+			answer.WriteString(m_hasReturnValue ? m_returnValue.c_str() : NULL);
+			Send(answer);
+
+			m_returnValue.swap(returnValue);
+			m_hasReturnValue = hasReturnValue;
+		}
+		break;
+	case REMOTE_FS_COMMAND:
+		{
+			text0 = reader.ReadString(string0);
+			text1 = reader.ReadString(string1);
+
+			HRESULT result = E_NOTIMPL;
+			for (unsigned int i = 0; i < m_eventHandlers.size() && result == E_NOTIMPL; ++i)
+				result = m_eventHandlers[i]->FSCommand(text0, text1);
+		}
+		break;
+	case REMOTE_PROGRESS:
+		{
+			long percentDone = reader.ReadInt();
+			for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+				m_eventHandlers[i]->OnProgress(percentDone);
+		}
+		break;
+	case REMOTE_READY_STATE:
+		{
+			long newState = reader.ReadInt();
+			for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+				m_eventHandlers[i]->OnReadyStateChange(newState);
+		}
+		break;
+	case REMOTE_MOVIE_LOADED:
+		{
+			bool success = reader.ReadInt() != 0;
+			for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+				m_eventHandlers[i]->OnMovieLoaded(success);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::ReceiveFrames()
+{
+	CSharedRing& ring = m_channel.GetFrameRing();
+	bool frameCompleted = false;
+
+	unsigned int size;
+	while (ring.BeginRead(size))
+	{
+		BYTE type = 0;
+		SRemoteFrame frame;
+		if (size >= sizeof(type) + sizeof(frame))
+		{
+			ring.ReadData(&type, sizeof(type));
+			ring.ReadData(&frame, sizeof(frame));
+		}
+
+		if (type == REMOTE_FRAME && PrepareFrameBuffer(frame.m_surfaceWidth, frame.m_surfaceHeight))
+		{
+			const RECT& rect = frame.m_rect;
+			LONG rowSize = (rect.right - rect.left) * 4;
+			bool valid = rect.left >= 0 && rect.top >= 0 && rowSize > 0 && rect.bottom > rect.top &&
+				rect.right <= LONG(m_frameWidth) && rect.bottom <= LONG(m_frameHeight) &&
+				size == sizeof(type) + sizeof(frame) + rowSize * (rect.bottom - rect.top);
+
+			if (valid)
+			{
+				for (LONG y = rect.top; y < rect.bottom; ++y)
+					ring.ReadData(m_frameBits + (y * m_frameWidth + rect.left) * 4, rowSize);
+				m_receivedRects.Add(rect, m_frameWidth, m_frameHeight);
+			}
+
+			// Rects of the frame are reported together, parts of the next one may be copied already
+			if (frame.m_last)
+			{
+				const std::vector<RECT>& rects = m_receivedRects.GetRects();
+				for (unsigned int i = 0; i < rects.size(); ++i)
+					m_dirtyRects.Add(rects[i], m_frameWidth, m_frameHeight);
+				m_receivedRects.Clear();
+				frameCompleted = true;
+			}
+		}
+
+		ring.EndRead();
+	}
+
+	if (frameCompleted && m_dirtyCallback)
+		m_dirtyCallback(this, m_dirtyCallbackContext);
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::PrepareFrameBuffer(unsigned int width, unsigned int height)
+{
+	if (m_frameDC != NULL && m_frameWidth == width && m_frameHeight == height)
+		return true;
+
+	ReleaseFrameBuffer();
+
+	if (width == 0 || height == 0)
+		return false;
+
+	BITMAPINFOHEADER bih = {0};
+	bih.biSize = sizeof(BITMAPINFOHEADER);
+	bih.biBitCount = 32;
+	bih.biCompression = BI_RGB;
+	bih.biPlanes = 1;
+	bih.biWidth = LONG(width);
+	bih.biHeight = -LONG(height);
+
+	m_frameDC = CreateCompatibleDC(NULL);
+	m_frameBitmap = CreateDIBSection(m_frameDC, (BITMAPINFO*)&bih, DIB_RGB_COLORS, (void**)&m_frameBits, 0, 0);
+	if (m_frameBitmap == NULL)
+	{
+		ReleaseFrameBuffer();
+		return false;
+	}
+
+	SelectObject(m_frameDC, m_frameBitmap);
+	m_frameWidth = width;
+	m_frameHeight = height;
+
+	// Host resends the whole surface after resize
+	m_receivedRects.Clear();
+	m_dirtyRects.Clear();
+	m_updateRects.clear();
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::ReleaseFrameBuffer()
+{
+	if (m_frameDC)
+		DeleteDC(m_frameDC);
+	if (m_frameBitmap)
+		DeleteObject(m_frameBitmap);
+
+	m_frameDC = NULL;
+	m_frameBitmap = NULL;
+	m_frameBits = NULL;
+	m_frameWidth = 0;
+	m_frameHeight = 0;
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CRemotePlayer::ReadResultString(const std::vector<BYTE>& result, std::wstring& storage)
+{
+	CRemoteMessageReader reader(result);
+	return reader.ReadString(storage);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetUserData(intptr_t data)
+{
+	m_userData = data;
+}
+
+//---------------------------------------------------------------------
+intptr_t CRemotePlayer::GetUserData() const
+{
+	return m_userData;
+}
+
+//---------------------------------------------------------------------
+IFlashDXPlayer::EState CRemotePlayer::GetState() const
+{
+	return (EState)m_header->m_state;
+}
+
+//---------------------------------------------------------------------
+IFlashDXPlayer::EQuality CRemotePlayer::GetQuality() const
+{
+	return (EQuality)m_header->m_quality;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetQuality(EQuality quality)
+{
+	CRemoteMessage call(REMOTE_SET_QUALITY);
+	call.WriteInt(quality);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+IFlashDXPlayer::ETransparencyMode CRemotePlayer::GetTransparencyMode() const
+{
+	return m_transpMode;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetTransparencyMode(ETransparencyMode mode)
+{
+	m_transpMode = mode;
+
+	CRemoteMessage call(REMOTE_SET_TRANSPARENCY_MODE);
+	call.WriteInt(mode);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::LoadMovie(const wchar_t* movie)
+{
+	return CallWithPath(REMOTE_LOAD_MOVIE, movie);
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::LoadMovie(const void* movieData, const unsigned int movieDataSize)
+{
+	for (unsigned int offset = 0; offset < movieDataSize; offset += s_movieDataPartSize)
+	{
+		unsigned int partSize = min(movieDataSize - offset, s_movieDataPartSize);
+
+		CRemoteMessage part(REMOTE_MOVIE_DATA);
+		part.WriteInt(partSize);
+		part.WriteData((const BYTE*)movieData + offset, partSize);
+		if (!Send(part))
+			return false;
+	}
+
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_LOAD_MOVIE_DATA), result);
+	return CRemoteMessageReader(result).ReadInt() != 0;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::LoadMovieAsync(const wchar_t* movie)
+{
+	return CallWithPath(REMOTE_LOAD_MOVIE_ASYNC, movie);
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::IsMovieLoading() const
+{
+	return m_header->m_movieLoading != 0;
+}
+
+//---------------------------------------------------------------------
+COLORREF CRemotePlayer::GetBackgroundColor()
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_BACKGROUND_COLOR), result);
+	return (COLORREF)CRemoteMessageReader(result).ReadInt();
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetBackgroundColor(COLORREF color)
+{
+	CRemoteMessage call(REMOTE_SET_BACKGROUND_COLOR);
+	call.WriteInt((int)color);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StartPlaying()
+{
+	StartPlaying(NULL);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StartPlaying(const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_START_PLAYING);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StopPlaying()
+{
+	StopPlaying(NULL);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StopPlaying(const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_STOP_PLAYING);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::Rewind()
+{
+	Send(CRemoteMessage(REMOTE_REWIND));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StepForward()
+{
+	Send(CRemoteMessage(REMOTE_STEP_FORWARD));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StepBack()
+{
+	Send(CRemoteMessage(REMOTE_STEP_BACK));
+}
+
+//---------------------------------------------------------------------
+int CRemotePlayer::GetCurrentFrame()
+{
+	return GetCurrentFrame(NULL);
+}
+
+//---------------------------------------------------------------------
+int CRemotePlayer::GetCurrentFrame(const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_GET_CURRENT_FRAME);
+	call.WriteString(timelineTarget);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return result.empty() ? -1 : CRemoteMessageReader(result).ReadInt();
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GotoFrame(int frame)
+{
+	GotoFrame(frame, NULL);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GotoFrame(int frame, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_GOTO_FRAME);
+	call.WriteInt(frame);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::CallFrame(int frame, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_CALL_FRAME);
+	call.WriteInt(frame);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CRemotePlayer::GetCurrentLabel(const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_GET_CURRENT_LABEL);
+	call.WriteString(timelineTarget);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return ReadResultString(result, m_currentLabel);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GotoLabel(const wchar_t* label, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_GOTO_LABEL);
+	call.WriteString(label);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::CallLabel(const wchar_t* label, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_CALL_LABEL);
+	call.WriteString(label);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CRemotePlayer::GetVariable(const wchar_t* name)
+{
+	CRemoteMessage call(REMOTE_GET_VARIABLE);
+	call.WriteString(name);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return ReadResultString(result, m_variable);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetVariable(const wchar_t* name, const wchar_t* value)
+{
+	CRemoteMessage call(REMOTE_SET_VARIABLE);
+	call.WriteString(name);
+	call.WriteString(value);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CRemotePlayer::GetProperty(int iProperty, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_GET_PROPERTY);
+	call.WriteInt(iProperty);
+	call.WriteString(timelineTarget);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return ReadResultString(result, m_property);
+}
+
+//---------------------------------------------------------------------
+double CRemotePlayer::GetPropertyAsNumber(int iProperty, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_GET_PROPERTY_NUMBER);
+	call.WriteInt(iProperty);
+	call.WriteString(timelineTarget);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return CRemoteMessageReader(result).ReadDouble();
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetProperty(int iProperty, const wchar_t* value, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_SET_PROPERTY);
+	call.WriteInt(iProperty);
+	call.WriteString(value);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetProperty(int iProperty, double value, const wchar_t* timelineTarget)
+{
+	CRemoteMessage call(REMOTE_SET_PROPERTY_NUMBER);
+	call.WriteInt(iProperty);
+	call.WriteDouble(value);
+	call.WriteString(timelineTarget);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::ResizePlayer(unsigned int newWidth, unsigned int newHeight)
+{
+	m_width = newWidth;
+	m_height = newHeight;
+
+	CRemoteMessage call(REMOTE_RESIZE);
+	call.WriteInt(newWidth);
+	call.WriteInt(newHeight);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+
+	CRemoteMessageReader reader(result);
+	m_surfaceWidth = reader.ReadInt();
+	m_surfaceHeight = reader.ReadInt();
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetResolutionScale(float scale)
+{
+	m_resolutionScale = scale;
+
+	CRemoteMessage call(REMOTE_SET_RESOLUTION_SCALE);
+	call.WriteDouble(scale);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+
+	CRemoteMessageReader reader(result);
+	m_surfaceWidth = reader.ReadInt();
+	m_surfaceHeight = reader.ReadInt();
+}
+
+//---------------------------------------------------------------------
+float CRemotePlayer::GetResolutionScale() const
+{
+	return m_resolutionScale;
+}
+
+//---------------------------------------------------------------------
+unsigned int CRemotePlayer::GetSurfaceWidth() const
+{
+	return m_surfaceWidth;
+}
+
+//---------------------------------------------------------------------
+unsigned int CRemotePlayer::GetSurfaceHeight() const
+{
+	return m_surfaceHeight;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetVisibleRect(const RECT* rect)
+{
+	RECT visibleRect = {0};
+	if (rect)
+		visibleRect = *rect;
+
+	CRemoteMessage call(REMOTE_SET_VISIBLE_RECT);
+	call.WriteInt(rect != NULL);
+	call.WriteData(&visibleRect, sizeof(visibleRect));
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::Suspend()
+{
+	Send(CRemoteMessage(REMOTE_SUSPEND));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::Resume()
+{
+	Send(CRemoteMessage(REMOTE_RESUME));
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::IsSuspended() const
+{
+	return m_header->m_suspended != 0;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetAutoSuspend(unsigned int delay)
+{
+	CRemoteMessage call(REMOTE_SET_AUTO_SUSPEND);
+	call.WriteInt(delay);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetFrameCache(unsigned int memoryLimit)
+{
+	CRemoteMessage call(REMOTE_SET_FRAME_CACHE);
+	call.WriteInt(memoryLimit);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetFrameCacheKey(const wchar_t* key)
+{
+	CRemoteMessage call(REMOTE_SET_FRAME_CACHE_KEY);
+	call.WriteString(key);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GetFrameCacheStats(SFrameCacheStats& stats)
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_FRAME_CACHE_STATS), result);
+	CRemoteMessageReader(result).ReadData(&stats, sizeof(stats));
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::IsNeedUpdate(const RECT** unitedDirtyRect, const RECT** dirtyRects, unsigned int* numDirtyRects)
+{
+	m_commandProxy.Execute(this);
+	Pump(NULL);
+
+	// Rects reported before but not drawn yet are reported again
+	for (unsigned int i = 0; i < m_updateRects.size(); ++i)
+		m_dirtyRects.Add(m_updateRects[i], m_frameWidth, m_frameHeight);
+
+	if (m_dirtyRects.GetRects().empty())
+		return false;
+
+	m_dirtyRects.Reduce();
+	m_updateRects = m_dirtyRects.GetRects();
+	m_updateUnionRect = m_dirtyRects.GetUnionRect();
+	m_dirtyRects.Clear();
+
+	if (unitedDirtyRect)
+		*unitedDirtyRect = &m_updateUnionRect;
+	if (dirtyRects)
+		*dirtyRects = &m_updateRects[0];
+	if (numDirtyRects)
+		*numDirtyRects = (unsigned int)m_updateRects.size();
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::DrawFrame(HDC dc)
+{
+	if (m_frameDC != NULL)
+	{
+		for (unsigned int i = 0; i < m_updateRects.size(); ++i)
+		{
+			const RECT& rect = m_updateRects[i];
+			BitBlt(dc, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, m_frameDC, rect.left, rect.top, SRCCOPY);
+		}
+	}
+
+	m_updateRects.clear();
+	SetRectEmpty(&m_updateUnionRect);
+}
+
+//---------------------------------------------------------------------
+HANDLE CRemotePlayer::GetDirtyEvent()
+{
+	return m_channel.GetFrameEvent();
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetDirtyCallback(void (*callback)(IFlashDXPlayer* pPlayer, void* context), void* context)
+{
+	m_dirtyCallback = callback;
+	m_dirtyCallbackContext = context;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetFramePacing(float maxRate, bool useMovieFrameRate)
+{
+	CRemoteMessage call(REMOTE_SET_FRAME_PACING);
+	call.WriteDouble(maxRate);
+	call.WriteInt(useMovieFrameRate);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+unsigned int CRemotePlayer::GetTimeToNextUpdate()
+{
+	Pump(NULL);
+
+	if (!m_updateRects.empty() || !m_dirtyRects.GetRects().empty())
+		return 0;
+	if (!m_channel.IsPeerAlive())
+		return INFINITE;
+	return (unsigned int)m_header->m_timeToNextUpdate;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GetPacingStats(SPacingStats& stats)
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_PACING_STATS), result);
+	CRemoteMessageReader(result).ReadData(&stats, sizeof(stats));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::ResetPacingStats()
+{
+	Send(CRemoteMessage(REMOTE_RESET_PACING_STATS));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetAdaptiveQuality(float drawBudget, EQuality minQuality, EQuality maxQuality)
+{
+	CRemoteMessage call(REMOTE_SET_ADAPTIVE_QUALITY);
+	call.WriteDouble(drawBudget);
+	call.WriteInt(minQuality);
+	call.WriteInt(maxQuality);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+float CRemotePlayer::GetAverageDrawTime() const
+{
+	return m_header->m_averageDrawTime / 1000.0f;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetCritical(bool critical)
+{
+	m_critical = critical;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::IsCritical() const
+{
+	return m_critical;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::GetDrawTimings(SDrawTimings& timings)
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_DRAW_TIMINGS), result);
+
+	CRemoteMessageReader reader(result);
+	bool enabled = reader.ReadInt() != 0;
+	reader.ReadData(&timings, sizeof(timings));
+	return enabled;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::ResetDrawTimings()
+{
+	Send(CRemoteMessage(REMOTE_RESET_DRAW_TIMINGS));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetMousePos(unsigned int x, unsigned int y)
+{
+	CRemoteMessage call(REMOTE_MOUSE_MOVE);
+	call.WriteInt(x);
+	call.WriteInt(y);
+	SendInput(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetMouseButtonState(unsigned int x, unsigned int y, EMouseButton button, bool pressed)
+{
+	CRemoteMessage call(REMOTE_MOUSE_BUTTON);
+	call.WriteInt(x);
+	call.WriteInt(y);
+	call.WriteInt(button);
+	call.WriteInt(pressed);
+	SendInput(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SendMouseWheel(int delta)
+{
+	CRemoteMessage call(REMOTE_MOUSE_WHEEL);
+	call.WriteInt(delta);
+	SendInput(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SendKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended)
+{
+	CRemoteMessage call(REMOTE_KEY);
+	call.WriteInt(pressed);
+	call.WriteInt((int)virtualKey);
+	call.WriteInt((int)extended);
+	SendInput(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SendChar(UINT_PTR character, LONG_PTR extended)
+{
+	CRemoteMessage call(REMOTE_CHAR);
+	call.WriteInt((int)character);
+	call.WriteInt((int)extended);
+	SendInput(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetInputBuffering(bool enable)
+{
+	CRemoteMessage call(REMOTE_SET_INPUT_BUFFERING);
+	call.WriteInt(enable);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::FlushInput()
+{
+	Send(CRemoteMessage(REMOTE_FLUSH_INPUT));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetHitTest(unsigned char alphaThreshold, bool filterInput)
+{
+	m_hitTestThreshold = alphaThreshold;
+
+	CRemoteMessage call(REMOTE_SET_HIT_TEST);
+	call.WriteInt(alphaThreshold);
+	call.WriteInt(filterInput);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::IsOpaqueAt(unsigned int x, unsigned int y) const
+{
+	x = (unsigned int)(x * m_resolutionScale);
+	y = (unsigned int)(y * m_resolutionScale);
+	if (x >= m_surfaceWidth || y >= m_surfaceHeight)
+		return false;
+
+	// Alpha comes with the frames, no need to ask the host
+	if (m_hitTestThreshold == 0 || m_transpMode != TMODE_FULL_ALPHA || x >= m_frameWidth || y >= m_frameHeight)
+		return true;
+	return m_frameBits[(y * m_frameWidth + x) * 4 + 3] >= m_hitTestThreshold;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::StartRecording(const wchar_t* path)
+{
+	return CallWithPath(REMOTE_START_RECORDING, path);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StopRecording()
+{
+	Send(CRemoteMessage(REMOTE_STOP_RECORDING));
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::StartReplay(const wchar_t* path)
+{
+	return CallWithPath(REMOTE_START_REPLAY, path);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StopReplay()
+{
+	Send(CRemoteMessage(REMOTE_STOP_REPLAY));
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::IsReplaying() const
+{
+	return m_header->m_replaying != 0;
+}
+
+//---------------------------------------------------------------------
+bool CRemotePlayer::StartDirtyRectTrace(const wchar_t* path)
+{
+	return CallWithPath(REMOTE_START_DIRTY_RECT_TRACE, path);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::StopDirtyRectTrace()
+{
+	Send(CRemoteMessage(REMOTE_STOP_DIRTY_RECT_TRACE));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GetCounters(SCounters& counters)
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_COUNTERS), result);
+	CRemoteMessageReader(result).ReadData(&counters, sizeof(counters));
+}
+
+//---------------------------------------------------------------------
+unsigned int CRemotePlayer::GetFlashCallCounters(SFlashCallCounter* counters, unsigned int maxCounters)
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_FLASH_CALL_COUNTERS), result);
+
+	CRemoteMessageReader reader(result);
+	unsigned int numCounters = reader.ReadInt();
+	for (unsigned int i = 0; i < numCounters && reader.IsValid(); ++i)
+	{
+		std::wstring name;
+		reader.ReadString(name);
+		unsigned int numCalls = reader.ReadInt();
+
+		if (counters != NULL && i < maxCounters)
+		{
+			counters[i].m_name = m_flashCallNames.insert(name).first->c_str();
+			counters[i].m_numCalls = numCalls;
+		}
+	}
+	return reader.IsValid() ? numCounters : 0;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::ResetCounters()
+{
+	m_flashCallNames.clear();
+	Send(CRemoteMessage(REMOTE_RESET_COUNTERS));
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::GetMemoryUsage(SMemoryUsage& usage)
+{
+	std::vector<BYTE> result;
+	Call(CRemoteMessage(REMOTE_GET_MEMORY_USAGE), result);
+	CRemoteMessageReader(result).ReadData(&usage, sizeof(usage));
+
+	// Host reports its side, the copy of the surface and event handlers live here
+	unsigned int frameBuffer = m_frameWidth * m_frameHeight * 4;
+	unsigned int eventHandlers = (unsigned int)(m_eventHandlers.capacity() * sizeof(IFlashDXEventHandler*));
+	for (unsigned int i = 0; i < m_eventHandlers.size(); ++i)
+		eventHandlers += m_eventHandlers[i]->GetMemoryUsage();
+
+	usage.m_frameBuffer += frameBuffer;
+	usage.m_eventHandlers += eventHandlers;
+	usage.m_total += frameBuffer + eventHandlers;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::EnableSound(bool enable)
+{
+	CRemoteMessage call(REMOTE_ENABLE_SOUND);
+	call.WriteInt(enable);
+	Send(call);
+}
+
+//---------------------------------------------------------------------
+const wchar_t* CRemotePlayer::CallFunction(const wchar_t* request)
+{
+	CRemoteMessage call(REMOTE_CALL_FUNCTION);
+	call.WriteString(request);
+
+	std::vector<BYTE> result;
+	Call(call, result);
+	return ReadResultString(result, m_callResult);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::SetReturnValue(const wchar_t* returnValue)
+{
+	// Sent to the host with the answer to FlashCall
+	m_returnValue = returnValue ? returnValue : L"";
+	m_hasReturnValue = returnValue != NULL;
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::AddEventHandler(struct IFlashDXEventHandler* pHandler)
+{
+	m_eventHandlers.push_back(pHandler);
+}
+
+//---------------------------------------------------------------------
+void CRemotePlayer::RemoveEventHandler(struct IFlashDXEventHandler* pHandler)
+{
+	std::vector<IFlashDXEventHandler*>::iterator it = std::find(m_eventHandlers.begin(), m_eventHandlers.end(), pHandler);
+	if (it != m_eventHandlers.end())
+		m_eventHandlers.erase(it);
+}
+
+//---------------------------------------------------------------------
+struct IFlashDXEventHandler* CRemotePlayer::GetEventHandlerByIndex(unsigned int index)
+{
+	return m_eventHandlers[index];
+}
+
+//---------------------------------------------------------------------
+unsigned int CRemotePlayer::GetNumEventHandlers() const
+{
+	return (unsigned int)m_eventHandlers.size();
+}
+
+//---------------------------------------------------------------------
+struct IFlashDXPlayerProxy* CRemotePlayer::GetCommandProxy()
+{
+	return &m_commandProxy;
+}
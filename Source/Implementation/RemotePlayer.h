@@ -0,0 +1,213 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+#include "CommandProxy.h"
+#include "DirtyRects.h"
+#include "RemoteChannel.h"
+#include <set>
+
+//---------------------------------------------------------------------
+/// Implementation of IFlashDXPlayer for player running in the helper process, see CRemoteHost.
+/// Calls returning values wait for the host, the rest are sent without waiting. State, quality, loading,
+/// suspension and replay status are published by the host, so they may lag behind calls not yet executed.
+/// If the host process exits, calls do nothing and return defaults. Host that stops answering for a while
+/// is terminated and treated the same. Input is dropped while the command ring is full.
+//---------------------------------------------------------------------
+class CRemotePlayer : public IFlashDXPlayer
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CRemotePlayer(unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Destructor. Asks the host to quit, terminates it if it doesn't.
+	virtual ~CRemotePlayer();
+
+	//---------------------------------------------------------------------
+	/// Starts the host process and waits until it creates the player.
+	/// Name of the channel is appended to the command line as the last argument.
+	bool Start(const wchar_t* hostCommandLine);
+
+	//---------------------------------------------------------------------
+	// IFlashDXPlayer implementations.
+	virtual void SetUserData(intptr_t data);
+	virtual intptr_t GetUserData() const;
+	virtual EState GetState() const;
+	virtual EQuality GetQuality() const;
+	virtual void SetQuality(EQuality quality);
+	virtual ETransparencyMode GetTransparencyMode() const;
+	virtual void SetTransparencyMode(ETransparencyMode mode);
+	virtual bool LoadMovie(const wchar_t* movie);
+	virtual bool LoadMovie(const void* movieData, const unsigned int movieDataSize);
+	virtual bool LoadMovieAsync(const wchar_t* movie);
+	virtual bool IsMovieLoading() const;
+	virtual COLORREF GetBackgroundColor();
+	virtual void SetBackgroundColor(COLORREF color);
+	virtual void StartPlaying();
+	virtual void StartPlaying(const wchar_t* timelineTarget);
+	virtual void StopPlaying();
+	virtual void StopPlaying(const wchar_t* timelineTarget);
+	virtual void Rewind();
+	virtual void StepForward();
+	virtual void StepBack();
+	virtual int GetCurrentFrame();
+	virtual int GetCurrentFrame(const wchar_t* timelineTarget = L"/");
+	virtual void GotoFrame(int frame);
+	virtual void GotoFrame(int frame, const wchar_t* timelineTarget);
+	virtual void CallFrame(int frame, const wchar_t* timelineTarget = L"/");
+	virtual const wchar_t* GetCurrentLabel(const wchar_t* timelineTarget = L"/");
+	virtual void GotoLabel(const wchar_t* label, const wchar_t* timelineTarget = L"/");
+	virtual void CallLabel(const wchar_t* label, const wchar_t* timelineTarget = L"/");
+	virtual const wchar_t* GetVariable(const wchar_t* name);
+	virtual void SetVariable(const wchar_t* name, const wchar_t* value);
+	virtual const wchar_t* GetProperty(int iProperty, const wchar_t* timelineTarget = L"/");
+	virtual double GetPropertyAsNumber(int iProperty, const wchar_t* timelineTarget = L"/");
+	virtual void SetProperty(int iProperty, const wchar_t* value, const wchar_t* timelineTarget = L"/");
+	virtual void SetProperty(int iProperty, double value, const wchar_t* timelineTarget = L"/");
+	virtual void ResizePlayer(unsigned int newWidth, unsigned int newHeight);
+	virtual void SetResolutionScale(float scale);
+	virtual float GetResolutionScale() const;
+	virtual unsigned int GetSurfaceWidth() const;
+	virtual unsigned int GetSurfaceHeight() const;
+	virtual void SetVisibleRect(const RECT* rect);
+	virtual void Suspend();
+	virtual void Resume();
+	virtual bool IsSuspended() const;
+	virtual void SetAutoSuspend(unsigned int delay);
+	virtual void SetFrameCache(unsigned int memoryLimit);
+	virtual void SetFrameCacheKey(const wchar_t* key);
+	virtual void GetFrameCacheStats(SFrameCacheStats& stats);
+	virtual bool IsNeedUpdate(const RECT** unitedDirtyRect = NULL, const RECT** dirtyRects = NULL, unsigned int* numDirtyRects = NULL);
+	virtual void DrawFrame(HDC dc);
+	virtual HANDLE GetDirtyEvent();
+	virtual void SetDirtyCallback(void (*callback)(IFlashDXPlayer* pPlayer, void* context), void* context);
+	virtual void SetFramePacing(float maxRate, bool useMovieFrameRate);
+	virtual unsigned int GetTimeToNextUpdate();
+	virtual void GetPacingStats(SPacingStats& stats);
+	virtual void ResetPacingStats();
+	virtual void SetAdaptiveQuality(float drawBudget, EQuality minQuality = QUALITY_LOW, EQuality maxQuality = QUALITY_HIGH);
+	virtual float GetAverageDrawTime() const;
+	virtual void SetCritical(bool critical);
+	virtual bool IsCritical() const;
+	virtual bool GetDrawTimings(SDrawTimings& timings);
+	virtual void ResetDrawTimings();
+	virtual void SetMousePos(unsigned int x, unsigned int y);
+	virtual void SetMouseButtonState(unsigned int x, unsigned int y, EMouseButton button, bool pressed);
+	virtual void SendMouseWheel(int delta);
+	virtual void SendKey(bool pressed, UINT_PTR virtualKey, LONG_PTR extended);
+	virtual void SendChar(UINT_PTR character, LONG_PTR extended);
+	virtual void SetInputBuffering(bool enable);
+	virtual void FlushInput();
+	virtual void SetHitTest(unsigned char alphaThreshold, bool filterInput);
+	virtual bool IsOpaqueAt(unsigned int x, unsigned int y) const;
+	virtual bool StartRecording(const wchar_t* path);
+	virtual void StopRecording();
+	virtual bool StartReplay(const wchar_t* path);
+	virtual void StopReplay();
+	virtual bool IsReplaying() const;
+	virtual bool StartDirtyRectTrace(const wchar_t* path);
+	virtual void StopDirtyRectTrace();
+	virtual void GetCounters(SCounters& counters);
+	virtual unsigned int GetFlashCallCounters(SFlashCallCounter* counters, unsigned int maxCounters);
+	virtual void ResetCounters();
+	virtual void GetMemoryUsage(SMemoryUsage& usage);
+	virtual void EnableSound(bool enable);
+	virtual const wchar_t* CallFunction(const wchar_t* request);
+	virtual void SetReturnValue(const wchar_t* returnValue);
+	virtual void AddEventHandler(struct IFlashDXEventHandler* pHandler);
+	virtual void RemoveEventHandler(struct IFlashDXEventHandler* pHandler);
+	virtual struct IFlashDXEventHandler* GetEventHandlerByIndex(unsigned int index);
+	virtual unsigned int GetNumEventHandlers() const;
+	virtual struct IFlashDXPlayerProxy* GetCommandProxy();
+
+protected:
+	//---------------------------------------------------------------------
+	/// Sends message, terminating the host if it makes no room in time.
+	bool Send(const CRemoteMessage& message);
+	/// Sends input, dropped if the command ring is full.
+	void SendInput(const CRemoteMessage& message);
+	/// Terminates the host that stopped responding.
+	void AbandonHost();
+	//---------------------------------------------------------------------
+	/// Sends call and waits for its result, handling events meanwhile. Result is empty if the host is gone.
+	void Call(const CRemoteMessage& call, std::vector<BYTE>& result);
+	//---------------------------------------------------------------------
+	/// Sends call with single string argument and returns its result.
+	bool CallWithPath(ERemoteMessage type, const wchar_t* path);
+	//---------------------------------------------------------------------
+	/// Takes frames and events sent by the host. Returns true if result of the pending call was received.
+	bool Pump(std::vector<BYTE>* result);
+	//---------------------------------------------------------------------
+	void HandleEvent(const std::vector<BYTE>& message);
+	//---------------------------------------------------------------------
+	void ReceiveFrames();
+	//---------------------------------------------------------------------
+	bool PrepareFrameBuffer(unsigned int width, unsigned int height);
+	void ReleaseFrameBuffer();
+	//---------------------------------------------------------------------
+	/// Reads string result into the storage. Returns NULL for NULL string.
+	static const wchar_t* ReadResultString(const std::vector<BYTE>& result, std::wstring& storage);
+
+protected:
+	CRemoteChannel			m_channel;
+	SRemoteHeader*			m_header;
+	intptr_t				m_userData;
+	ETransparencyMode		m_transpMode;
+	unsigned int			m_width;
+	unsigned int			m_height;
+	unsigned int			m_surfaceWidth;			// reported by the host
+	unsigned int			m_surfaceHeight;
+	float					m_resolutionScale;
+	bool					m_critical;
+	unsigned char			m_hitTestThreshold;
+
+	// Copy of the host surface, updated by frames
+	HDC						m_frameDC;
+	HBITMAP					m_frameBitmap;
+	BYTE*					m_frameBits;
+	unsigned int			m_frameWidth;
+	unsigned int			m_frameHeight;
+
+	CDirtyRects				m_receivedRects;		// parts of the frame not complete yet
+	CDirtyRects				m_dirtyRects;			// complete frames not reported yet
+	std::vector<RECT>		m_updateRects;			// reported by IsNeedUpdate(), waiting for DrawFrame()
+	RECT					m_updateUnionRect;
+
+	void					(*m_dirtyCallback)(IFlashDXPlayer* pPlayer, void* context);
+	void*					m_dirtyCallbackContext;
+
+	std::vector<IFlashDXEventHandler*> m_eventHandlers;
+	CCommandProxy			m_commandProxy;
+
+	std::wstring			m_currentLabel;
+	std::wstring			m_variable;
+	std::wstring			m_property;
+	std::wstring			m_callResult;
+	std::wstring			m_returnValue;			// set by event handler during FlashCall
+	bool					m_hasReturnValue;
+	DWORD					m_lastHostActivity;		// tick count of the last message from the host
+	std::set<std::wstring>	m_flashCallNames;		// keeps names returned by GetFlashCallCounters()
+};
@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "RenderBufferPool.h"
+
+//---------------------------------------------------------------------
+// Buffer sizes are rounded up to this step, so small resizes don't reallocate.
+static const unsigned int s_bucketSize = 128;
+
+//---------------------------------------------------------------------
+// Larger buffers are reused for smaller requests only up to this area ratio.
+static const unsigned int s_maxAreaRatio = 4;
+
+//---------------------------------------------------------------------
+// Idle memory kept by default, enough for a couple of full screen buffers.
+static const unsigned int s_defaultMemoryLimit = 32 * 1024 * 1024;
+
+//---------------------------------------------------------------------
+CRenderBufferPool::CRenderBufferPool()
+{
+	InitializeCriticalSection(&m_lock);
+
+	m_numBuffers = 0;
+	m_memoryUsage = 0;
+	m_freeMemory = 0;
+	m_peakMemoryUsage = 0;
+	m_memoryLimit = s_defaultMemoryLimit;
+	m_numHits = 0;
+	m_numMisses = 0;
+}
+
+//---------------------------------------------------------------------
+CRenderBufferPool::~CRenderBufferPool()
+{
+	for (size_t i = 0; i < m_freeBuffers.size(); ++i)
+		DeleteBuffer(m_freeBuffers[i]);
+
+	DeleteCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+void CRenderBufferPool::SetLimit(unsigned int memoryLimit)
+{
+	EnterCriticalSection(&m_lock);
+
+	m_memoryLimit = memoryLimit;
+	Trim();
+
+	LeaveCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+CRenderBufferPool::SBuffer* CRenderBufferPool::Acquire(unsigned int width, unsigned int height)
+{
+	if (width == 0 || height == 0)
+		return NULL;
+
+	width = (width + s_bucketSize - 1) / s_bucketSize * s_bucketSize;
+	height = (height + s_bucketSize - 1) / s_bucketSize * s_bucketSize;
+
+	EnterCriticalSection(&m_lock);
+
+	// Smallest idle buffer that fits
+	size_t bestIndex = m_freeBuffers.size();
+	for (size_t i = 0; i < m_freeBuffers.size(); ++i)
+	{
+		const SBuffer* buffer = m_freeBuffers[i];
+		if (buffer->m_width < width || buffer->m_height < height)
+			continue;
+		if (buffer->m_width * buffer->m_height > width * height * s_maxAreaRatio)
+			continue;
+		if (bestIndex == m_freeBuffers.size() || GetBufferSize(buffer) < GetBufferSize(m_freeBuffers[bestIndex]))
+			bestIndex = i;
+	}
+
+	if (bestIndex != m_freeBuffers.size())
+	{
+		SBuffer* buffer = m_freeBuffers[bestIndex];
+		m_freeBuffers.erase(m_freeBuffers.begin() + bestIndex);
+		m_freeMemory -= GetBufferSize(buffer);
+		++m_numHits;
+
+		LeaveCriticalSection(&m_lock);
+		return buffer;
+	}
+
+	++m_numMisses;
+
+	LeaveCriticalSection(&m_lock);
+
+	// Allocate outside of the lock, other players may draw meanwhile
+	SBuffer* buffer = CreateBuffer(width, height);
+	if (buffer == NULL)
+		return NULL;
+
+	EnterCriticalSection(&m_lock);
+
+	++m_numBuffers;
+	m_memoryUsage += GetBufferSize(buffer);
+	if (m_memoryUsage > m_peakMemoryUsage)
+		m_peakMemoryUsage = m_memoryUsage;
+
+	LeaveCriticalSection(&m_lock);
+	return buffer;
+}
+
+//---------------------------------------------------------------------
+void CRenderBufferPool::Release(SBuffer* buffer)
+{
+	if (buffer == NULL)
+		return;
+
+	SelectClipRgn(buffer->m_dc, NULL);
+
+	EnterCriticalSection(&m_lock);
+
+	m_freeBuffers.push_back(buffer);
+	m_freeMemory += GetBufferSize(buffer);
+	Trim();
+
+	LeaveCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+unsigned int CRenderBufferPool::GetBufferSize(const SBuffer* buffer)
+{
+	return buffer ? buffer->m_width * buffer->m_height * 4 : 0;
+}
+
+//---------------------------------------------------------------------
+void CRenderBufferPool::GetStats(IFlashDX::SRenderBufferPoolStats& stats)
+{
+	EnterCriticalSection(&m_lock);
+
+	stats.m_numBuffers = m_numBuffers;
+	stats.m_numFree = (unsigned int)m_freeBuffers.size();
+	stats.m_memoryUsage = m_memoryUsage;
+	stats.m_freeMemory = m_freeMemory;
+	stats.m_peakMemoryUsage = m_peakMemoryUsage;
+	stats.m_memoryLimit = m_memoryLimit;
+	stats.m_numHits = m_numHits;
+	stats.m_numMisses = m_numMisses;
+
+	LeaveCriticalSection(&m_lock);
+}
+
+//---------------------------------------------------------------------
+CRenderBufferPool::SBuffer* CRenderBufferPool::CreateBuffer(unsigned int width, unsigned int height)
+{
+	BITMAPINFOHEADER bih = {0};
+	bih.biSize = sizeof(BITMAPINFOHEADER);
+	bih.biBitCount = 32;
+	bih.biCompression = BI_RGB;
+	bih.biPlanes = 1;
+	bih.biWidth = LONG(width);
+	bih.biHeight = -LONG(height);
+
+	HDC dc = CreateCompatibleDC(NULL);
+	if (dc == NULL)
+		return NULL;
+
+	BYTE* bits = NULL;
+	HBITMAP bitmap = CreateDIBSection(dc, (BITMAPINFO*)&bih, DIB_RGB_COLORS, (void**)&bits, 0, 0);
+	if (bitmap == NULL)
+	{
+		DeleteDC(dc);
+		return NULL;
+	}
+	SelectObject(dc, bitmap);
+
+	SBuffer* buffer = new SBuffer;
+	buffer->m_dc = dc;
+	buffer->m_bitmap = bitmap;
+	buffer->m_bits = bits;
+	buffer->m_width = width;
+	buffer->m_height = height;
+	return buffer;
+}
+
+//---------------------------------------------------------------------
+void CRenderBufferPool::DeleteBuffer(SBuffer* buffer)
+{
+	DeleteDC(buffer->m_dc);
+	DeleteObject(buffer->m_bitmap);
+	delete buffer;
+}
+
+//---------------------------------------------------------------------
+void CRenderBufferPool::Trim()
+{
+	while (m_freeMemory > m_memoryLimit && !m_freeBuffers.empty())
+	{
+		SBuffer* buffer = m_freeBuffers.front();
+		m_freeBuffers.erase(m_freeBuffers.begin());
+
+		m_freeMemory -= GetBufferSize(buffer);
+		m_memoryUsage -= GetBufferSize(buffer);
+		--m_numBuffers;
+		DeleteBuffer(buffer);
+	}
+}
@@ -0,0 +1,93 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Pool of scratch DIB sections shared by all players.
+/// Buffers are borrowed for a single draw and bucketed by size, so resizing players reuse them.
+//---------------------------------------------------------------------
+class CRenderBufferPool
+{
+public:
+	//---------------------------------------------------------------------
+	/// 32 bit top-down DIB section selected into memory DC.
+	struct SBuffer
+	{
+		HDC						m_dc;
+		HBITMAP					m_bitmap;
+		BYTE*					m_bits;
+		unsigned int			m_width;		// bucket size, may be bigger than requested
+		unsigned int			m_height;
+	};
+
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CRenderBufferPool();
+
+	//---------------------------------------------------------------------
+	/// Destructor.
+	~CRenderBufferPool();
+
+	//---------------------------------------------------------------------
+	/// Sets how much memory idle buffers may take.
+	void SetLimit(unsigned int memoryLimit);
+
+	//---------------------------------------------------------------------
+	/// Returns buffer at least of the specified size, or NULL if it can't be created.
+	SBuffer* Acquire(unsigned int width, unsigned int height);
+
+	//---------------------------------------------------------------------
+	/// Returns buffer to the pool.
+	void Release(SBuffer* buffer);
+
+	//---------------------------------------------------------------------
+	/// Returns statistics.
+	void GetStats(IFlashDX::SRenderBufferPoolStats& stats);
+
+	//---------------------------------------------------------------------
+	/// Returns bytes taken by the buffer, zero for NULL.
+	static unsigned int GetBufferSize(const SBuffer* buffer);
+
+protected:
+	//---------------------------------------------------------------------
+	static SBuffer* CreateBuffer(unsigned int width, unsigned int height);
+	static void DeleteBuffer(SBuffer* buffer);
+	//---------------------------------------------------------------------
+	void Trim();
+
+protected:
+	CRITICAL_SECTION		m_lock;
+
+	std::vector<SBuffer*>	m_freeBuffers;		// least recently released first
+
+	unsigned int			m_numBuffers;
+	unsigned int			m_memoryUsage;		// all buffers, borrowed ones included
+	unsigned int			m_freeMemory;		// idle buffers only
+	unsigned int			m_peakMemoryUsage;
+	unsigned int			m_memoryLimit;
+
+	unsigned int			m_numHits;
+	unsigned int			m_numMisses;
+};
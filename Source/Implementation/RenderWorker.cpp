@@ -0,0 +1,287 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "RenderWorker.h"
+#include "FlashDXPlayer.h"
+#include <process.h>
+#include <algorithm>
+
+//---------------------------------------------------------------------
+CFrameRing::CFrameRing()
+{
+	m_head = 0;
+	m_tail = 0;
+}
+
+//---------------------------------------------------------------------
+bool CFrameRing::Push(const IFlashDX::SRenderedFrame& frame)
+{
+	LONG tail = m_tail;
+	LONG next = (tail + 1) % CAPACITY;
+	if (next == m_head)
+		return false;
+
+	m_frames[tail] = frame;
+
+	// Frame must be visible before the consumer sees new tail
+	MemoryBarrier();
+	m_tail = next;
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CFrameRing::Pop(IFlashDX::SRenderedFrame& frame)
+{
+	LONG head = m_head;
+	if (head == m_tail)
+		return false;
+
+	MemoryBarrier();
+	frame = m_frames[head];
+
+	// Slot must be read before the producer is allowed to reuse it
+	MemoryBarrier();
+	m_head = (head + 1) % CAPACITY;
+	return true;
+}
+
+//---------------------------------------------------------------------
+CRenderWorker::CRenderWorker()
+{
+	m_numPlayers = 0;
+	m_quit = 0;
+	m_threadId = 0;
+
+	InitializeCriticalSection(&m_taskLock);
+	m_taskEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	m_renderEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+	m_thread = (HANDLE)_beginthreadex(NULL, 0, ThreadProc, this, 0, &m_threadId);
+}
+
+//---------------------------------------------------------------------
+CRenderWorker::~CRenderWorker()
+{
+	assert(m_players.empty());
+
+	if (m_thread)
+	{
+		InterlockedExchange(&m_quit, 1);
+		SetEvent(m_taskEvent);
+		WaitForSingleObject(m_thread, INFINITE);
+		CloseHandle(m_thread);
+	}
+
+	CloseHandle(m_renderEvent);
+	CloseHandle(m_taskEvent);
+	DeleteCriticalSection(&m_taskLock);
+}
+
+//---------------------------------------------------------------------
+bool CRenderWorker::IsRunning() const
+{
+	return m_thread != NULL;
+}
+
+//---------------------------------------------------------------------
+bool CRenderWorker::IsWorkerThread() const
+{
+	return GetCurrentThreadId() == m_threadId;
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::Invoke(TaskFunc func, void* context)
+{
+	if (IsWorkerThread())
+	{
+		func(context);
+		return;
+	}
+
+	STask task;
+	task.m_func = func;
+	task.m_context = context;
+	task.m_doneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	EnterCriticalSection(&m_taskLock);
+	m_tasks.push_back(task);
+	LeaveCriticalSection(&m_taskLock);
+
+	SetEvent(m_taskEvent);
+	WaitForSingleObject(task.m_doneEvent, INFINITE);
+	CloseHandle(task.m_doneEvent);
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::RequestRender()
+{
+	SetEvent(m_renderEvent);
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::AddPlayer(CFlashDXPlayer* player)
+{
+	assert(IsWorkerThread());
+	m_players.push_back(player);
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::RemovePlayer(CFlashDXPlayer* player)
+{
+	assert(IsWorkerThread());
+
+	std::vector<CFlashDXPlayer*>::iterator it = std::find(m_players.begin(), m_players.end(), player);
+	if (it != m_players.end())
+		m_players.erase(it);
+
+	DropPendingFrames(player);
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::DropPendingFrames(CFlashDXPlayer* player)
+{
+	assert(IsWorkerThread());
+
+	for (size_t i = 0; i < m_pendingFrames.size(); )
+	{
+		if (m_pendingFrames[i].m_player == player)
+			m_pendingFrames.erase(m_pendingFrames.begin() + i);
+		else
+			++i;
+	}
+}
+
+//---------------------------------------------------------------------
+bool CRenderWorker::PopFrame(IFlashDX::SRenderedFrame& frame)
+{
+	return m_frames.Pop(frame);
+}
+
+//---------------------------------------------------------------------
+unsigned int __stdcall CRenderWorker::ThreadProc(void* param)
+{
+	CoInitialize(NULL);
+	((CRenderWorker*)param)->Run();
+	CoUninitialize();
+	return 0;
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::Run()
+{
+	HANDLE events[2] = { m_taskEvent, m_renderEvent };
+
+	while (!m_quit)
+	{
+		// Flash control needs message loop for its timers
+		DWORD result = MsgWaitForMultipleObjects(2, events, FALSE, INFINITE, QS_ALLINPUT);
+
+		if (result == WAIT_OBJECT_0)
+			RunTasks();
+		else if (result == WAIT_OBJECT_0 + 1)
+			RenderPlayers();
+
+		// Messages are dispatched on every pass, otherwise render requests coming faster than
+		// rendering keep the render event signalled and Flash timers never fire
+		MSG msg;
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+	}
+
+	RunTasks();
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::RunTasks()
+{
+	std::vector<STask> tasks;
+
+	EnterCriticalSection(&m_taskLock);
+	tasks.swap(m_tasks);
+	LeaveCriticalSection(&m_taskLock);
+
+	for (size_t i = 0; i < tasks.size(); ++i)
+	{
+		tasks[i].m_func(tasks[i].m_context);
+		SetEvent(tasks[i].m_doneEvent);
+	}
+}
+
+//---------------------------------------------------------------------
+void CRenderWorker::RenderPlayers()
+{
+	// Hand over frames that didn't fit last time
+	while (!m_pendingFrames.empty() && m_frames.Push(m_pendingFrames.front()))
+		m_pendingFrames.erase(m_pendingFrames.begin());
+
+	for (size_t i = 0; i < m_players.size(); ++i)
+	{
+		IFlashDX::SRenderedFrame frame;
+		if (!RenderPlayer(m_players[i], frame))
+			continue;
+
+		if (!m_pendingFrames.empty() || !m_frames.Push(frame))
+			m_pendingFrames.push_back(frame);
+	}
+
+	GdiFlush();
+}
+
+//---------------------------------------------------------------------
+bool CRenderWorker::RenderPlayer(CFlashDXPlayer* player, IFlashDX::SRenderedFrame& frame)
+{
+	// Skip player if its previous frame is still held by the consumer
+	if (InterlockedCompareExchange(&player->m_frameBusy, 1, 0) != 0)
+		return false;
+
+	// Suspended player keeps no frame buffer, it only runs queued commands
+	if (player->CFlashDXPlayer::IsSuspended())
+	{
+		player->ReleaseFrameBuffer();
+		player->IsNeedUpdate();
+		InterlockedExchange(&player->m_frameBusy, 0);
+		return false;
+	}
+
+	// Buffer (re)creation marks the whole player dirty
+	const RECT* unitedDirtyRect;
+	if (!player->PrepareFrameBuffer() || !player->IsNeedUpdate(&unitedDirtyRect))
+	{
+		InterlockedExchange(&player->m_frameBusy, 0);
+		return false;
+	}
+
+	frame.m_player = player;
+	frame.m_unitedDirtyRect = *unitedDirtyRect;
+
+	player->DrawFrame(player->m_frameDC);
+
+	frame.m_bits = player->m_frameBits;
+	frame.m_pitch = player->m_frameWidth * 4;
+	frame.m_width = player->m_frameWidth;
+	frame.m_height = player->m_frameHeight;
+	return true;
+}
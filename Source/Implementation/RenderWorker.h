@@ -0,0 +1,136 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+
+//---------------------------------------------------------------------
+/// Lock-free single producer, single consumer ring of rendered frames.
+//---------------------------------------------------------------------
+class CFrameRing
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CFrameRing();
+
+	//---------------------------------------------------------------------
+	/// Adds frame. Called by producer only. Fails if the ring is full.
+	bool Push(const IFlashDX::SRenderedFrame& frame);
+
+	//---------------------------------------------------------------------
+	/// Takes frame. Called by consumer only. Fails if the ring is empty.
+	bool Pop(IFlashDX::SRenderedFrame& frame);
+
+protected:
+	enum { CAPACITY = 64 };
+
+	IFlashDX::SRenderedFrame m_frames[CAPACITY];
+	volatile LONG			m_head;				// next frame to pop, written by consumer
+	volatile LONG			m_tail;				// next free slot, written by producer
+};
+
+//---------------------------------------------------------------------
+/// Worker thread that owns players and renders them to their frame buffers.
+//---------------------------------------------------------------------
+class CRenderWorker
+{
+public:
+	typedef void (*TaskFunc)(void* context);
+
+	//---------------------------------------------------------------------
+	/// Constructor. Starts the thread.
+	CRenderWorker();
+
+	//---------------------------------------------------------------------
+	/// Destructor. Stops the thread. All players should be destroyed by then.
+	~CRenderWorker();
+
+	//---------------------------------------------------------------------
+	/// Checks if the thread is running.
+	bool IsRunning() const;
+
+	//---------------------------------------------------------------------
+	/// Checks if the caller is the worker thread.
+	bool IsWorkerThread() const;
+
+	//---------------------------------------------------------------------
+	/// Runs function on the worker thread and waits for it to complete.
+	void Invoke(TaskFunc func, void* context);
+
+	//---------------------------------------------------------------------
+	/// Wakes the worker up to render dirty players.
+	void RequestRender();
+
+	//---------------------------------------------------------------------
+	/// Registers or unregisters player rendered by this worker. Called on the worker thread.
+	void AddPlayer(class CFlashDXPlayer* player);
+	void RemovePlayer(CFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	/// Drops frames of the player that didn't fit into the ring yet. Called on the worker thread.
+	void DropPendingFrames(CFlashDXPlayer* player);
+
+	//---------------------------------------------------------------------
+	/// Takes next rendered frame. Called by the consumer thread only.
+	bool PopFrame(IFlashDX::SRenderedFrame& frame);
+
+public:
+	unsigned int			m_numPlayers;		// maintained by CFlashDX, used for scheduling
+
+protected:
+	//---------------------------------------------------------------------
+	struct STask
+	{
+		TaskFunc				m_func;
+		void*					m_context;
+		HANDLE					m_doneEvent;
+	};
+
+	//---------------------------------------------------------------------
+	static unsigned int __stdcall ThreadProc(void* param);
+	//---------------------------------------------------------------------
+	void Run();
+	//---------------------------------------------------------------------
+	void RunTasks();
+	//---------------------------------------------------------------------
+	void RenderPlayers();
+	//---------------------------------------------------------------------
+	bool RenderPlayer(CFlashDXPlayer* player, IFlashDX::SRenderedFrame& frame);
+
+protected:
+	HANDLE					m_thread;
+	unsigned int			m_threadId;
+	HANDLE					m_taskEvent;
+	HANDLE					m_renderEvent;
+	volatile LONG			m_quit;
+
+	CRITICAL_SECTION		m_taskLock;
+	std::vector<STask>		m_tasks;
+
+	// Worker thread data
+	std::vector<CFlashDXPlayer*> m_players;
+	std::vector<IFlashDX::SRenderedFrame> m_pendingFrames;	// frames that didn't fit into the ring
+
+	CFrameRing				m_frames;
+};
@@ -0,0 +1,783 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SWFAnalyzer.h"
+
+//---------------------------------------------------------------------
+// Edge count and bitmap memory thresholds used to recommend quality.
+static const unsigned int s_mediumQualityEdges = 20000;
+static const unsigned int s_lowQualityEdges = 60000;
+static const unsigned int s_mediumQualityBitmapMemory = 64 * 1024 * 1024;
+
+//---------------------------------------------------------------------
+/// Bounds checked reader for SWF data types.
+//---------------------------------------------------------------------
+class CSWFReader
+{
+public:
+	//---------------------------------------------------------------------
+	CSWFReader(const BYTE* data, unsigned int size)
+	:
+		m_data(data), m_size(size), m_pos(0), m_bitBuf(0), m_bitCnt(0), m_overflow(false)
+	{}
+
+	//---------------------------------------------------------------------
+	bool IsOverflow() const { return m_overflow; }
+	unsigned int GetPos() const { return m_pos; }
+	const BYTE* GetData() const { return m_data; }
+
+	//---------------------------------------------------------------------
+	void SetPos(unsigned int pos)
+	{
+		Align();
+		if (pos > m_size)
+		{
+			m_overflow = true;
+			pos = m_size;
+		}
+		m_pos = pos;
+	}
+
+	//---------------------------------------------------------------------
+	void Align()
+	{
+		m_bitCnt = 0;
+	}
+
+	//---------------------------------------------------------------------
+	unsigned int ReadU8()
+	{
+		Align();
+		if (m_pos + 1 > m_size)
+		{
+			m_overflow = true;
+			return 0;
+		}
+		return m_data[m_pos++];
+	}
+
+	//---------------------------------------------------------------------
+	unsigned int ReadU16()
+	{
+		unsigned int lo = ReadU8();
+		return lo | (ReadU8() << 8);
+	}
+
+	//---------------------------------------------------------------------
+	unsigned int ReadU32()
+	{
+		unsigned int lo = ReadU16();
+		return lo | (ReadU16() << 16);
+	}
+
+	//---------------------------------------------------------------------
+	unsigned int ReadUB(unsigned int numBits)
+	{
+		unsigned int result = 0;
+		while (numBits--)
+		{
+			if (m_bitCnt == 0)
+			{
+				if (m_pos + 1 > m_size)
+				{
+					m_overflow = true;
+					return 0;
+				}
+				m_bitBuf = m_data[m_pos++];
+				m_bitCnt = 8;
+			}
+			--m_bitCnt;
+			result = (result << 1) | ((m_bitBuf >> m_bitCnt) & 1);
+		}
+		return result;
+	}
+
+	//---------------------------------------------------------------------
+	int ReadSB(unsigned int numBits)
+	{
+		unsigned int result = ReadUB(numBits);
+		if (numBits > 0 && numBits < 32 && (result & (1U << (numBits - 1))))
+			result |= ~0U << numBits;
+		return (int)result;
+	}
+
+	//---------------------------------------------------------------------
+	void SkipString()
+	{
+		while (ReadU8() != 0 && !m_overflow);
+	}
+
+	//---------------------------------------------------------------------
+	void Skip(unsigned int numBytes)
+	{
+		SetPos(m_pos + numBytes);
+	}
+
+	//---------------------------------------------------------------------
+	void ReadRect(int& xMin, int& xMax, int& yMin, int& yMax)
+	{
+		Align();
+		unsigned int numBits = ReadUB(5);
+		xMin = ReadSB(numBits);
+		xMax = ReadSB(numBits);
+		yMin = ReadSB(numBits);
+		yMax = ReadSB(numBits);
+		Align();
+	}
+
+	//---------------------------------------------------------------------
+	void SkipMatrix()
+	{
+		Align();
+		if (ReadUB(1))
+		{
+			unsigned int numScaleBits = ReadUB(5);
+			ReadUB(numScaleBits * 2);
+		}
+		if (ReadUB(1))
+		{
+			unsigned int numRotateBits = ReadUB(5);
+			ReadUB(numRotateBits * 2);
+		}
+		unsigned int numTranslateBits = ReadUB(5);
+		ReadUB(numTranslateBits * 2);
+		Align();
+	}
+
+	//---------------------------------------------------------------------
+	// Returns true if color transform makes object semi-transparent.
+	bool ReadColorTransform(bool hasAlpha)
+	{
+		Align();
+		bool hasAdd = ReadUB(1) != 0;
+		bool hasMult = ReadUB(1) != 0;
+		unsigned int numBits = ReadUB(4);
+
+		bool semiTransparent = false;
+		if (hasMult)
+		{
+			ReadUB(numBits * 3);
+			if (hasAlpha && ReadSB(numBits) < 256)
+				semiTransparent = true;
+		}
+		if (hasAdd)
+		{
+			ReadUB(numBits * 3);
+			if (hasAlpha && ReadSB(numBits) < 0)
+				semiTransparent = true;
+		}
+		Align();
+
+		return semiTransparent;
+	}
+
+protected:
+	const BYTE*		m_data;
+	unsigned int	m_size;
+	unsigned int	m_pos;
+	unsigned int	m_bitBuf;
+	unsigned int	m_bitCnt;
+	bool			m_overflow;
+};
+
+//---------------------------------------------------------------------
+// SWF tag codes
+enum
+{
+	TAG_END = 0,
+	TAG_SHOW_FRAME = 1,
+	TAG_DEFINE_SHAPE = 2,
+	TAG_PLACE_OBJECT = 4,
+	TAG_REMOVE_OBJECT = 5,
+	TAG_DEFINE_BITS = 6,
+	TAG_DEFINE_BITS_LOSSLESS = 20,
+	TAG_DEFINE_BITS_JPEG2 = 21,
+	TAG_DEFINE_SHAPE2 = 22,
+	TAG_PLACE_OBJECT2 = 26,
+	TAG_REMOVE_OBJECT2 = 28,
+	TAG_DEFINE_SHAPE3 = 32,
+	TAG_DEFINE_BITS_JPEG3 = 35,
+	TAG_DEFINE_BITS_LOSSLESS2 = 36,
+	TAG_DEFINE_EDIT_TEXT = 37,
+	TAG_DEFINE_SPRITE = 39,
+	TAG_DEFINE_MORPH_SHAPE = 46,
+	TAG_PLACE_OBJECT3 = 70,
+	TAG_DEFINE_SHAPE4 = 83,
+	TAG_DEFINE_MORPH_SHAPE2 = 84,
+	TAG_DEFINE_BITS_JPEG4 = 90
+};
+
+//---------------------------------------------------------------------
+// Reads dimensions of embedded JPEG, PNG or GIF image.
+static bool GetImageSize(const BYTE* data, unsigned int size, unsigned int& width, unsigned int& height)
+{
+	if (size >= 24 && data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G')
+	{
+		width = (data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19];
+		height = (data[20] << 24) | (data[21] << 16) | (data[22] << 8) | data[23];
+		return true;
+	}
+
+	if (size >= 10 && data[0] == 'G' && data[1] == 'I' && data[2] == 'F' && data[3] == '8')
+	{
+		width = data[6] | (data[7] << 8);
+		height = data[8] | (data[9] << 8);
+		return true;
+	}
+
+	// Walk JPEG markers up to the start of frame
+	unsigned int pos = 0;
+	while (pos + 4 <= size)
+	{
+		if (data[pos] != 0xFF)
+		{
+			++pos;
+			continue;
+		}
+
+		BYTE marker = data[pos + 1];
+		if (marker == 0xFF)
+		{
+			++pos;
+			continue;
+		}
+		if (marker == 0x01 || marker == 0xD8 || marker == 0xD9 || (marker >= 0xD0 && marker <= 0xD7))
+		{
+			pos += 2;
+			continue;
+		}
+
+		unsigned int length = (data[pos + 2] << 8) | data[pos + 3];
+		bool isStartOfFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+		if (isStartOfFrame && pos + 9 <= size)
+		{
+			height = (data[pos + 5] << 8) | data[pos + 6];
+			width = (data[pos + 7] << 8) | data[pos + 8];
+			return true;
+		}
+
+		pos += 2 + length;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------
+CSWFAnalyzer::CSWFAnalyzer()
+{
+	memset(&m_cost, 0, sizeof(m_cost));
+	m_totalFrameEdges = 0;
+}
+
+//---------------------------------------------------------------------
+bool CSWFAnalyzer::GetProperties(const BYTE* data, unsigned int size, IFlashDX::SMovieProperties& props)
+{
+	if (size < 8 || data[0] != 'F' || data[1] != 'W' || data[2] != 'S')
+		return false;
+
+	CSWFReader reader(data, size);
+	reader.SetPos(8);
+
+	int xMin, xMax, yMin, yMax;
+	reader.ReadRect(xMin, xMax, yMin, yMax);
+	unsigned int frameRate = reader.ReadU16();
+	unsigned int frameCount = reader.ReadU16();
+
+	if (reader.IsOverflow())
+		return false;
+
+	// Stage size is in twips, frame rate is 8.8 fixed point
+	props.m_width = (unsigned int)(xMax - xMin) / 20;
+	props.m_height = (unsigned int)(yMax - yMin) / 20;
+	props.m_fps = (frameRate + 0x80) >> 8;
+	props.m_numFrames = frameCount;
+
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CSWFAnalyzer::Analyze(const BYTE* data, unsigned int size, SMovieCost& cost)
+{
+	IFlashDX::SMovieProperties props;
+	if (!GetProperties(data, size, props))
+		return false;
+
+	memset(&m_cost, 0, sizeof(m_cost));
+	m_characters.clear();
+	m_totalFrameEdges = 0;
+
+	CSWFReader reader(data, size);
+	reader.SetPos(8);
+
+	int xMin, xMax, yMin, yMax;
+	reader.ReadRect(xMin, xMax, yMin, yMax);
+	reader.Skip(4);
+
+	SCharacter maxFrame = { 0, 0 };
+	ParseTags(reader, size, true, maxFrame);
+
+	if (m_cost.m_numFrames == 0)
+		m_cost.m_numFrames = props.m_numFrames;
+	else
+		m_cost.m_avgEdgesPerFrame = (unsigned int)(m_totalFrameEdges / m_cost.m_numFrames);
+
+	Recommend();
+
+	cost = m_cost;
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseTags(CSWFReader& reader, unsigned int end, bool mainTimeline, SCharacter& maxFrame)
+{
+	DisplayList displayList;
+
+	while (reader.GetPos() + 2 <= end && !reader.IsOverflow())
+	{
+		unsigned int codeAndLength = reader.ReadU16();
+		unsigned int tagCode = codeAndLength >> 6;
+		unsigned int tagLength = codeAndLength & 0x3f;
+		if (tagLength == 0x3f)
+			tagLength = reader.ReadU32();
+
+		unsigned int tagStart = reader.GetPos();
+		unsigned int tagEnd = tagStart + tagLength;
+		if (tagEnd > end || tagEnd < tagStart)
+			break;
+
+		switch (tagCode)
+		{
+		case TAG_END:
+			return;
+
+		case TAG_SHOW_FRAME:
+			{
+				SCharacter frame = { 0, 0 };
+				for (DisplayList::const_iterator it = displayList.begin(); it != displayList.end(); ++it)
+				{
+					CharacterMap::const_iterator itChar = m_characters.find(it->second);
+					if (itChar != m_characters.end())
+					{
+						frame.m_shapes += itChar->second.m_shapes;
+						frame.m_edges += itChar->second.m_edges;
+					}
+				}
+
+				maxFrame.m_shapes = max(maxFrame.m_shapes, frame.m_shapes);
+				maxFrame.m_edges = max(maxFrame.m_edges, frame.m_edges);
+
+				if (mainTimeline)
+				{
+					++m_cost.m_numFrames;
+					m_totalFrameEdges += frame.m_edges;
+					m_cost.m_maxShapesPerFrame = maxFrame.m_shapes;
+					m_cost.m_maxEdgesPerFrame = maxFrame.m_edges;
+				}
+			}
+			break;
+
+		case TAG_DEFINE_SHAPE:
+		case TAG_DEFINE_SHAPE2:
+		case TAG_DEFINE_SHAPE3:
+		case TAG_DEFINE_SHAPE4:
+		case TAG_DEFINE_MORPH_SHAPE:
+		case TAG_DEFINE_MORPH_SHAPE2:
+			ParseShape(reader, tagCode);
+			break;
+
+		case TAG_DEFINE_BITS:
+		case TAG_DEFINE_BITS_JPEG2:
+		case TAG_DEFINE_BITS_JPEG3:
+		case TAG_DEFINE_BITS_JPEG4:
+		case TAG_DEFINE_BITS_LOSSLESS:
+		case TAG_DEFINE_BITS_LOSSLESS2:
+			ParseBitmap(reader, tagCode, tagEnd);
+			break;
+
+		case TAG_DEFINE_EDIT_TEXT:
+			ParseEditText(reader);
+			break;
+
+		case TAG_PLACE_OBJECT:
+		case TAG_PLACE_OBJECT2:
+		case TAG_PLACE_OBJECT3:
+			ParsePlaceObject(reader, tagCode, displayList);
+			break;
+
+		case TAG_REMOVE_OBJECT:
+			reader.ReadU16();
+			displayList.erase((unsigned short)reader.ReadU16());
+			break;
+
+		case TAG_REMOVE_OBJECT2:
+			displayList.erase((unsigned short)reader.ReadU16());
+			break;
+
+		case TAG_DEFINE_SPRITE:
+			{
+				// Sprite costs as much as its most expensive frame
+				unsigned short id = (unsigned short)reader.ReadU16();
+				reader.ReadU16();
+				SCharacter spriteFrame = { 0, 0 };
+				ParseTags(reader, tagEnd, false, spriteFrame);
+				m_characters[id] = spriteFrame;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		reader.SetPos(tagEnd);
+	}
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseShape(CSWFReader& reader, unsigned int tagCode)
+{
+	unsigned short id = (unsigned short)reader.ReadU16();
+
+	SCharacter shape = { 1, 0 };
+	++m_cost.m_numShapes;
+
+	if (tagCode == TAG_DEFINE_MORPH_SHAPE || tagCode == TAG_DEFINE_MORPH_SHAPE2)
+	{
+		// Morph shapes are counted, but not walked
+		m_characters[id] = shape;
+		return;
+	}
+
+	unsigned int shapeVersion = 1;
+	if (tagCode == TAG_DEFINE_SHAPE2) shapeVersion = 2;
+	else if (tagCode == TAG_DEFINE_SHAPE3) shapeVersion = 3;
+	else if (tagCode == TAG_DEFINE_SHAPE4) shapeVersion = 4;
+
+	int xMin, xMax, yMin, yMax;
+	reader.ReadRect(xMin, xMax, yMin, yMax);
+	if (shapeVersion == 4)
+	{
+		reader.ReadRect(xMin, xMax, yMin, yMax);
+		reader.ReadU8();
+	}
+
+	ParseFillStyles(reader, shapeVersion);
+	ParseLineStyles(reader, shapeVersion);
+
+	reader.Align();
+	unsigned int numFillBits = reader.ReadUB(4);
+	unsigned int numLineBits = reader.ReadUB(4);
+
+	while (!reader.IsOverflow())
+	{
+		if (reader.ReadUB(1) == 0)
+		{
+			// Style change record
+			unsigned int flags = reader.ReadUB(5);
+			if (flags == 0)
+				break;
+
+			if (flags & 0x01)
+			{
+				unsigned int numMoveBits = reader.ReadUB(5);
+				reader.ReadUB(numMoveBits * 2);
+			}
+			if (flags & 0x02)
+				reader.ReadUB(numFillBits);
+			if (flags & 0x04)
+				reader.ReadUB(numFillBits);
+			if (flags & 0x08)
+				reader.ReadUB(numLineBits);
+			if (flags & 0x10)
+			{
+				ParseFillStyles(reader, shapeVersion);
+				ParseLineStyles(reader, shapeVersion);
+				reader.Align();
+				numFillBits = reader.ReadUB(4);
+				numLineBits = reader.ReadUB(4);
+			}
+		}
+		else
+		{
+			// Edge record
+			bool straight = reader.ReadUB(1) != 0;
+			unsigned int numBits = reader.ReadUB(4) + 2;
+			if (straight)
+			{
+				if (reader.ReadUB(1))
+					reader.ReadUB(numBits * 2);
+				else
+					reader.ReadUB(numBits + 1);
+			}
+			else
+			{
+				reader.ReadUB(numBits * 4);
+			}
+
+			++shape.m_edges;
+		}
+	}
+
+	m_cost.m_numEdges += shape.m_edges;
+	m_characters[id] = shape;
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseFillStyles(CSWFReader& reader, unsigned int shapeVersion)
+{
+	unsigned int count = reader.ReadU8();
+	if (count == 0xFF && shapeVersion >= 2)
+		count = reader.ReadU16();
+
+	for (unsigned int i = 0; i < count && !reader.IsOverflow(); ++i)
+		ParseFillStyle(reader, shapeVersion);
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseFillStyle(CSWFReader& reader, unsigned int shapeVersion)
+{
+	unsigned int type = reader.ReadU8();
+	switch (type)
+	{
+	case 0x00:
+		ParseColor(reader, shapeVersion >= 3);
+		break;
+	case 0x10:
+	case 0x12:
+	case 0x13:
+		{
+			reader.SkipMatrix();
+			unsigned int numGradients = reader.ReadU8() & 0x0f;
+			for (unsigned int i = 0; i < numGradients; ++i)
+			{
+				reader.ReadU8();
+				ParseColor(reader, shapeVersion >= 3);
+			}
+			if (type == 0x13)
+				reader.ReadU16();
+		}
+		break;
+	case 0x40:
+	case 0x41:
+	case 0x42:
+	case 0x43:
+		reader.ReadU16();
+		reader.SkipMatrix();
+		break;
+	default:
+		break;
+	}
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseLineStyles(CSWFReader& reader, unsigned int shapeVersion)
+{
+	unsigned int count = reader.ReadU8();
+	if (count == 0xFF)
+		count = reader.ReadU16();
+
+	for (unsigned int i = 0; i < count && !reader.IsOverflow(); ++i)
+	{
+		reader.ReadU16();
+		if (shapeVersion < 4)
+		{
+			ParseColor(reader, shapeVersion >= 3);
+			continue;
+		}
+
+		// LINESTYLE2
+		reader.ReadUB(2);
+		unsigned int joinStyle = reader.ReadUB(2);
+		bool hasFill = reader.ReadUB(1) != 0;
+		reader.ReadUB(11);
+		if (joinStyle == 2)
+			reader.ReadU16();
+		if (hasFill)
+			ParseFillStyle(reader, shapeVersion);
+		else
+			ParseColor(reader, true);
+	}
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseColor(CSWFReader& reader, bool hasAlpha)
+{
+	reader.Skip(3);
+	if (hasAlpha && reader.ReadU8() < 255)
+		m_cost.m_hasSemiTransparency = true;
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseBitmap(CSWFReader& reader, unsigned int tagCode, unsigned int tagEnd)
+{
+	reader.ReadU16();
+
+	unsigned int width = 0, height = 0;
+	switch (tagCode)
+	{
+	case TAG_DEFINE_BITS_LOSSLESS:
+	case TAG_DEFINE_BITS_LOSSLESS2:
+		reader.ReadU8();
+		width = reader.ReadU16();
+		height = reader.ReadU16();
+		break;
+
+	case TAG_DEFINE_BITS_JPEG3:
+	case TAG_DEFINE_BITS_JPEG4:
+		{
+			unsigned int alphaDataOffset = reader.ReadU32();
+			if (tagCode == TAG_DEFINE_BITS_JPEG4)
+				reader.ReadU16();
+			unsigned int imageStart = reader.GetPos();
+			unsigned int imageSize = min(alphaDataOffset, tagEnd - min(tagEnd, imageStart));
+			if (!reader.IsOverflow())
+				GetImageSize(reader.GetData() + imageStart, imageSize, width, height);
+		}
+		break;
+
+	default:
+		if (!reader.IsOverflow() && tagEnd > reader.GetPos())
+			GetImageSize(reader.GetData() + reader.GetPos(), tagEnd - reader.GetPos(), width, height);
+		break;
+	}
+
+	if (tagCode == TAG_DEFINE_BITS_JPEG3 || tagCode == TAG_DEFINE_BITS_JPEG4 || tagCode == TAG_DEFINE_BITS_LOSSLESS2)
+		m_cost.m_hasSemiTransparency = true;
+
+	AddBitmap(width, height);
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::AddBitmap(unsigned int width, unsigned int height)
+{
+	++m_cost.m_numBitmaps;
+	m_cost.m_maxBitmapWidth = max(m_cost.m_maxBitmapWidth, width);
+	m_cost.m_maxBitmapHeight = max(m_cost.m_maxBitmapHeight, height);
+	m_cost.m_bitmapMemory += width * height * 4;
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseEditText(CSWFReader& reader)
+{
+	reader.ReadU16();
+
+	int xMin, xMax, yMin, yMax;
+	reader.ReadRect(xMin, xMax, yMin, yMax);
+
+	reader.ReadU8();
+	unsigned int flags = reader.ReadU8();
+
+	// HasFontClass, AutoSize, HasLayout, NoSelect, Border, WasStatic, HTML, UseOutlines
+	bool useOutlines = (flags & 0x01) != 0;
+	if (!useOutlines && !reader.IsOverflow())
+		++m_cost.m_numDeviceFontTexts;
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParsePlaceObject(CSWFReader& reader, unsigned int tagCode, DisplayList& displayList)
+{
+	if (tagCode == TAG_PLACE_OBJECT)
+	{
+		unsigned short id = (unsigned short)reader.ReadU16();
+		unsigned short depth = (unsigned short)reader.ReadU16();
+		displayList[depth] = id;
+		return;
+	}
+
+	unsigned int flags = reader.ReadU8();
+	unsigned int flags2 = (tagCode == TAG_PLACE_OBJECT3) ? reader.ReadU8() : 0;
+	unsigned short depth = (unsigned short)reader.ReadU16();
+
+	// HasClassName or HasImage with HasCharacter
+	if ((flags2 & 0x08) || ((flags2 & 0x10) && (flags & 0x02)))
+		reader.SkipString();
+	if (flags & 0x02)
+		displayList[depth] = (unsigned short)reader.ReadU16();
+	if (flags & 0x04)
+		reader.SkipMatrix();
+	if (flags & 0x08)
+	{
+		if (reader.ReadColorTransform(true))
+			m_cost.m_hasSemiTransparency = true;
+	}
+	if (flags & 0x10)
+		reader.ReadU16();
+	if (flags & 0x20)
+		reader.SkipString();
+	if (flags & 0x40)
+		reader.ReadU16();
+	if (flags2 & 0x01)
+		ParseFilters(reader);
+	if (flags2 & 0x02)
+	{
+		// 0 and 1 both mean normal blending
+		if (reader.ReadU8() > 1)
+			++m_cost.m_numBlendModes;
+	}
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::ParseFilters(CSWFReader& reader)
+{
+	unsigned int numFilters = reader.ReadU8();
+	for (unsigned int i = 0; i < numFilters && !reader.IsOverflow(); ++i)
+	{
+		++m_cost.m_numFilters;
+		m_cost.m_hasSemiTransparency = true;
+
+		switch (reader.ReadU8())
+		{
+		case 0: reader.Skip(23); break;		// drop shadow
+		case 1: reader.Skip(9); break;		// blur
+		case 2: reader.Skip(15); break;		// glow
+		case 3: reader.Skip(27); break;		// bevel
+		case 4:								// gradient glow
+		case 7:								// gradient bevel
+			reader.Skip(reader.ReadU8() * 5 + 19);
+			break;
+		case 5:								// convolution
+			{
+				unsigned int matrixX = reader.ReadU8();
+				unsigned int matrixY = reader.ReadU8();
+				reader.Skip(8 + matrixX * matrixY * 4 + 5);
+			}
+			break;
+		case 6: reader.Skip(80); break;		// color matrix
+		default:
+			return;
+		}
+	}
+}
+
+//---------------------------------------------------------------------
+void CSWFAnalyzer::Recommend()
+{
+	m_cost.m_recommendedQuality = IFlashDXPlayer::QUALITY_HIGH;
+	if (m_cost.m_maxEdgesPerFrame > s_lowQualityEdges)
+		m_cost.m_recommendedQuality = IFlashDXPlayer::QUALITY_LOW;
+	else if (m_cost.m_maxEdgesPerFrame > s_mediumQualityEdges || m_cost.m_bitmapMemory > s_mediumQualityBitmapMemory)
+		m_cost.m_recommendedQuality = IFlashDXPlayer::QUALITY_MEDIUM;
+
+	// FULL_ALPHA renders every frame twice, it's worth it only if movie has semi-transparent content
+	m_cost.m_recommendedTransparencyMode = m_cost.m_hasSemiTransparency ?
+		IFlashDXPlayer::TMODE_FULL_ALPHA : IFlashDXPlayer::TMODE_TRANSPARENT;
+}
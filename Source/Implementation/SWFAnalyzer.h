@@ -0,0 +1,75 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "IFlashDX.h"
+#include <map>
+
+//---------------------------------------------------------------------
+/// Walks tags of uncompressed (FWS) movie and estimates rendering cost.
+//---------------------------------------------------------------------
+class CSWFAnalyzer
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CSWFAnalyzer();
+
+	//---------------------------------------------------------------------
+	/// Reads movie header.
+	static bool GetProperties(const BYTE* data, unsigned int size, IFlashDX::SMovieProperties& props);
+
+	//---------------------------------------------------------------------
+	/// Analyzes movie and fills cost description.
+	bool Analyze(const BYTE* data, unsigned int size, SMovieCost& cost);
+
+protected:
+	//---------------------------------------------------------------------
+	struct SCharacter
+	{
+		unsigned int	m_shapes;
+		unsigned int	m_edges;
+	};
+
+	typedef std::map<unsigned short, SCharacter> CharacterMap;
+	typedef std::map<unsigned short, unsigned short> DisplayList;	// depth -> character
+
+	//---------------------------------------------------------------------
+	void ParseTags(class CSWFReader& reader, unsigned int end, bool mainTimeline, SCharacter& maxFrame);
+	void ParseShape(CSWFReader& reader, unsigned int tagCode);
+	void ParseBitmap(CSWFReader& reader, unsigned int tagCode, unsigned int tagEnd);
+	void ParseEditText(CSWFReader& reader);
+	void ParsePlaceObject(CSWFReader& reader, unsigned int tagCode, DisplayList& displayList);
+	void ParseFillStyles(CSWFReader& reader, unsigned int shapeVersion);
+	void ParseLineStyles(CSWFReader& reader, unsigned int shapeVersion);
+	void ParseFillStyle(CSWFReader& reader, unsigned int shapeVersion);
+	void ParseColor(CSWFReader& reader, bool hasAlpha);
+	void ParseFilters(CSWFReader& reader);
+	void AddBitmap(unsigned int width, unsigned int height);
+	void Recommend();
+
+protected:
+	SMovieCost				m_cost;
+	CharacterMap			m_characters;
+	unsigned __int64		m_totalFrameEdges;
+};
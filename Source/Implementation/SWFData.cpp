@@ -0,0 +1,526 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SWFData.h"
+
+//---------------------------------------------------------------------
+// zlib stream inflater (RFC 1950/1951), used for CWS movies.
+//---------------------------------------------------------------------
+namespace
+{
+	const int MAX_BITS = 15;
+	const int MAX_LCODES = 286;
+	const int MAX_DCODES = 30;
+	const int FIX_LCODES = 288;
+
+	struct SHuffman
+	{
+		short	count[MAX_BITS + 1];
+		short	symbol[FIX_LCODES];
+	};
+
+	struct SInflateState
+	{
+		const BYTE*		in;
+		unsigned int	inSize;
+		unsigned int	inPos;
+		unsigned int	bitBuf;
+		unsigned int	bitCnt;
+		BYTE*			out;
+		unsigned int	outSize;
+		unsigned int	outPos;
+		bool			error;
+	};
+
+	//---------------------------------------------------------------------
+	int GetBits(SInflateState& s, unsigned int need)
+	{
+		unsigned int val = s.bitBuf;
+		while (s.bitCnt < need)
+		{
+			if (s.inPos == s.inSize)
+			{
+				s.error = true;
+				return 0;
+			}
+			val |= (unsigned int)s.in[s.inPos++] << s.bitCnt;
+			s.bitCnt += 8;
+		}
+		s.bitBuf = val >> need;
+		s.bitCnt -= need;
+		return (int)(val & ((1U << need) - 1));
+	}
+
+	//---------------------------------------------------------------------
+	int Decode(SInflateState& s, const SHuffman& h)
+	{
+		int code = 0, first = 0, index = 0;
+		for (int len = 1; len <= MAX_BITS; ++len)
+		{
+			code |= GetBits(s, 1);
+			if (s.error)
+				return -1;
+			int count = h.count[len];
+			if (code - count < first)
+				return h.symbol[index + (code - first)];
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+		return -1;
+	}
+
+	//---------------------------------------------------------------------
+	// Returns zero for complete code, negative for over-subscribed and positive for incomplete code.
+	int Construct(SHuffman& h, const short* length, int n)
+	{
+		for (int len = 0; len <= MAX_BITS; ++len)
+			h.count[len] = 0;
+		for (int symbol = 0; symbol < n; ++symbol)
+			h.count[length[symbol]]++;
+		if (h.count[0] == n)
+			return 0;
+
+		int left = 1;
+		for (int len = 1; len <= MAX_BITS; ++len)
+		{
+			left <<= 1;
+			left -= h.count[len];
+			if (left < 0)
+				return left;
+		}
+
+		short offs[MAX_BITS + 1];
+		offs[1] = 0;
+		for (int len = 1; len < MAX_BITS; ++len)
+			offs[len + 1] = offs[len] + h.count[len];
+
+		for (int symbol = 0; symbol < n; ++symbol)
+			if (length[symbol] != 0)
+				h.symbol[offs[length[symbol]]++] = (short)symbol;
+
+		return left;
+	}
+
+	//---------------------------------------------------------------------
+	bool Stored(SInflateState& s)
+	{
+		s.bitBuf = 0;
+		s.bitCnt = 0;
+
+		if (s.inPos + 4 > s.inSize)
+			return false;
+		unsigned int len = s.in[s.inPos] | (s.in[s.inPos + 1] << 8);
+		unsigned int nlen = s.in[s.inPos + 2] | (s.in[s.inPos + 3] << 8);
+		s.inPos += 4;
+		if (len != (~nlen & 0xffff))
+			return false;
+
+		if (s.inPos + len > s.inSize || s.outPos + len > s.outSize)
+			return false;
+		memcpy(s.out + s.outPos, s.in + s.inPos, len);
+		s.inPos += len;
+		s.outPos += len;
+		return true;
+	}
+
+	//---------------------------------------------------------------------
+	bool Codes(SInflateState& s, const SHuffman& lencode, const SHuffman& distcode)
+	{
+		static const short lens[29] = {
+			3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const short lext[29] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const short dists[30] = {
+			1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+			8193, 12289, 16385, 24577 };
+		static const short dext[30] = {
+			0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		int symbol;
+		do
+		{
+			symbol = Decode(s, lencode);
+			if (symbol < 0)
+				return false;
+
+			if (symbol < 256)
+			{
+				if (s.outPos == s.outSize)
+					return false;
+				s.out[s.outPos++] = (BYTE)symbol;
+			}
+			else if (symbol > 256)
+			{
+				symbol -= 257;
+				if (symbol >= 29)
+					return false;
+				unsigned int len = lens[symbol] + GetBits(s, lext[symbol]);
+
+				symbol = Decode(s, distcode);
+				if (symbol < 0)
+					return false;
+				unsigned int dist = dists[symbol] + GetBits(s, dext[symbol]);
+				if (s.error || dist > s.outPos || s.outPos + len > s.outSize)
+					return false;
+
+				for (; len > 0; --len, ++s.outPos)
+					s.out[s.outPos] = s.out[s.outPos - dist];
+			}
+		}
+		while (symbol != 256);
+
+		return true;
+	}
+
+	//---------------------------------------------------------------------
+	// Fixed Huffman tables, built during static initialization so loader threads only ever read them.
+	struct SFixedTables
+	{
+		SHuffman	lencode;
+		SHuffman	distcode;
+
+		SFixedTables()
+		{
+			short lengths[FIX_LCODES];
+			int symbol = 0;
+			for (; symbol < 144; ++symbol) lengths[symbol] = 8;
+			for (; symbol < 256; ++symbol) lengths[symbol] = 9;
+			for (; symbol < 280; ++symbol) lengths[symbol] = 7;
+			for (; symbol < FIX_LCODES; ++symbol) lengths[symbol] = 8;
+			Construct(lencode, lengths, FIX_LCODES);
+
+			for (symbol = 0; symbol < MAX_DCODES; ++symbol)
+				lengths[symbol] = 5;
+			Construct(distcode, lengths, MAX_DCODES);
+		}
+	};
+
+	const SFixedTables s_fixedTables;
+
+	//---------------------------------------------------------------------
+	bool Fixed(SInflateState& s)
+	{
+		return Codes(s, s_fixedTables.lencode, s_fixedTables.distcode);
+	}
+
+	//---------------------------------------------------------------------
+	bool Dynamic(SInflateState& s)
+	{
+		static const short order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		int nlen = GetBits(s, 5) + 257;
+		int ndist = GetBits(s, 5) + 1;
+		int ncode = GetBits(s, 4) + 4;
+		if (s.error || nlen > MAX_LCODES || ndist > MAX_DCODES)
+			return false;
+
+		short lengths[MAX_LCODES + MAX_DCODES];
+		int index;
+		for (index = 0; index < ncode; ++index)
+			lengths[order[index]] = (short)GetBits(s, 3);
+		for (; index < 19; ++index)
+			lengths[order[index]] = 0;
+
+		SHuffman lencode, distcode;
+		if (s.error || Construct(lencode, lengths, 19) != 0)
+			return false;
+
+		index = 0;
+		while (index < nlen + ndist)
+		{
+			int symbol = Decode(s, lencode);
+			if (symbol < 0)
+				return false;
+
+			if (symbol < 16)
+			{
+				lengths[index++] = (short)symbol;
+			}
+			else
+			{
+				short len = 0;
+				if (symbol == 16)
+				{
+					if (index == 0)
+						return false;
+					len = lengths[index - 1];
+					symbol = 3 + GetBits(s, 2);
+				}
+				else if (symbol == 17)
+					symbol = 3 + GetBits(s, 3);
+				else
+					symbol = 11 + GetBits(s, 7);
+
+				if (s.error || index + symbol > nlen + ndist)
+					return false;
+				while (symbol--)
+					lengths[index++] = len;
+			}
+		}
+
+		if (lengths[256] == 0)
+			return false;
+
+		int err = Construct(lencode, lengths, nlen);
+		if (err < 0 || (err > 0 && nlen != lencode.count[0] + lencode.count[1]))
+			return false;
+
+		err = Construct(distcode, lengths + nlen, ndist);
+		if (err < 0 || (err > 0 && ndist != distcode.count[0] + distcode.count[1]))
+			return false;
+
+		return Codes(s, lencode, distcode);
+	}
+
+	//---------------------------------------------------------------------
+	bool InflateZlib(const BYTE* source, unsigned int sourceSize, BYTE* dest, unsigned int destSize, unsigned int& written)
+	{
+		written = 0;
+
+		// zlib header: deflate method, no preset dictionary
+		if (sourceSize < 2 || (source[0] & 0x0f) != 8 || ((source[0] << 8) | source[1]) % 31 != 0 || (source[1] & 0x20))
+			return false;
+
+		SInflateState s = { 0 };
+		s.in = source + 2;
+		s.inSize = sourceSize - 2;
+		s.out = dest;
+		s.outSize = destSize;
+
+		int last;
+		do
+		{
+			last = GetBits(s, 1);
+			int type = GetBits(s, 2);
+			if (s.error)
+				break;
+
+			bool result = false;
+			switch (type)
+			{
+			case 0: result = Stored(s); break;
+			case 1: result = Fixed(s); break;
+			case 2: result = Dynamic(s); break;
+			default: break;
+			}
+
+			if (!result || s.error)
+			{
+				s.error = true;
+				break;
+			}
+		}
+		while (!last);
+
+		written = s.outPos;
+		return !s.error;
+	}
+}
+
+//---------------------------------------------------------------------
+CSWFData::CSWFData()
+{
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::LoadFromFile(const wchar_t* path, volatile LONG* progress, volatile LONG* cancel)
+{
+	m_data.clear();
+
+	HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD size = GetFileSize(file, NULL);
+	bool result = false;
+	if (size != INVALID_FILE_SIZE && size > 0)
+	{
+		m_data.resize(size);
+
+		// Read in chunks, so the caller can watch progress and cancel
+		const DWORD chunkSize = progress || cancel ? 256 * 1024 : size;
+		DWORD offset = 0;
+		result = true;
+
+		while (result && offset < size)
+		{
+			if (cancel && *cancel)
+			{
+				result = false;
+				break;
+			}
+
+			DWORD toRead = min(chunkSize, size - offset);
+			DWORD read = 0;
+			result = ReadFile(file, &m_data[offset], toRead, &read, NULL) && read == toRead;
+			offset += read;
+
+			if (progress)
+				InterlockedExchange(progress, LONG((unsigned __int64)offset * 100 / size));
+		}
+	}
+
+	CloseHandle(file);
+
+	if (!result)
+		m_data.clear();
+
+	return result && IsValid();
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::LoadHeaderFromFile(const wchar_t* path)
+{
+	m_data.clear();
+
+	HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_data.resize(HEADER_READ_SIZE);
+	DWORD read = 0;
+	bool result = ReadFile(file, &m_data[0], HEADER_READ_SIZE, &read, NULL) && read > 0;
+	m_data.resize(result ? read : 0);
+
+	CloseHandle(file);
+
+	return result && IsValid();
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::LoadFromMemory(const void* data, unsigned int size)
+{
+	m_data.assign((const BYTE*)data, (const BYTE*)data + size);
+	return IsValid();
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::LoadHeaderFromMemory(const void* data, unsigned int size)
+{
+	return LoadFromMemory(data, min(size, (unsigned int)HEADER_READ_SIZE));
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::IsValid() const
+{
+	return m_data.size() >= 8 &&
+		   (m_data[0] == 'F' || m_data[0] == 'C' || m_data[0] == 'Z') &&
+		   m_data[1] == 'W' && m_data[2] == 'S';
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::IsCompressed() const
+{
+	return IsValid() && m_data[0] != 'F';
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::Decompress()
+{
+	if (!IsValid())
+		return false;
+
+	if (m_data[0] == 'F')
+		return true;
+
+	if (m_data[0] != 'C')
+		return false;
+
+	unsigned int fileLength = m_data[4] | (m_data[5] << 8) | (m_data[6] << 16) | (m_data[7] << 24);
+	if (fileLength <= 8 || m_data.size() <= 8)
+		return false;
+
+	// Length comes from the file, don't let a corrupted header allocate more than the data can inflate to
+	if (fileLength > MAX_MOVIE_SIZE || fileLength - 8 > (unsigned __int64)(m_data.size() - 8) * MAX_INFLATE_RATIO)
+		return false;
+
+	std::vector<BYTE> result(fileLength);
+	memcpy(&result[0], &m_data[0], 8);
+	result[0] = 'F';
+
+	unsigned int written = 0;
+	if (!InflateZlib(&m_data[8], (unsigned int)m_data.size() - 8, &result[8], fileLength - 8, written) ||
+		written != fileLength - 8)
+	{
+		return false;
+	}
+
+	m_data.swap(result);
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CSWFData::DecompressHeader()
+{
+	if (!IsValid())
+		return false;
+
+	if (m_data[0] == 'F')
+		return true;
+
+	if (m_data[0] != 'C')
+		return false;
+
+	unsigned int fileLength = m_data[4] | (m_data[5] << 8) | (m_data[6] << 16) | (m_data[7] << 24);
+	if (fileLength <= 8 || m_data.size() <= 8)
+		return false;
+
+	// Inflater stops with error when output or input is exhausted, but everything written so far is valid
+	unsigned int resultLength = min(fileLength, (unsigned int)HEADER_READ_SIZE);
+	std::vector<BYTE> result(resultLength);
+	memcpy(&result[0], &m_data[0], 8);
+	result[0] = 'F';
+
+	unsigned int written = 0;
+	InflateZlib(&m_data[8], (unsigned int)m_data.size() - 8, &result[8], resultLength - 8, written);
+	if (8 + written < min(fileLength, (unsigned int)HEADER_SIZE))
+		return false;
+
+	result.resize(8 + written);
+	m_data.swap(result);
+	return true;
+}
+
+//---------------------------------------------------------------------
+const BYTE* CSWFData::GetData() const
+{
+	return m_data.empty() ? NULL : &m_data[0];
+}
+
+//---------------------------------------------------------------------
+unsigned int CSWFData::GetSize() const
+{
+	return (unsigned int)m_data.size();
+}
+
+//---------------------------------------------------------------------
+std::vector<BYTE>& CSWFData::GetBuffer()
+{
+	return m_data;
+}
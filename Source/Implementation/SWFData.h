@@ -0,0 +1,83 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+//---------------------------------------------------------------------
+/// SWF file data. Handles reading and decompression of movies.
+//---------------------------------------------------------------------
+class CSWFData
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CSWFData();
+
+	//---------------------------------------------------------------------
+	/// Reads movie from file. Optionally reports reading progress in percents and checks cancel flag.
+	bool LoadFromFile(const wchar_t* path, volatile LONG* progress = NULL, volatile LONG* cancel = NULL);
+
+	//---------------------------------------------------------------------
+	/// Reads beginning of the movie file, enough to get the header with DecompressHeader().
+	bool LoadHeaderFromFile(const wchar_t* path);
+
+	//---------------------------------------------------------------------
+	/// Copies movie from memory.
+	bool LoadFromMemory(const void* data, unsigned int size);
+
+	//---------------------------------------------------------------------
+	/// Copies beginning of the movie, enough to get the header with DecompressHeader().
+	bool LoadHeaderFromMemory(const void* data, unsigned int size);
+
+	//---------------------------------------------------------------------
+	/// Checks if data starts with valid SWF signature.
+	bool IsValid() const;
+
+	//---------------------------------------------------------------------
+	/// Checks if movie is compressed (CWS or ZWS).
+	bool IsCompressed() const;
+
+	//---------------------------------------------------------------------
+	/// Inflates CWS movie to FWS in place. LZMA (ZWS) movies are not supported.
+	bool Decompress();
+
+	//---------------------------------------------------------------------
+	/// Inflates only the beginning of CWS movie, enough to read the header. The rest of data is dropped.
+	bool DecompressHeader();
+
+	//---------------------------------------------------------------------
+	/// Returns movie data.
+	const BYTE* GetData() const;
+	unsigned int GetSize() const;
+	std::vector<BYTE>& GetBuffer();
+
+protected:
+	enum
+	{
+		HEADER_SIZE = 8 + 17 + 4,		// signature and length, largest stage rect, frame rate and count
+		HEADER_READ_SIZE = 4096,		// compressed bytes that surely hold the header
+		MAX_MOVIE_SIZE = 512 << 20,		// larger declared lengths are rejected as corrupted
+		MAX_INFLATE_RATIO = 1032		// deflate can't expand data more than that
+	};
+
+	std::vector<BYTE>		m_data;
+};
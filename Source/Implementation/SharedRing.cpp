@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SharedRing.h"
+
+//---------------------------------------------------------------------
+// Ring header signature, 'FDXQ'.
+static const DWORD s_ringSignature = 0x51584446;
+
+//---------------------------------------------------------------------
+CSharedRing::CSharedRing()
+{
+	m_header = NULL;
+	m_data = NULL;
+	m_mask = 0;
+	m_position = 0;
+	m_messageEnd = 0;
+}
+
+//---------------------------------------------------------------------
+unsigned int CSharedRing::GetMemorySize(unsigned int capacity)
+{
+	return sizeof(SHeader) + capacity;
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::Create(void* memory, unsigned int capacity)
+{
+	assert((capacity & (capacity - 1)) == 0);
+
+	m_header = (SHeader*)memory;
+	memset(m_header, 0, sizeof(SHeader));
+	m_header->m_capacity = capacity;
+	m_data = (BYTE*)memory + sizeof(SHeader);
+	m_mask = capacity - 1;
+
+	// Signature goes last, the other side may be polling for it
+	MemoryBarrier();
+	m_header->m_signature = s_ringSignature;
+}
+
+//---------------------------------------------------------------------
+bool CSharedRing::Attach(void* memory)
+{
+	SHeader* header = (SHeader*)memory;
+	if (header->m_signature != s_ringSignature)
+		return false;
+
+	MemoryBarrier();
+
+	// Positions are masked with capacity - 1, anything but a power of two would index past the data
+	DWORD capacity = header->m_capacity;
+	if (capacity <= sizeof(DWORD) || (capacity & (capacity - 1)) != 0)
+		return false;
+
+	m_header = header;
+	m_data = (BYTE*)memory + sizeof(SHeader);
+	m_mask = capacity - 1;
+	return true;
+}
+
+//---------------------------------------------------------------------
+unsigned int CSharedRing::GetMaxMessageSize() const
+{
+	return m_mask + 1 - sizeof(DWORD);
+}
+
+//---------------------------------------------------------------------
+bool CSharedRing::BeginWrite(unsigned int size)
+{
+	DWORD writePosition = (DWORD)m_header->m_writePosition;
+	DWORD readPosition = (DWORD)m_header->m_readPosition;
+	DWORD freeSpace = m_mask + 1 - (writePosition - readPosition);
+	if (size > GetMaxMessageSize() || sizeof(DWORD) + size > freeSpace)
+		return false;
+
+	// Consumer must be done with the space before it is overwritten
+	MemoryBarrier();
+
+	DWORD messageSize = size;
+	CopyIn(writePosition, &messageSize, sizeof(messageSize));
+	m_position = writePosition + sizeof(DWORD);
+	m_messageEnd = m_position + size;
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::WriteData(const void* data, unsigned int size)
+{
+	assert(m_position + size <= m_messageEnd);
+
+	CopyIn(m_position, data, size);
+	m_position += size;
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::EndWrite()
+{
+	// Message must be visible before the consumer sees the new position
+	MemoryBarrier();
+	m_header->m_writePosition = (LONG)m_messageEnd;
+}
+
+//---------------------------------------------------------------------
+bool CSharedRing::Write(const void* data, unsigned int size)
+{
+	if (!BeginWrite(size))
+		return false;
+
+	WriteData(data, size);
+	EndWrite();
+	return true;
+}
+
+//---------------------------------------------------------------------
+bool CSharedRing::BeginRead(unsigned int& size)
+{
+	DWORD readPosition = (DWORD)m_header->m_readPosition;
+	DWORD writePosition = (DWORD)m_header->m_writePosition;
+	if (writePosition == readPosition)
+		return false;
+
+	MemoryBarrier();
+
+	// Size comes from the other process, ring holding a message larger than written data is corrupt
+	DWORD messageSize = 0;
+	DWORD usedSpace = writePosition - readPosition;
+	if (usedSpace < sizeof(DWORD) || usedSpace > m_mask + 1)
+		return false;
+	CopyOut(readPosition, &messageSize, sizeof(messageSize));
+	if (messageSize > GetMaxMessageSize() || sizeof(DWORD) + messageSize > usedSpace)
+		return false;
+	m_position = readPosition + sizeof(DWORD);
+	m_messageEnd = m_position + messageSize;
+
+	size = messageSize;
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::ReadData(void* data, unsigned int size)
+{
+	assert(m_position + size <= m_messageEnd);
+
+	CopyOut(m_position, data, size);
+	m_position += size;
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::EndRead()
+{
+	// Message must be taken before the producer may overwrite it
+	MemoryBarrier();
+	m_header->m_readPosition = (LONG)m_messageEnd;
+}
+
+//---------------------------------------------------------------------
+bool CSharedRing::Read(std::vector<BYTE>& message)
+{
+	unsigned int size = 0;
+	if (!BeginRead(size))
+		return false;
+
+	message.resize(size);
+	if (size)
+		ReadData(&message[0], size);
+	EndRead();
+	return true;
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::CopyIn(DWORD position, const void* data, unsigned int size)
+{
+	DWORD offset = position & m_mask;
+	unsigned int firstPart = m_mask + 1 - offset;
+	if (firstPart >= size)
+	{
+		memcpy(m_data + offset, data, size);
+	}
+	else
+	{
+		memcpy(m_data + offset, data, firstPart);
+		memcpy(m_data, (const BYTE*)data + firstPart, size - firstPart);
+	}
+}
+
+//---------------------------------------------------------------------
+void CSharedRing::CopyOut(DWORD position, void* data, unsigned int size) const
+{
+	DWORD offset = position & m_mask;
+	unsigned int firstPart = m_mask + 1 - offset;
+	if (firstPart >= size)
+	{
+		memcpy(data, m_data + offset, size);
+	}
+	else
+	{
+		memcpy(data, m_data + offset, firstPart);
+		memcpy((BYTE*)data + firstPart, m_data, size - firstPart);
+	}
+}
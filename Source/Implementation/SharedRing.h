@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+#include "Portable.h"
+
+//---------------------------------------------------------------------
+/// Single producer, single consumer ring of variable size messages placed in caller provided memory,
+/// e.g. a file mapping shared by two processes. Message is a DWORD size followed by the data, both may wrap.
+//---------------------------------------------------------------------
+class CSharedRing
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CSharedRing();
+
+	//---------------------------------------------------------------------
+	/// Returns bytes of memory the ring takes. Capacity must be a power of two.
+	static unsigned int GetMemorySize(unsigned int capacity);
+
+	//---------------------------------------------------------------------
+	/// Initializes empty ring in the memory. Called by one side before the other one attaches.
+	void Create(void* memory, unsigned int capacity);
+
+	//---------------------------------------------------------------------
+	/// Attaches to the ring initialized by Create(). Fails if the memory doesn't hold a ring.
+	bool Attach(void* memory);
+
+	//---------------------------------------------------------------------
+	/// Returns size of the largest message that fits into the empty ring.
+	unsigned int GetMaxMessageSize() const;
+
+	//---------------------------------------------------------------------
+	/// Producer side. BeginWrite() fails if there is no room for the message now.
+	/// Data is written in parts and becomes visible to the consumer at EndWrite().
+	bool BeginWrite(unsigned int size);
+	void WriteData(const void* data, unsigned int size);
+	void EndWrite();
+	bool Write(const void* data, unsigned int size);
+
+	//---------------------------------------------------------------------
+	/// Consumer side. BeginRead() fails if the ring is empty or corrupt.
+	/// Data is read in parts, EndRead() frees the whole message even if some of it wasn't read.
+	bool BeginRead(unsigned int& size);
+	void ReadData(void* data, unsigned int size);
+	void EndRead();
+	bool Read(std::vector<BYTE>& message);
+
+protected:
+	//---------------------------------------------------------------------
+	/// Positions are free running byte counters, producer and consumer ones are on separate cache lines.
+	struct SHeader
+	{
+		DWORD					m_signature;
+		DWORD					m_capacity;
+		BYTE					m_padding0[56];
+		volatile LONG			m_writePosition;	// written by producer only
+		BYTE					m_padding1[60];
+		volatile LONG			m_readPosition;		// written by consumer only
+		BYTE					m_padding2[60];
+	};
+
+	//---------------------------------------------------------------------
+	void CopyIn(DWORD position, const void* data, unsigned int size);
+	void CopyOut(DWORD position, void* data, unsigned int size) const;
+
+protected:
+	SHeader*				m_header;
+	BYTE*					m_data;
+	DWORD					m_mask;
+	DWORD					m_position;			// cursor of the message being written or read
+	DWORD					m_messageEnd;
+};
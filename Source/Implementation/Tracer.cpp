@@ -0,0 +1,162 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "Tracer.h"
+#include <stdio.h>
+
+//---------------------------------------------------------------------
+CTracer::CTracer()
+{
+	m_enabled = false;
+	m_tlsIndex = TlsAlloc();
+	m_buffers = NULL;
+	m_numDroppedEvents = 0;
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_frequency = frequency.QuadPart;
+}
+
+//---------------------------------------------------------------------
+CTracer::~CTracer()
+{
+	while (m_buffers != NULL)
+	{
+		SThreadBuffer* buffer = m_buffers;
+		m_buffers = buffer->m_next;
+		delete[] buffer->m_events;
+		delete buffer;
+	}
+
+	TlsFree(m_tlsIndex);
+}
+
+//---------------------------------------------------------------------
+void CTracer::Start()
+{
+	m_enabled = false;
+
+	for (SThreadBuffer* buffer = m_buffers; buffer != NULL; buffer = buffer->m_next)
+		InterlockedExchange(&buffer->m_numEvents, 0);
+	InterlockedExchange(&m_numDroppedEvents, 0);
+
+	m_enabled = true;
+}
+
+//---------------------------------------------------------------------
+bool CTracer::Stop(const wchar_t* path)
+{
+	// Spans that are being added right now may be missed
+	m_enabled = false;
+
+	HANDLE file = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD processId = GetCurrentProcessId();
+	double ticksToMicroseconds = 1000000.0 / double(m_frequency);
+
+	std::string json = "{\"traceEvents\":[\n";
+	char line[256];
+	bool first = true;
+
+	for (SThreadBuffer* buffer = m_buffers; buffer != NULL; buffer = buffer->m_next)
+	{
+		LONG numEvents = buffer->m_numEvents;
+		for (LONG i = 0; i < numEvents; ++i)
+		{
+			const SEvent& event = buffer->m_events[i];
+			sprintf_s(line, "%s{\"name\":\"%s\",\"cat\":\"flashdx\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"player\":\"%p\"}}",
+				first ? "" : ",\n", event.m_name, processId, buffer->m_threadId,
+				double(event.m_start) * ticksToMicroseconds, double(event.m_end - event.m_start) * ticksToMicroseconds, event.m_player);
+			json += line;
+			first = false;
+		}
+	}
+
+	sprintf_s(line, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%d}}\n", (int)m_numDroppedEvents);
+	json += line;
+
+	DWORD written = 0;
+	BOOL result = WriteFile(file, json.c_str(), (DWORD)json.size(), &written, NULL);
+	CloseHandle(file);
+
+	return result && written == json.size();
+}
+
+//---------------------------------------------------------------------
+void CTracer::AddSpan(const char* name, const void* player, __int64 start, __int64 end)
+{
+	SThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == NULL)
+		return;
+
+	// Only the owner thread writes to the buffer, so the counter is published after the event is filled
+	LONG index = buffer->m_numEvents;
+	if (index >= s_maxEventsPerThread)
+	{
+		InterlockedIncrement(&m_numDroppedEvents);
+		return;
+	}
+
+	SEvent& event = buffer->m_events[index];
+	event.m_name = name;
+	event.m_player = player;
+	event.m_start = start;
+	event.m_end = end;
+
+	InterlockedExchange(&buffer->m_numEvents, index + 1);
+}
+
+//---------------------------------------------------------------------
+CTracer::SThreadBuffer* CTracer::GetThreadBuffer()
+{
+	SThreadBuffer* buffer = (SThreadBuffer*)TlsGetValue(m_tlsIndex);
+	if (buffer != NULL)
+		return buffer;
+
+	buffer = new SThreadBuffer();
+	buffer->m_threadId = GetCurrentThreadId();
+	buffer->m_events = new SEvent[s_maxEventsPerThread];
+	buffer->m_numEvents = 0;
+
+	// Push to the list of buffers
+	SThreadBuffer* head;
+	do
+	{
+		head = m_buffers;
+		buffer->m_next = head;
+	}
+	while (InterlockedCompareExchangePointer((PVOID volatile*)&m_buffers, buffer, head) != head);
+
+	TlsSetValue(m_tlsIndex, buffer);
+	return buffer;
+}
+
+//---------------------------------------------------------------------
+__int64 CTracer::GetTime()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
@@ -0,0 +1,120 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+#pragma once
+
+//---------------------------------------------------------------------
+/// Records timed spans of player activity and writes them in Chrome trace event format.
+/// Every thread appends to its own buffer without locking. Timestamps are performance
+/// counter based, so traces line up with other QueryPerformanceCounter driven profilers.
+//---------------------------------------------------------------------
+class CTracer
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor.
+	CTracer();
+
+	//---------------------------------------------------------------------
+	/// Destructor.
+	~CTracer();
+
+	//---------------------------------------------------------------------
+	/// Discards recorded events and starts recording.
+	void Start();
+
+	//---------------------------------------------------------------------
+	/// Stops recording and writes recorded events to JSON file.
+	bool Stop(const wchar_t* path);
+
+	//---------------------------------------------------------------------
+	/// Checks if events are recorded.
+	bool IsEnabled() const { return m_enabled; }
+
+	//---------------------------------------------------------------------
+	/// Adds span to the buffer of the calling thread. Name should be a string literal.
+	void AddSpan(const char* name, const void* player, __int64 start, __int64 end);
+
+	//---------------------------------------------------------------------
+	/// Returns current time in performance counter ticks.
+	static __int64 GetTime();
+
+protected:
+	//---------------------------------------------------------------------
+	// Events each thread can record, the rest are dropped.
+	static const LONG s_maxEventsPerThread = 32768;
+
+	struct SEvent
+	{
+		const char*		m_name;
+		const void*		m_player;
+		__int64			m_start;
+		__int64			m_end;
+	};
+
+	struct SThreadBuffer
+	{
+		DWORD			m_threadId;
+		SEvent*			m_events;
+		volatile LONG	m_numEvents;		// events published to the writer
+		SThreadBuffer*	m_next;
+	};
+
+	//---------------------------------------------------------------------
+	SThreadBuffer* GetThreadBuffer();
+
+protected:
+	volatile bool			m_enabled;
+	DWORD					m_tlsIndex;
+	SThreadBuffer* volatile	m_buffers;			// lock-free list of all thread buffers
+	volatile LONG			m_numDroppedEvents;
+	__int64					m_frequency;
+};
+
+//---------------------------------------------------------------------
+/// Records a span from construction to destruction if tracing was enabled at construction.
+//---------------------------------------------------------------------
+class CTraceSpan
+{
+public:
+	//---------------------------------------------------------------------
+	/// Constructor. Starts the span.
+	CTraceSpan(CTracer& tracer, const char* name, const void* player)
+		: m_tracer(tracer), m_name(name), m_player(player)
+	{
+		m_start = tracer.IsEnabled() ? CTracer::GetTime() : 0;
+	}
+
+	//---------------------------------------------------------------------
+	/// Destructor. Ends the span.
+	~CTraceSpan()
+	{
+		if (m_start != 0)
+			m_tracer.AddSpan(m_name, m_player, m_start, CTracer::GetTime());
+	}
+
+protected:
+	CTracer&				m_tracer;
+	const char*				m_name;
+	const void*				m_player;
+	__int64					m_start;			// zero if the span is not recorded
+};
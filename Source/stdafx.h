@@ -28,6 +28,9 @@
 #include <windows.h>
 #include <assert.h>
 
+// Uncomment to measure DrawFrame() stages, see IFlashDXPlayer::GetDrawTimings()
+//#define FLASHDX_DRAW_TIMING
+
 #ifndef SAFE_RELEASE
 #define SAFE_RELEASE(value) if (value) { (value)->Release(); (value) = NULL; }
 #endif
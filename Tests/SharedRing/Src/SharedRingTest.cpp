@@ -0,0 +1,171 @@
+//---------------------------------------------------------------------
+// Copyright (c) 2009 Maksym Diachenko, Viktor Reutskyy, Anton Suchov.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//---------------------------------------------------------------------
+
+// Checks CSharedRing outside of Windows: a stand-in producer thread writes messages of varying sizes
+// through a small ring, so they wrap, while the main thread reads and verifies them. Then the consumer
+// is fed a ring with corrupt header and size fields, which it must refuse.
+//
+// Usage: make && ./SharedRingTest
+// Prints failed checks, exit code is the number of failures.
+
+#include "stdafx.h"
+#include "../../../Source/Implementation/SharedRing.h"
+#include <pthread.h>
+#include <sched.h>
+
+//---------------------------------------------------------------------
+static const unsigned int ring_capacity = 4096;
+static const int num_messages = 200000;
+static const unsigned int max_message_size = 1500;
+static const long max_spins = 10000000;
+
+static std::vector<BYTE> g_memory(CSharedRing::GetMemorySize(ring_capacity));
+static int g_failures = 0;
+
+//---------------------------------------------------------------------
+#define CHECK(condition) \
+	if (!(condition)) { printf("%s(%d): %s\n", __FILE__, __LINE__, #condition); ++g_failures; }
+
+//---------------------------------------------------------------------
+// Same sequence of sizes on both sides.
+static unsigned int NextMessageSize(unsigned int& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return sizeof(int) + (seed >> 8) % max_message_size;
+}
+
+//---------------------------------------------------------------------
+static BYTE GetMessageByte(int index, unsigned int offset)
+{
+	return (BYTE)(index + offset);
+}
+
+//---------------------------------------------------------------------
+static void* ProducerProc(void*)
+{
+	CSharedRing ring;
+	while (!ring.Attach(&g_memory[0]))
+		sched_yield();
+
+	unsigned int seed = 1;
+	std::vector<BYTE> message;
+	for (int i = 0; i < num_messages; ++i)
+	{
+		message.resize(NextMessageSize(seed));
+		memcpy(&message[0], &i, sizeof(i));
+		for (unsigned int k = sizeof(i); k < message.size(); ++k)
+			message[k] = GetMessageByte(i, k);
+
+		while (!ring.Write(&message[0], (unsigned int)message.size()))
+			sched_yield();
+	}
+	return NULL;
+}
+
+//---------------------------------------------------------------------
+static void TestProducerConsumer()
+{
+	CSharedRing ring;
+	ring.Create(&g_memory[0], ring_capacity);
+	CHECK(ring.GetMaxMessageSize() == ring_capacity - sizeof(DWORD));
+
+	pthread_t producer;
+	if (pthread_create(&producer, NULL, ProducerProc, NULL) != 0)
+	{
+		CHECK(!"pthread_create");
+		return;
+	}
+
+	unsigned int seed = 1;
+	std::vector<BYTE> message;
+	for (int i = 0; i < num_messages; ++i)
+	{
+		long spins = 0;
+		while (!ring.Read(message) && ++spins < max_spins)
+			sched_yield();
+		if (spins == max_spins)
+		{
+			printf("consumer stuck at message %d\n", i);
+			++g_failures;
+			break;
+		}
+
+		int index = -1;
+		unsigned int size = NextMessageSize(seed);
+		if (message.size() >= sizeof(index))
+			memcpy(&index, &message[0], sizeof(index));
+
+		bool valid = message.size() == size && index == i;
+		for (unsigned int k = sizeof(index); valid && k < size; ++k)
+			valid = message[k] == GetMessageByte(i, k);
+		if (!valid)
+		{
+			printf("message %d is corrupt, size %u, expected %u\n", i, (unsigned int)message.size(), size);
+			++g_failures;
+			break;
+		}
+	}
+
+	pthread_join(producer, NULL);
+	CHECK(!ring.Read(message));
+}
+
+//---------------------------------------------------------------------
+// Header and positions occupy the first bytes of ring memory, see CSharedRing::SHeader.
+static void TestCorruptRing()
+{
+	std::vector<BYTE> memory(CSharedRing::GetMemorySize(ring_capacity));
+	CSharedRing writer;
+	writer.Create(&memory[0], ring_capacity);
+
+	DWORD* capacity = (DWORD*)&memory[sizeof(DWORD)];
+	CSharedRing reader;
+	*capacity = ring_capacity - 1;
+	CHECK(!reader.Attach(&memory[0]));
+	*capacity = 0;
+	CHECK(!reader.Attach(&memory[0]));
+	*capacity = ring_capacity;
+	CHECK(reader.Attach(&memory[0]));
+
+	BYTE data[16] = {0};
+	CHECK(writer.Write(data, sizeof(data)));
+
+	// Size field of the message larger than the ring, then larger than written data
+	DWORD* size = (DWORD*)&memory[CSharedRing::GetMemorySize(0)];
+	std::vector<BYTE> message;
+	*size = ring_capacity;
+	CHECK(!reader.Read(message));
+	*size = sizeof(data) + 1;
+	CHECK(!reader.Read(message));
+	*size = sizeof(data);
+	CHECK(reader.Read(message) && message.size() == sizeof(data));
+}
+
+//---------------------------------------------------------------------
+int main()
+{
+	TestProducerConsumer();
+	TestCorruptRing();
+
+	printf("%s\n", g_failures ? "FAILED" : "OK");
+	return g_failures;
+}